@@ -26,15 +26,58 @@ freely, subject to the following restrictions:
 #pragma once
 
 #include <algorithm>
-#include <functional>
 #include <memory>
 
 namespace TAP {
 
 class Argument;
+class ValueAcceptor;
 
-/** Function pointer that is used by Argument::check(). */
-using ArgumentCheckFunc = std::function<void(const Argument&)>;
+/**
+ * Kind of the values an argument accepts, recorded in exported schemas (see
+ * ArgumentParser::export_schema()) so other tools can check values without
+ * the argument types.
+ */
+enum class ValueKind : unsigned char {
+    /** No value */
+    None,
+    /** Any text */
+    Text,
+    /** Integral number */
+    Integer,
+    /** Floating point number */
+    Real
+};
+
+namespace detail {
+
+/**
+ * Table of functions to set an argument, see Argument::ops(). The table is
+ * looked up once when freezing a parser, so parsing needs no RTTI to find
+ * out how to set an argument.
+ */
+struct ArgumentOps {
+    /** Set the argument, see Argument::set() */
+    void (*set)(const Argument& arg);
+
+    /** Set the argument with a value, see ValueAcceptor::try_set(). May be
+     * a null-pointer if the argument does not accept values */
+    bool (*setValue)(const Argument& arg, const std::string& value);
+
+    /** Check whether a value can be converted for the argument, without
+     * storing it or running check functions, see ValueAcceptor::accepts().
+     * May be a null-pointer if the argument does not accept values */
+    bool (*checkValue)(const Argument& arg, const std::string& value);
+
+    /** Kind of the accepted values */
+    ValueKind kind;
+};
+
+}
+
+/** Function that is used by Argument::check(). Stored inline, without
+ * allocating (see detail::SmallFunction). */
+using ArgumentCheckFunc = detail::SmallFunction<void(const Argument&)>;
 
 /**
  * Simple argument class. Arguments are identified by a flag ('-a') or name
@@ -70,14 +113,21 @@ protected:
     /** Callback for check */
     ArgumentCheckFunc m_checkFunc = nullptr;
 
+    /** Values offered by shell completion, see choices() */
+    std::vector<std::string> m_choices;
+
+    /** True if shell completion offers file names, see complete_files() */
+    bool m_completeFiles = false;
+
 #ifndef TAP_AUTOFLAG
     /**
      * Create a positional argument (has no name). This function is only valid
      * for subclasses that accept values, such as ValuedArgument.
      * @param description Description of the argument (used in help text)
      */
-    Argument(std::string description) :
-            m_isPositional(true), m_description(std::move(description)), m_count(std::make_shared<unsigned int>(0)) {
+    Argument(Description description) :
+            m_isPositional(true), m_description(std::move(description.m_text)), m_count(std::make_shared<unsigned int>(0)) {
+        apply_markers(description);
     }
 #endif
 
@@ -92,10 +142,10 @@ public:
      * @param description Description of the argument, requires a flag or name
      *        to be defined
      */
-    Argument(std::string description) :
-            m_isPositional(true), m_description(std::move(description)), m_count(std::make_shared<unsigned int>(0)) {
+    Argument(Description description) :
+            m_isPositional(true), m_description(std::move(description.m_text)), m_count(std::make_shared<unsigned int>(0)) {
 
-        parse_description();
+        apply_markers(description);
         // Cannot perform below check as it requires virtual calls
         // instead, user will have to make sure this does not happen
         /*if (!takes_value() && m_isPositional) {
@@ -109,11 +159,9 @@ public:
      * @param description Description of the argument (used in help text)
      * @param flag Flag identifier of this argument
      */
-    Argument(std::string description, char flag) :
-            m_isPositional(false), m_description(std::move(description)), m_count(std::make_shared<unsigned int>(0)) {
-#ifdef TAP_AUTOFLAG
-        parse_description();
-#endif
+    Argument(Description description, char flag) :
+            m_isPositional(false), m_description(std::move(description.m_text)), m_count(std::make_shared<unsigned int>(0)) {
+        apply_markers(description);
         alias(flag);
     }
 
@@ -122,11 +170,9 @@ public:
      * @param description Description of the argument (used in help text)
      * @param name Name identifier of this argument
      */
-    Argument(std::string description, std::string name) :
-            m_isPositional(false), m_description(std::move(description)), m_count(std::make_shared<unsigned int>(0)) {
-#ifdef TAP_AUTOFLAG
-        parse_description();
-#endif
+    Argument(Description description, std::string name) :
+            m_isPositional(false), m_description(std::move(description.m_text)), m_count(std::make_shared<unsigned int>(0)) {
+        apply_markers(description);
         alias(std::move(name));
     }
 
@@ -136,11 +182,9 @@ public:
      * @param flag Flag identifier of this argument
      * @param name Name identifier of this argument
      */
-    Argument(std::string description, char flag, std::string name) :
-            m_isPositional(false), m_description(std::move(description)), m_count(std::make_shared<unsigned int>(0)) {
-#ifdef TAP_AUTOFLAG
-        parse_description();
-#endif
+    Argument(Description description, char flag, std::string name) :
+            m_isPositional(false), m_description(std::move(description.m_text)), m_count(std::make_shared<unsigned int>(0)) {
+        apply_markers(description);
         alias(flag, std::move(name));
     }
 
@@ -210,6 +254,22 @@ public:
         return m_description;
     }
 
+    /**
+     * Returns the flag aliases of this argument, see alias(char).
+     * @return Flags this argument matches
+     */
+    const std::string& flags() const {
+        return m_flags;
+    }
+
+    /**
+     * Returns the name aliases of this argument, see alias(std::string).
+     * @return Names this argument matches
+     */
+    const std::vector<std::string>& names() const {
+        return m_names;
+    }
+
     /** Set the check function to use.
      * @param checkFunc Check function to use (see ArgumentCheckFunc)
      * @return Reference to this argument
@@ -219,6 +279,50 @@ public:
         return *this;
     }
 
+    ///////////////////
+    // Completion operations
+    ///////////////////
+    /**
+     * Set the values offered by shell completion for the value of this
+     * argument (see ArgumentParser::complete()). Values given on the command
+     * line are not restricted to these.
+     * @param choices Values to offer
+     * @return Reference to this argument
+     */
+    Argument& choices(std::vector<std::string> choices) {
+        m_choices = std::move(choices);
+        return *this;
+    }
+
+    /**
+     * Returns the values offered by shell completion, see
+     * choices(std::vector<std::string>).
+     * @return Values to offer
+     */
+    const std::vector<std::string>& choices() const {
+        return m_choices;
+    }
+
+    /**
+     * Set whether shell completion offers file names for the value of this
+     * argument (see ArgumentParser::complete()).
+     * @param files If true, offer file names
+     * @return Reference to this argument
+     */
+    Argument& complete_files(bool files) {
+        m_completeFiles = files;
+        return *this;
+    }
+
+    /**
+     * Returns whether shell completion offers file names, see
+     * complete_files(bool).
+     * @return True iff file names are offered
+     */
+    bool complete_files() const {
+        return m_completeFiles;
+    }
+
     ///////////////////
     // Lookup operations
     ///////////////////
@@ -267,6 +371,26 @@ public:
         return false;
     }
 
+    /**
+     * Returns whether this argument matches the given name as a pattern (see
+     * PatternArgument). The parser only checks patterns if no argument
+     * matches the name exactly.
+     * @param name Name to check
+     * @return True iff the name matches the pattern of this argument
+     */
+    virtual bool matches_pattern(const std::string& /*name*/) const {
+        return false;
+    }
+
+    /**
+     * Returns the fixed prefix of the names matched by matches_pattern(), or
+     * a null-pointer if this argument does not match a pattern.
+     * @return Prefix of the pattern, or nullptr
+     */
+    virtual const std::string* pattern() const {
+        return nullptr;
+    }
+
     /**
      * See BaseArgument::find_all_arguments()
      */
@@ -274,6 +398,15 @@ public:
         collector.push_back(this);
     }
 
+    /**
+     * Returns a key identifying this argument. Copies of an argument share
+     * the same occurrence counter, and thus the same key.
+     * @return Key of this argument
+     */
+    const void* key() const {
+        return m_count.get();
+    }
+
     // Make public
     using BaseArgument::set_required;
     using BaseArgument::required;
@@ -383,6 +516,37 @@ public:
         return false;
     }
 
+    /**
+     * Returns the functions used by the parser to set this argument (see
+     * detail::ArgumentOps). By default, values are set through acceptor().
+     * @return Table of functions to set this argument
+     */
+    virtual const detail::ArgumentOps& ops() const {
+        static const detail::ArgumentOps ops = { &Argument::set_argument, &Argument::set_acceptor, &Argument::check_acceptor,
+            ValueKind::None };
+        return ops;
+    }
+
+    /**
+     * Returns the interface to set this argument with a value. Classes that
+     * accept values (see takes_value()) by deriving from ValueAcceptor must
+     * override this to return themselves, as is done by VariableArgument and
+     * PatternArgument.
+     * @return The interface, or nullptr if the argument does not accept values
+     */
+    virtual const ValueAcceptor* acceptor() const {
+        return nullptr;
+    }
+
+    /**
+     * Returns the code of the action performed by this argument, see
+     * ActionArgument.
+     * @return The code, or 0 if the argument performs no action
+     */
+    virtual int action() const {
+        return 0;
+    }
+
     ///////////////////
     // Validation operations
     ///////////////////
@@ -396,9 +560,15 @@ public:
      */
     std::string usage() const override;
 
+    /**
+     * See BaseArgument::compile()
+     */
+    bool compile(detail::ConstraintProgram& program, std::size_t parent, std::size_t& index) const override;
+
     /**
      * Print a string representation of this argument to the given stream. This
-     * is usually represented in the first column of help text.
+     * is usually represented in the first column of help text, shown with the
+     * current markers (see Markers::current()).
      * @return String representation.
      */
     virtual std::string ident() const;
@@ -417,6 +587,32 @@ public:
         return std::unique_ptr<BaseArgument>(new Argument(std::move(*this)));
     }
 protected:
+    /**
+     * Set the given argument, see detail::ArgumentOps::set.
+     * @param arg Argument to set
+     */
+    static void set_argument(const Argument& arg) {
+        arg.set();
+    }
+
+    /**
+     * Set the given argument with a value through acceptor() (see
+     * ValueAcceptor::try_set()), see detail::ArgumentOps::setValue.
+     * @param arg Argument to set
+     * @param value The value to set, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool set_acceptor(const Argument& arg, const std::string& value);
+
+    /**
+     * Check a value for the given argument through acceptor() (see
+     * ValueAcceptor::accepts()), see detail::ArgumentOps::checkValue.
+     * @param arg Argument to check the value for
+     * @param value The value to check, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool check_acceptor(const Argument& arg, const std::string& value);
+
     /**
      * Executes the associated check function.
      * @return Result of the check function, or true if not set
@@ -428,6 +624,30 @@ protected:
     }
 
 private:
+    /**
+     * Add the aliases of a description parsed by markup(). Otherwise, if
+     * TAP_AUTOFLAG is defined, parse the markers of the description with
+     * parse_description().
+     * @param description Description the argument was created with
+     */
+    void apply_markers(const Description& description) {
+        if (!description.m_parsed) {
+#ifdef TAP_AUTOFLAG
+            parse_description();
+#endif
+            return;
+        }
+        m_flags.append(description.m_flags, description.m_flagCount);
+        const char* name = description.m_names;
+        for (std::size_t i = 0; i < description.m_nameCount; ++i) {
+            m_names.emplace_back(name);
+            name += m_names.back().length() + 1;
+        }
+        if (description.m_flagCount + description.m_nameCount > 0) {
+            m_isPositional = false;
+        }
+    }
+
 #ifdef TAP_AUTOFLAG
     /**
      * When TAP_AUTOFLAG is defined, this function finds flag and/or name
@@ -522,14 +742,138 @@ private:
         if (addName && nameStart != m_description.end()) {
             alias(std::string(nameStart, m_description.end()));
         }
-        // Remove the special characters
-        for (auto it = specialChars.rbegin(); it != specialChars.rend(); it++) {
-            m_description.erase(*it, (*it)+1);
+        // Remove the special characters in a single pass, they are in order
+        auto out = m_description.begin();
+        auto special = specialChars.begin();
+        for (auto it = m_description.begin(); it != m_description.end(); ++it) {
+            if (special != specialChars.end() && *special == it) {
+                ++special;
+            } else {
+                *out++ = *it;
+            }
         }
+        m_description.erase(out, m_description.end());
     }
 #endif
 };
 
+/**
+ * Argument that performs an action of the program, such as showing help or
+ * version information. As soon as it occurs on the command line, the
+ * argument is set and parsing stops: the remaining arguments are neither read
+ * nor converted, and occurrence counts and constraints are not checked (so
+ * required arguments may be missing). ArgumentParser::parse() then returns
+ * the code of the action, see also ParseResult::action().
+ */
+class ActionArgument : public Argument {
+protected:
+    /** Code of the action, not 0 */
+    int m_action;
+
+public:
+#ifdef TAP_AUTOFLAG
+    /**
+     * Create an action argument with aliases defined by the description.
+     * @param description Description of the argument (used in help text). Must
+     *        contain flag or name markers
+     * @param action Code of the action, must not be 0
+     */
+    ActionArgument(Description description, int action) :
+        Argument(std::move(description)), m_action(checked(action)) {
+    }
+#endif
+
+    /**
+     * Create an action argument that is identified by a flag.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument
+     * @param action Code of the action, must not be 0
+     */
+    ActionArgument(Description description, char flag, int action) :
+        Argument(std::move(description), flag), m_action(checked(action)) {
+    }
+
+    /**
+     * Create an action argument that is identified by a name.
+     * @param description Description of the argument (used in help text)
+     * @param name Name identifier of this argument
+     * @param action Code of the action, must not be 0
+     */
+    ActionArgument(Description description, std::string name, int action) :
+        Argument(std::move(description), std::move(name)), m_action(checked(action)) {
+    }
+
+    /**
+     * Create an action argument that is identified by both a flag and a name.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument
+     * @param name Name identifier of this argument
+     * @param action Code of the action, must not be 0
+     */
+    ActionArgument(Description description, char flag, std::string name, int action) :
+        Argument(std::move(description), flag, std::move(name)), m_action(checked(action)) {
+    }
+
+    /**
+     * ActionArgument copy constructor.
+     */
+    ActionArgument(const ActionArgument&) = default;
+
+    /**
+     * ActionArgument move constructor.
+     */
+    ActionArgument(ActionArgument&&) = default;
+
+    /**
+     * ActionArgument destructor.
+     */
+    virtual ~ActionArgument() = default;
+
+    /**
+     * ActionArgument copy assignment operator.
+     */
+    ActionArgument& operator=(const ActionArgument&) = default;
+
+    /**
+     * ActionArgument move assignment operator.
+     */
+    ActionArgument& operator=(ActionArgument&&) = default;
+
+    /**
+     * See Argument::action()
+     */
+    int action() const override {
+        return m_action;
+    }
+
+    /**
+     * See BaseArgument::clone().
+     */
+    std::unique_ptr<BaseArgument> clone() const & override {
+        return std::unique_ptr<BaseArgument>(new ActionArgument(*this));
+    }
+
+    /**
+     * See BaseArgument::clone().
+     */
+    std::unique_ptr<BaseArgument> clone() && override {
+        return std::unique_ptr<BaseArgument>(new ActionArgument(std::move(*this)));
+    }
+
+private:
+    /**
+     * Returns the code of an action, throws a std::logic_error if it is 0.
+     * @param action Code of the action
+     * @return The code
+     */
+    static int checked(int action) {
+        if (action == 0) {
+            throw std::logic_error("Action code 0 is reserved for no action");
+        }
+        return action;
+    }
+};
+
 /**
  * Interface class for arguments that accept a value when takes_value() is true.
  */
@@ -543,6 +887,25 @@ public:
      * @param value The value to set, as a string
      */
     virtual void set(const std::string& value) const = 0;
+
+    /**
+     * Set the argument with a value like set(), but return false instead of
+     * throwing argument_invalid_value if the value cannot be converted. The
+     * parser sets values through this function (see Argument::ops()), so
+     * that invalid values do not throw.
+     * @param value The value to set, as a string
+     * @return False if the value cannot be converted
+     */
+    virtual bool try_set(const std::string& value) const = 0;
+
+    /**
+     * Check whether try_set() would accept a value, without setting the
+     * argument or running check functions. Used to check values without
+     * storing them (see ArgumentParser::validate()).
+     * @param value The value to check, as a string
+     * @return False if the value cannot be converted
+     */
+    virtual bool accepts(const std::string& value) const = 0;
 };
 
 }
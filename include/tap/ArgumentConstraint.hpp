@@ -25,7 +25,9 @@ freely, subject to the following restrictions:
 #pragma once
 
 #include <algorithm> // find
-#include <memory>    // unique_ptr
+#include <memory>    // shared_ptr
+#include <tuple>     // tuple
+#include <utility>   // index_sequence
 
 namespace TAP {
 
@@ -34,11 +36,201 @@ namespace TAP {
  * enumeration for details and meaning.
  */
 enum class ConstraintType {
-    Imp,   /**< 0:    Each argument implies the next */
-    One,   /**< 1:    Exactly one argument must be set */
-    Any,   /**< ?:    Manually specified */
+    Imp,       /**< 0:    Each argument implies the next */
+    One,       /**< 1:    Exactly one argument must be set */
+    Any,       /**< ?:    Manually specified */
+    AtMostOne, /**< 0..1: At most one argument may be set */
+    AtLeast,   /**< N..:  At least bound() arguments must be set */
+    Exactly,   /**< N:    Exactly bound() arguments must be set */
+    All,       /**< *:    All arguments must be set */
 };
 
+namespace detail {
+/** Internal type alias used to expand parameter packs */
+template<class T> using Temporary = T;
+
+template<ConstraintType CType>
+class ConstraintExpr;
+
+/**
+ * Trait that is true iff the given types consist of a single ConstraintExpr
+ * of the given ConstraintType.
+ */
+template<ConstraintType CType, typename... A>
+struct IsConstraintExpr : std::false_type {
+};
+
+/**
+ * Trait that is true iff the given types consist of a single ConstraintExpr
+ * of the given ConstraintType. Specialized for ConstraintExpr.
+ */
+template<ConstraintType CType>
+struct IsConstraintExpr<CType, ConstraintExpr<CType> > : std::true_type {
+};
+
+/**
+ * Trait that is true iff the given types consist of the single type T.
+ */
+template<typename T, typename... A>
+struct IsSingle : std::false_type {
+};
+
+/**
+ * Trait that is true iff the given types consist of the single type T.
+ * Specialized for T.
+ */
+template<typename T>
+struct IsSingle<T, T> : std::true_type {
+};
+
+/**
+ * Predicate over the values of a number of arguments, attached to a
+ * constraint with ArgumentConstraint::check_values().
+ */
+class ValuePredicate {
+protected:
+    /** Reason reported if the predicate does not hold */
+    std::string m_reason;
+
+public:
+    /**
+     * Create a predicate with the given reason of failure.
+     * @param reason Reason reported if the predicate does not hold
+     */
+    ValuePredicate(std::string reason) : m_reason(std::move(reason)) {
+    }
+
+    /**
+     * ValuePredicate destructor.
+     */
+    virtual ~ValuePredicate() {
+    }
+
+    /**
+     * Returns the reason reported if the predicate does not hold.
+     * @return Reason of failure
+     */
+    const std::string& reason() const {
+        return m_reason;
+    }
+
+    /**
+     * Evaluate the predicate.
+     * @return True iff the predicate holds
+     */
+    virtual bool holds() const = 0;
+
+    /**
+     * Collect the arguments the predicate is evaluated on.
+     * @param args Vector to store the arguments in
+     */
+    virtual void arguments(std::vector<const BaseArgument*>& args) const = 0;
+
+    /**
+     * Check the predicate, throws a constraint_error if it does not hold.
+     */
+    void check() const;
+};
+
+/**
+ * ValuePredicate calling a function object with copies of the given
+ * arguments (which share their values with the originals).
+ */
+template<typename F, typename... A>
+class TypedValuePredicate : public ValuePredicate {
+protected:
+    /** Predicate to call */
+    F m_predicate;
+    /** Arguments to pass to the predicate */
+    std::tuple<A...> m_args;
+
+public:
+    /**
+     * Create the predicate.
+     * @param reason Reason reported if the predicate does not hold
+     * @param predicate Predicate to call
+     * @param args Arguments to pass to the predicate
+     */
+    TypedValuePredicate(std::string reason, F predicate, const A&... args) :
+        ValuePredicate(std::move(reason)), m_predicate(std::move(predicate)), m_args(args...) {
+    }
+
+    /**
+     * See ValuePredicate::holds()
+     */
+    bool holds() const override {
+        return call(std::index_sequence_for<A...>());
+    }
+
+    /**
+     * See ValuePredicate::arguments()
+     */
+    void arguments(std::vector<const BaseArgument*>& args) const override {
+        collect(args, std::index_sequence_for<A...>());
+    }
+
+protected:
+    /**
+     * Call the predicate with all arguments.
+     */
+    template<std::size_t... I>
+    bool call(std::index_sequence<I...>) const {
+        return m_predicate(std::get<I>(m_args)...);
+    }
+
+    /**
+     * Collect pointers to all arguments.
+     */
+    template<std::size_t... I>
+    void collect(std::vector<const BaseArgument*>& args, std::index_sequence<I...>) const {
+        detail::Temporary<char[]> { (args.push_back(&std::get<I>(m_args)), '0')..., '0' };
+    }
+};
+
+/**
+ * How the usage string of a sub-argument is shown in the usage string of a
+ * constraint, see ArgumentConstraint::usageArgument().
+ */
+enum class UsageWrap : char {
+    None,     /**< Shown as-is */
+    Optional, /**< Shown in square brackets */
+    Group,    /**< Shown in parentheses */
+};
+
+/**
+ * Contents of an ArgumentConstraint. The contents are shared between copies
+ * of a constraint, and are only copied when a shared constraint is modified
+ * (see ArgumentConstraint::modify()). Sub-arguments are never modified once
+ * added, so they are shared as well.
+ */
+struct ConstraintData {
+    /** Sub-arguments to check */
+    std::vector< std::shared_ptr<const BaseArgument> > args;
+
+    /** How the usage string of each sub-argument is shown */
+    std::vector<UsageWrap> wraps;
+
+    /** Predicates over argument values, see ArgumentConstraint::check_values() */
+    std::vector< std::shared_ptr<const ValuePredicate> > predicates;
+
+    /** Usage string, built on first use */
+    mutable std::string usage;
+
+    /** True if usage is up to date */
+    mutable bool usageValid = false;
+
+    /** Markers usage is shown with, see Markers::current() */
+    mutable Markers usageMarkers{nullptr, nullptr};
+
+    /** All Argument instances contained, collected on first use */
+    mutable std::vector<const Argument*> arguments;
+
+    /** True if arguments is up to date */
+    mutable bool argumentsValid = false;
+};
+
+}
+
 /**
  * Argument constraint class. Given a set of sub-arguments, the constraint will
  * check if the number of satisfied arguments fall within a certain range.
@@ -50,11 +242,11 @@ enum class ConstraintType {
 template<ConstraintType CType>
 class ArgumentConstraint: public BaseArgument {
 protected:
-    /** Sub-arguments to check */
-    std::vector< std::unique_ptr<BaseArgument> > m_args;
+    /** Sub-arguments, usage string and predicates, shared between copies */
+    std::shared_ptr<detail::ConstraintData> m_data;
 
-    /** Stored usage string */
-    std::string m_usageString;
+    /** Bound used by ConstraintType::AtLeast and ConstraintType::Exactly */
+    unsigned int m_bound = 1;
 
 public:
     /**
@@ -62,23 +254,17 @@ public:
      * arguments.
      * @param args Arguments to add
      */
-    template<typename ... A>
+    template<typename ... A, typename = typename std::enable_if<
+            !detail::IsConstraintExpr<CType, typename std::decay<A>::type...>::value &&
+            !detail::IsSingle<ArgumentConstraint<CType>, typename std::decay<A>::type...>::value >::type >
     ArgumentConstraint(A&& ... args);
 
     /**
-     * ArgumentConstraint copy constructor.
-     */
-    ArgumentConstraint(const ArgumentConstraint& other) :
-        BaseArgument(other), m_usageString(other.m_usageString) {
-        for(auto const & arg: other.m_args) {
-            m_args.emplace_back(std::move(arg->clone()));
-        }
-    }
-
-    /**
-     * ArgumentConstraint move constructor.
+     * ArgumentConstraint copy constructor. The contents of the constraint are
+     * shared with other until either is modified, so copying takes constant
+     * time. Moving is equal to copying.
      */
-    ArgumentConstraint(ArgumentConstraint&&) = default;
+    ArgumentConstraint(const ArgumentConstraint& other) = default;
 
     /**
      * ArgumentConstraint destructor.
@@ -87,18 +273,9 @@ public:
     }
 
     /**
-     * ArgumentConstraint assignment operator.
+     * ArgumentConstraint assignment operator, see the copy constructor.
      */
-    ArgumentConstraint& operator=(ArgumentConstraint other) {
-        std::swap(m_args, other.m_args);
-        std::swap(m_usageString, other.m_usageString);
-        return *this;
-    }
-
-    /**
-     * ArgumentConstraint move assignment operator.
-     */
-    ArgumentConstraint& operator=(ArgumentConstraint&&) = default;
+    ArgumentConstraint& operator=(const ArgumentConstraint& other) = default;
 
     /**
      * Appends the given argument to the constraint
@@ -115,26 +292,95 @@ public:
      * @param arg Argument to append
      * @return Reference to this constraint
      */
-    ArgumentConstraint& operator+=(ArgumentConstraint<CType> const& other) {
-        for(auto const & arg: other.m_args) {
-            m_args.emplace_back(std::move(arg->clone()));
-        }
-        return *this;
-    }
+    ArgumentConstraint& operator+=(ArgumentConstraint<CType> const& other);
 
     /**
      * Returns the number of contained sub-arguments.
      * @return Number of contained sub-arguments.
      */
     size_t size() const {
-        return m_args.size();
+        return m_data->args.size();
+    }
+
+    /**
+     * Reserve space for the given number of sub-arguments, to speed up adding
+     * many arguments.
+     * @param size Expected number of sub-arguments
+     * @return Reference to this constraint
+     */
+    ArgumentConstraint& reserve(std::size_t size) {
+        detail::ConstraintData& data = modify();
+        data.args.reserve(size);
+        data.wraps.reserve(size);
+        return *this;
+    }
+
+    /**
+     * Set the number of arguments to be set for ConstraintType::AtLeast and
+     * ConstraintType::Exactly. Ignored for other constraint types.
+     * @param bound Number of arguments
+     * @return Reference to this constraint
+     */
+    ArgumentConstraint& bound(unsigned int bound) {
+        m_bound = bound;
+        return *this;
+    }
+
+    /**
+     * Returns the bound of this constraint, see bound(unsigned int).
+     * @return Number of arguments to be set
+     */
+    unsigned int bound() const {
+        return m_bound;
+    }
+
+    /**
+     * Attach a predicate over the values of the given arguments to this
+     * constraint. When parsing, predicates are evaluated once all values
+     * have been converted and the constraints on which arguments are set are
+     * satisfied, and only if this constraint is checked (so when it is
+     * required, or any of its arguments is set). Predicates of nested
+     * constraints are evaluated before those of the constraints containing
+     * them. If the predicate returns false, a constraint_error is thrown,
+     * with the given reason followed by the usage of the arguments. For
+     * example:
+     * @code
+     * ValueArgument<int> min("Minimum", "min", 0), max("Maximum", "max", 10);
+     * auto range = min | max;
+     * range.check_values("Minimum may not exceed maximum: ",
+     *         [](const ValueArgument<int>& lo, const ValueArgument<int>& hi) {
+     *             return lo.value() <= hi.value();
+     *         }, min, max);
+     * @endcode
+     * @param reason Reason reported if the predicate does not hold
+     * @param predicate Function object called with the arguments, returning
+     *        true iff their values are valid
+     * @param args Arguments to pass to the predicate
+     * @return Reference to this constraint
+     */
+    template<typename F, typename... A>
+    ArgumentConstraint& check_values(std::string reason, F predicate, const A&... args) {
+        modify().predicates.emplace_back(std::make_shared< detail::TypedValuePredicate<F, A...> >(
+                std::move(reason), std::move(predicate), args...));
+        return *this;
+    }
+
+    /**
+     * Evaluate the predicates attached to this constraint (see
+     * check_values()), but not those of nested constraints. Throws a
+     * constraint_error if any does not hold.
+     */
+    void check_values() const {
+        for (auto const& predicate: m_data->predicates) {
+            predicate->check();
+        }
     }
 
     /**
      * See BaseArgument::find_all_arguments()
      */
     void find_all_arguments(std::vector<const Argument*>& collector) const override {
-        for(const auto& arg: m_args) {
+        for(const auto& arg: m_data->args) {
             arg->find_all_arguments(collector);
         }
     }
@@ -145,11 +391,15 @@ public:
     void check_valid() const override;
 
     /**
-     * See BaseArgument::usage()
+     * See BaseArgument::usage(). The usage string is built on first use with
+     * the current markers.
      */
-    std::string usage() const override {
-        return m_usageString;
-    }
+    std::string usage() const override;
+
+    /**
+     * See BaseArgument::compile()
+     */
+    bool compile(detail::ConstraintProgram& program, std::size_t parent, std::size_t& index) const override;
 
     /**
      * See BaseArgument::clone().
@@ -166,6 +416,20 @@ public:
     }
 
 protected:
+    /**
+     * Returns the contents of this constraint for modification. If they are
+     * shared with a copy of this constraint, they are copied first.
+     * @return Contents of this constraint
+     */
+    detail::ConstraintData& modify() {
+        if (m_data.use_count() > 1) {
+            m_data = std::make_shared<detail::ConstraintData>(*m_data);
+        }
+        m_data->usageValid = false;
+        m_data->argumentsValid = false;
+        return *m_data;
+    }
+
     /**
      * Add no arguments to the constraint. This is a simple placeholder for
      * iterating over vararg templates.
@@ -183,6 +447,15 @@ protected:
     template<typename Arg>
     ArgumentConstraint& add(Arg&& arg);
 
+    /**
+     * Add an argument to the constraint, after constraint expressions have
+     * been flattened (see add()).
+     * @param arg Argument to add
+     * @return Reference to this ArgumentConstraint
+     */
+    template<typename Arg>
+    ArgumentConstraint& add_argument(Arg&& arg);
+
     /**
      * Add multiple arguments to the constraint.
      * @param arg Argument to add
@@ -203,17 +476,17 @@ protected:
     void diagnose_args() const;
 
     /**
-     * Returns a string for usage representation of sub-arguments.
-     * @return String for usage representation of sub-arguments
+     * Returns how the usage string of a sub-argument is shown.
+     * @return Usage representation of sub-argument
      */
-    std::string usageArgument(const Argument& arg) const;
+    detail::UsageWrap usageArgument(const Argument& arg) const;
 
     /**
-     * Returns a string for usage representation of sub-arguments.
-     * @return String for usage representation of sub-arguments
+     * Returns how the usage string of a sub-argument is shown.
+     * @return Usage representation of sub-argument
      */
     template<ConstraintType ACType>
-    std::string usageArgument(const ArgumentConstraint<ACType>& arg) const;
+    detail::UsageWrap usageArgument(const ArgumentConstraint<ACType>& arg) const;
 };
 
 /**
@@ -225,11 +498,6 @@ protected:
     /** The name of this ArgumentSet */
     std::string m_name;
 
-    /** Cached arguments */
-    mutable std::vector<const Argument*> m_args;
-
-    /** If true updates list of known arguments when retrieving them */
-    bool m_updateArgs = true;
 public:
     /**
      * Create a new named ArgumentSet. The parameter args defines the initial set of
@@ -275,16 +543,18 @@ public:
     }
 
     /**
-     * Get the Arguments contained in this ArgumentSet. Duplicates are filtered
-     * out.
+     * Get the Arguments contained in this ArgumentSet, including those of
+     * nested constraints. The list is collected on first use, and kept until
+     * the set is modified.
      * @return Arguments contained in this ArgumentSet
      */
     const std::vector<const Argument*>& args() const {
-        if (m_updateArgs) {
-            m_args.clear();
-            find_all_arguments(m_args);
+        if (!m_data->argumentsValid) {
+            m_data->arguments.clear();
+            find_all_arguments(m_data->arguments);
+            m_data->argumentsValid = true;
         }
-        return m_args;
+        return m_data->arguments;
     }
 
     /**
@@ -295,7 +565,28 @@ public:
     template<typename ... A>
     ArgumentSet& add(A&& ... args) {
         ArgumentConstraint<ConstraintType::Any>::add(std::forward<A>(args)...);
-        m_updateArgs = true;
+        return *this;
+    }
+
+    /**
+     * Add all arguments in the given range to the set.
+     * @param first Iterator to first argument to add
+     * @param last Iterator past the last argument to add
+     * @return Reference to this set
+     */
+    template<typename It>
+    ArgumentSet& add_range(It first, It last) {
+        for (; first != last; ++first) {
+            ArgumentConstraint<ConstraintType::Any>::add(*first);
+        }
+        return *this;
+    }
+
+    /**
+     * See ArgumentConstraint::reserve().
+     */
+    ArgumentSet& reserve(std::size_t size) {
+        ArgumentConstraint<ConstraintType::Any>::reserve(size);
         return *this;
     }
 
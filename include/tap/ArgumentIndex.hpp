@@ -0,0 +1,300 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file ArgumentIndex.hpp
+ * @brief Contains the definitions for argument lookup of a frozen parser.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Argument of a frozen parser, with everything needed to set it while parsing
+ * resolved in advance (see Argument::ops()), so parsing does not need virtual
+ * calls or RTTI to find out how to set an argument.
+ */
+struct FrozenArgument {
+    /** The argument */
+    const Argument* arg;
+
+    /** Dense index of the argument (see ConstraintProgram::add()), or
+     * ConstraintProgram::npos if not part of the program */
+    std::size_t index;
+
+    /** Cached result of Argument::takes_value() */
+    bool takesValue;
+
+    /** Functions to set the argument */
+    const ArgumentOps* ops;
+
+    /** Cached result of Argument::action() */
+    int action;
+
+    /**
+     * Set the argument, see Argument::set().
+     */
+    void set() const {
+        ops->set(*arg);
+    }
+
+    /**
+     * Set the argument with a value, see ValueAcceptor::set(). Throws a
+     * std::logic_error if the argument does not accept values.
+     * @param value The value to set, as a string
+     * @return False if the value cannot be converted
+     */
+    bool set(const std::string& value) const {
+        if (ops->setValue == nullptr) {
+            throw std::logic_error("Requested value interface on non-valued argument");
+        }
+        return ops->setValue(*arg, value);
+    }
+
+    /**
+     * Check a value for the argument without setting it, see
+     * ArgumentOps::checkValue. Throws a std::logic_error if the argument does
+     * not accept values.
+     * @param value The value to check, as a string
+     * @return False if the value cannot be converted
+     */
+    bool accepts(const std::string& value) const {
+        if (ops->checkValue == nullptr) {
+            throw std::logic_error("Requested value interface on non-valued argument");
+        }
+        return ops->checkValue(*arg, value);
+    }
+};
+
+/**
+ * Default predicate for ArgumentIndex::find_if(), deciding whether an argument
+ * can still be set from its own occurrence count (see Argument::can_set()).
+ */
+struct CanSet {
+    /**
+     * Returns whether the argument can still be set.
+     * @param entry Frozen entry of the argument
+     * @return True iff the argument can be set
+     */
+    bool operator()(const FrozenArgument& entry) const {
+        return entry.arg->can_set();
+    }
+};
+
+/**
+ * Hash index to look up the arguments of a frozen parser by flag or name,
+ * instead of scanning all arguments for each command line argument. For each
+ * flag and name, the matching arguments are kept in the order they were
+ * added, so lookup results are identical to scanning (see
+ * ArgumentParser::findArg()). Copies of the same argument (sharing the same
+ * Argument::key()) are only stored once. Pattern arguments (see
+ * Argument::pattern()) are indexed by their prefix, and only checked if no
+ * argument matches a name exactly.
+ */
+class ArgumentIndex {
+    friend std::string write_schema(const ArgumentIndex& index, const std::string& program, const char* flagStart, const char* nameStart, char nameDelim, const char* skip);
+
+protected:
+    /** All arguments, in the order they were added */
+    std::vector<FrozenArgument> m_entries;
+
+    /** Positions in m_entries by flag */
+    std::unordered_map<char, std::vector<std::size_t> > m_flags;
+
+    /** Positions in m_entries by name */
+    std::unordered_map<std::string, std::vector<std::size_t> > m_names;
+
+    /** Positions in m_entries of positional arguments */
+    std::vector<std::size_t> m_positional;
+
+    /** Positions in m_entries of pattern arguments by prefix */
+    std::unordered_map<std::string, std::vector<std::size_t> > m_patterns;
+
+    /** Distinct lengths of the prefixes in m_patterns, longest first */
+    std::vector<std::size_t> m_prefixLengths;
+
+    /** Names of a single length, see m_lengths */
+    struct LengthBucket {
+        /** Characters of all names, stored back to back */
+        std::string chars;
+        /** Keys of m_names, in the order of chars */
+        std::vector<const std::string*> names;
+    };
+
+    /** Keys of m_names by their length, built on first use by suggest() */
+    mutable std::vector<LengthBucket> m_lengths;
+
+    /** Keys of m_names in lexicographic order, built on first use by
+     * complete() */
+    mutable std::vector<const std::string*> m_sorted;
+
+public:
+    /**
+     * Remove all arguments from the index.
+     */
+    void clear();
+
+    /**
+     * Reserve space for the given number of arguments.
+     * @param size Expected number of arguments
+     */
+    void reserve(std::size_t size) {
+        m_entries.reserve(size);
+        m_names.reserve(size);
+    }
+
+    /**
+     * Add an argument to the index.
+     * @param arg Argument to add
+     * @param index Dense index of the argument, see FrozenArgument::index
+     * @param allowDuplicates If false, throws a std::logic_error if another
+     *        argument (not sharing the same key) has a flag or name in common
+     *        with arg
+     */
+    void add(const Argument& arg, std::size_t index, bool allowDuplicates = true);
+
+    /**
+     * Find a positional argument, see find(const std::string&).
+     * @return Matching argument, or nullptr
+     */
+    const FrozenArgument* find() const {
+        return find_if(CanSet());
+    }
+
+    /**
+     * Find an argument by flag, see find(const std::string&).
+     * @param flag Flag to find
+     * @return Matching argument, or nullptr
+     */
+    const FrozenArgument* find(char flag) const {
+        return find_if(CanSet(), flag);
+    }
+
+    /**
+     * Find an argument by name. Returns the first matching argument that can
+     * still be set, or the last matching argument if none can be set. If no
+     * argument matches exactly, the same applies to the pattern arguments
+     * with the longest prefix of name that match it.
+     * @param name Name to find
+     * @return Matching argument, or nullptr if there is none
+     */
+    const FrozenArgument* find(const std::string& name) const {
+        return find_if(CanSet(), name);
+    }
+
+    /**
+     * Find a positional argument, with canSet deciding whether an argument can
+     * still be set instead of its occurrence count (see CanSet).
+     * @param canSet Predicate on FrozenArgument
+     * @return Matching argument, or nullptr
+     */
+    template<typename C>
+    const FrozenArgument* find_if(C canSet) const {
+        return select(m_positional, canSet);
+    }
+
+    /**
+     * Find an argument by flag, see find_if(C).
+     * @param canSet Predicate on FrozenArgument
+     * @param flag Flag to find
+     * @return Matching argument, or nullptr
+     */
+    template<typename C>
+    const FrozenArgument* find_if(C canSet, char flag) const {
+        auto it = m_flags.find(flag);
+        return it == m_flags.end() ? nullptr : select(it->second, canSet);
+    }
+
+    /**
+     * Find an argument by name, see find_if(C) and find(const std::string&).
+     * @param canSet Predicate on FrozenArgument
+     * @param name Name to find
+     * @return Matching argument, or nullptr
+     */
+    template<typename C>
+    const FrozenArgument* find_if(C canSet, const std::string& name) const {
+        auto it = m_names.find(name);
+        return it == m_names.end() ? find_pattern(name, canSet) : select(it->second, canSet);
+    }
+
+    /**
+     * Find the names closest to the given unknown name, for suggestions to the
+     * user. Names are compared by edit distance (see EditDistance), only
+     * visiting names whose length differs by at most the largest distance of
+     * interest, which shrinks once count names are found.
+     * @param name Name to find similar names for
+     * @param max Largest edit distance to consider
+     * @param count Largest number of names to find
+     * @param suggestions Vector to store the names in, closest first and
+     *        otherwise in lexicographic order. Previous contents are discarded
+     */
+    void suggest(const std::string& name, std::size_t max, std::size_t count, std::vector<std::string>& suggestions) const;
+
+    /**
+     * Find the names starting with the given prefix, for shell completion.
+     * Names are kept sorted, so the names are found by a binary search.
+     * @param prefix Prefix of the names
+     * @param names Vector to append the names to, in lexicographic order
+     */
+    void complete(const std::string& prefix, std::vector<const std::string*>& names) const;
+
+    /**
+     * Returns all flags of the indexed arguments.
+     * @return Flags in ascending order
+     */
+    std::string flags() const;
+
+protected:
+    /**
+     * Find a pattern argument by name, see find(const std::string&).
+     * @param name Name to find
+     * @param canSet Predicate on FrozenArgument, see find_if(C)
+     * @return Matching argument, or nullptr if there is none
+     */
+    template<typename C>
+    const FrozenArgument* find_pattern(const std::string& name, C canSet) const;
+
+    /**
+     * Select an argument from the candidates, see find(const std::string&).
+     * @param candidates Positions of matching arguments
+     * @param canSet Predicate on FrozenArgument, see find_if(C)
+     * @return Selected argument, or nullptr if there are no candidates
+     */
+    template<typename C>
+    const FrozenArgument* select(const std::vector<std::size_t>& candidates, C canSet) const;
+
+    /**
+     * Add the last entry to a list of candidates, unless the argument is
+     * already present.
+     * @param candidates Candidates to add the entry to
+     * @param allowDuplicates See add()
+     * @param alias Alias shared by the candidates, used for errors
+     */
+    void insert(std::vector<std::size_t>& candidates, bool allowDuplicates, const std::string& alias) const;
+};
+
+}
+
+}
+
@@ -28,11 +28,110 @@ freely, subject to the following restrictions:
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <cstring>
 
 namespace TAP {
 
 class Argument;
 
+namespace detail {
+class ConstraintProgram;
+}
+
+/**
+ * Markers arguments are shown with in usage and help text and in exception
+ * messages (see BaseArgument::usage()). Arguments are shown with the markers
+ * of TAP::flagStart and TAP::nameStart, unless a BasicArgumentParser shows
+ * them with the markers of its syntax (see detail::MarkerScope).
+ */
+struct Markers {
+    /** Marker for flags, see TAP::flagStart */
+    const char* flagStart;
+
+    /** Marker for names, see TAP::nameStart */
+    const char* nameStart;
+
+    /**
+     * Returns the markers arguments are currently shown with by this thread.
+     * @return The markers
+     */
+    static const Markers& current();
+
+    /**
+     * Returns the markers of a syntax policy (see DefaultSyntax).
+     * @return The markers
+     */
+    template<typename Syntax>
+    static constexpr Markers of() {
+        return Markers{Syntax::flagStart(), Syntax::nameStart()};
+    }
+
+    /**
+     * Compare the markers by their text.
+     * @param other Markers to compare with
+     * @return True if both markers are equal
+     */
+    bool operator==(const Markers& other) const;
+};
+
+namespace detail {
+
+/**
+ * Shows arguments with the given markers while in scope, see
+ * Markers::current(). Scopes nest and only affect the current thread.
+ * Exceptions keep the markers current when they are created.
+ */
+class MarkerScope {
+    /** The markers shown while in scope */
+    Markers m_markers;
+
+    /** Markers shown by the enclosing scope, if any */
+    const Markers* m_previous;
+
+    /**
+     * Returns the markers of the innermost scope of this thread.
+     * @return The markers, nullptr outside any scope
+     */
+    static const Markers*& active() {
+        static thread_local const Markers* markers = nullptr;
+        return markers;
+    }
+
+    friend struct TAP::Markers;
+
+public:
+    /**
+     * Show arguments with the given markers until destroyed.
+     * @param markers The markers to show
+     */
+    explicit MarkerScope(const Markers& markers) :
+        m_markers(markers), m_previous(active()) {
+        active() = &m_markers;
+    }
+
+    /**
+     * Restore the markers of the enclosing scope.
+     */
+    ~MarkerScope() {
+        active() = m_previous;
+    }
+
+    MarkerScope(const MarkerScope&) = delete;
+    MarkerScope& operator=(const MarkerScope&) = delete;
+};
+
+}
+
+inline const Markers& Markers::current() {
+    static constexpr Markers defaults{TAP::flagStart, TAP::nameStart};
+    const Markers* markers = detail::MarkerScope::active();
+    return markers != nullptr ? *markers : defaults;
+}
+
+inline bool Markers::operator==(const Markers& other) const {
+    return std::strcmp(flagStart, other.flagStart) == 0 && std::strcmp(nameStart, other.nameStart) == 0;
+}
+
 /**
  * Base argument class, used both by actual Argument classes and constraints
  * (ArgumentConstraint).
@@ -136,11 +235,23 @@ public:
 
     /**
      * Returns a string representing how the argument may be used on the command
-     * line
+     * line, shown with the current markers (see Markers::current())
      * @return The usage string
      */
     virtual std::string usage() const = 0;
 
+    /**
+     * Compile the checks of this argument into the given program (see
+     * detail::ConstraintProgram).
+     * @param program Program to compile into
+     * @param parent Index of the operation of the enclosing constraint
+     * @param index Set to the index of the operation added for this
+     *        argument, or to the dense index of a plain Argument
+     * @return True if an operation was added to the program for this
+     *         argument, false if it is a plain Argument
+     */
+    virtual bool compile(detail::ConstraintProgram& program, std::size_t parent, std::size_t& index) const = 0;
+
     /**
      * Make a clone of the BaseArgument. Returns a pointer which is owned by
      * the caller.
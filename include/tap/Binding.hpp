@@ -0,0 +1,377 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Binding.hpp
+ * @brief Contains the definitions for binding arguments to the fields of a
+ * struct.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Trait telling whether a field holds multiple values (an std::vector), which
+ * may then occur any number of times.
+ */
+template<typename T>
+struct IsMultiField : std::false_type {
+};
+
+/** See IsMultiField */
+template<typename T, typename A>
+struct IsMultiField< std::vector<T, A> > : std::true_type {
+};
+
+/**
+ * Trait telling whether a field is an std::vector<bool>, which cannot be
+ * bound: its elements are neither switches nor converted from a value.
+ */
+template<typename T>
+struct IsBoolVector : std::false_type {
+};
+
+/** See IsBoolVector */
+template<typename A>
+struct IsBoolVector< std::vector<bool, A> > : std::true_type {
+};
+
+/**
+ * Argument built from a field of a Binding, to parse its description markers
+ * when binding, and to describe the field in help text and exceptions.
+ * Template parameter Base indicates the argument class, Argument for
+ * switches or ValueArgument<std::string> for fields taking a value.
+ */
+template<typename Base>
+class FieldArgument: public Base {
+public:
+    /**
+     * Create an argument with the given description and aliases, see the
+     * constructors of Argument.
+     * @param description Description of the argument, may contain markers
+     * @param aliases Flag and/or name of the argument
+     */
+    template<typename... A>
+    explicit FieldArgument(Description description, A&&... aliases) :
+        Base(std::move(description), std::forward<A>(aliases)...) {
+    }
+
+    /**
+     * Create an argument describing a field, with its aliases already known.
+     * @param field Field of a Binding
+     */
+    template<typename Field, typename = typename std::enable_if<
+            !std::is_convertible<Field, Description>::value >::type>
+    explicit FieldArgument(const Field& field) : Base(Description(std::string())) {
+        this->m_description = field.description;
+        this->m_flags = field.flags;
+        this->m_names = field.names;
+        this->m_isPositional = field.positional;
+        this->m_max = field.max;
+        this->set_required(field.required);
+    }
+
+    /** Returns whether the argument is positional */
+    bool positional() const {
+        return this->m_isPositional;
+    }
+};
+
+}
+
+/**
+ * Binds arguments directly to the fields of a struct C, by member pointers.
+ * Instead of an argument object per field, each field is an entry in a table
+ * (see Field), and parsing writes straight into an instance of C. The same
+ * binding can parse into any number of instances, so the result is just a
+ * plain struct that can be passed around:
+ * @code
+ * struct Config {
+ *     int jobs = 1;
+ *     bool verbose = false;
+ *     std::string input;
+ * };
+ * TAP::Binding<Config> binding;
+ * binding.bind(&Config::jobs, "Number of jobs", 'j', "jobs")
+ *        .bind(&Config::verbose, "Be verbose", 'v')
+ *        .bind(&Config::input, "Input file").set_required();
+ * Config config;
+ * binding.parse(argc, argv, config);
+ * @endcode
+ * Fields of type bool are switches, inverted each time they occur (see
+ * SwitchArgument). Fields of type std::vector collect a value per occurrence,
+ * other fields are converted like ValueArgument. Command lines are read with
+ * the rules of BasicArgumentParser, errors are reported with the same
+ * exceptions. Constraints between fields are not supported.
+ * Template parameter C indicates the struct to bind to.
+ * Template parameter Syntax indicates the syntax policy, see DefaultSyntax.
+ */
+template<typename C, typename Syntax = DefaultSyntax>
+class Binding {
+public:
+    /** Value of failed() if no field is involved */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Entry of the table of fields.
+     */
+    struct Field {
+        /** Description of the field, without markers */
+        std::string description;
+        /** Flags of the field */
+        std::string flags;
+        /** Names of the field */
+        std::vector<std::string> names;
+        /** True if the field is set by positional arguments */
+        bool positional;
+        /** True if the field takes a value, i.e. is not a bool */
+        bool takesValue;
+        /** True if the field has to be set */
+        bool required;
+        /** Maximum number of occurrences, 0 for no limit */
+        unsigned int max;
+        /** Function setting the field of an object, value is nullptr for
+         * switches. Returns false if the value cannot be converted */
+        bool (*set)(C& object, const Field& field, const std::string* value);
+        /** Member pointer of the field, with its type erased */
+        unsigned char member[sizeof(int C::*)];
+    };
+
+private:
+    /** Table of the fields, in the order they were bound */
+    std::vector<Field> m_fields;
+    /** Positions in m_fields by flag, valid if frozen */
+    std::unordered_map<char, std::size_t> m_flags;
+    /** Positions in m_fields by name, valid if frozen */
+    std::unordered_map<std::string, std::size_t> m_names;
+    /** Positions in m_fields of positional fields, valid if frozen */
+    std::vector<std::size_t> m_positional;
+    /** True if the lookup tables are valid, see freeze() */
+    bool m_frozen = false;
+    /** Occurrences per field of the last parse */
+    std::vector<unsigned int> m_counts;
+    /** Field involved in the last error, see failed() */
+    std::size_t m_failed = npos;
+    /** Program name as displayed in help text */
+    std::string m_programName;
+    /** Arguments describing the fields, see describe() */
+    mutable BasicArgumentParser<Syntax> m_described;
+    /** True if m_described is up to date */
+    mutable bool m_describedValid = false;
+
+    class Handler;
+
+    /**
+     * Set the field with member pointer type T, see Field::set.
+     */
+    template<typename T>
+    static bool set_member(C& object, const Field& field, const std::string* value);
+
+    /**
+     * Add a field, see bind().
+     * @param member Member pointer of the field
+     * @param arg Argument holding the description and aliases of the field
+     * @return Reference to this binding
+     */
+    template<typename T>
+    Binding& add_field(T C::* member, const detail::FieldArgument<Argument>& arg);
+
+    /**
+     * Returns the arguments describing the fields, for help text and
+     * suggestions. Built on first use after the fields have changed.
+     * @return Parser holding an argument per field
+     */
+    BasicArgumentParser<Syntax>& describe() const;
+
+public:
+    /**
+     * Bind a positional argument, or if TAP_AUTOFLAG is defined, an argument
+     * with aliases defined by the description.
+     * @param member Field to set
+     * @param description Description of the argument (used in help text)
+     * @return Reference to this binding
+     */
+    template<typename T>
+    Binding& bind(T C::* member, Description description) {
+        return add_field(member, detail::FieldArgument<Argument>(std::move(description)));
+    }
+
+    /**
+     * Bind an argument identified by a flag.
+     * @param member Field to set
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of the argument
+     * @return Reference to this binding
+     */
+    template<typename T>
+    Binding& bind(T C::* member, Description description, char flag) {
+        return add_field(member, detail::FieldArgument<Argument>(std::move(description), flag));
+    }
+
+    /**
+     * Bind an argument identified by a name.
+     * @param member Field to set
+     * @param description Description of the argument (used in help text)
+     * @param name Name identifier of the argument
+     * @return Reference to this binding
+     */
+    template<typename T>
+    Binding& bind(T C::* member, Description description, std::string name) {
+        return add_field(member, detail::FieldArgument<Argument>(std::move(description), std::move(name)));
+    }
+
+    /**
+     * Bind an argument identified by both a flag and a name.
+     * @param member Field to set
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of the argument
+     * @param name Name identifier of the argument
+     * @return Reference to this binding
+     */
+    template<typename T>
+    Binding& bind(T C::* member, Description description, char flag, std::string name) {
+        return add_field(member, detail::FieldArgument<Argument>(std::move(description), flag, std::move(name)));
+    }
+
+    /**
+     * Set whether the field bound last has to be set.
+     * @param required True if the field is required
+     * @return Reference to this binding
+     */
+    Binding& set_required(bool required = true) {
+        last().required = required;
+        return *this;
+    }
+
+    /**
+     * Set the maximum number of occurrences of the field bound last, see
+     * Argument::max(unsigned int).
+     * @param max Maximum number of occurrences, 0 for no limit
+     * @return Reference to this binding
+     */
+    Binding& max(unsigned int max) {
+        last().max = max;
+        return *this;
+    }
+
+    /**
+     * Set the program name, as displayed in the help text. If not set, the
+     * first program argument given to parse() is used.
+     * @param programName Name of the program
+     * @return Reference to this binding
+     */
+    Binding& program_name(const std::string& programName) {
+        m_programName = programName;
+        m_describedValid = false;
+        return *this;
+    }
+
+    /**
+     * Returns the table of fields, in the order they were bound.
+     * @return The fields
+     */
+    const std::vector<Field>& fields() const {
+        return m_fields;
+    }
+
+    /**
+     * Build the lookup tables of the fields. Done by try_parse() if needed,
+     * fields bound afterwards unfreeze the binding. Throws a
+     * std::logic_error if two fields share a flag or name.
+     * @return Reference to this binding
+     */
+    Binding& freeze();
+
+    /**
+     * Parse the given program arguments into object, see
+     * ArgumentParser::parse(). Throws the same exceptions, see raise().
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments, including the program name
+     * @param object Object to set the fields of
+     */
+    void parse(int argc, const char* const argv[], C& object);
+
+    /**
+     * Parse the given program arguments into object without throwing, see
+     * ArgumentParser::try_parse(). Fields are set as their arguments are
+     * read, so on failure object is partially set. The result does not refer
+     * to an argument, see failed() for the field involved.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments, including the program name
+     * @param object Object to set the fields of
+     * @return The first error found, or a successful result
+     */
+    ParseResult try_parse(int argc, const char* const argv[], C& object);
+
+    /**
+     * Throw the exception that parse() would throw for the result of the
+     * last try_parse(), see ArgumentParser::raise().
+     * @param result Result returned by try_parse()
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments given to try_parse()
+     */
+    void raise(const ParseResult& result, int argc, const char* const argv[]) const;
+
+    /**
+     * Returns the position in fields() of the field involved in the error
+     * found by the last try_parse().
+     * @return Position of the field, or npos if none is involved
+     */
+    std::size_t failed() const {
+        return m_failed;
+    }
+
+    /**
+     * Returns the number of times the field at the given position in fields()
+     * occurred in the last parse.
+     * @param field Position of the field
+     * @return Number of occurrences
+     */
+    unsigned int count(std::size_t field) const {
+        return field < m_counts.size() ? m_counts[field] : 0u;
+    }
+
+    /**
+     * Returns the help text describing the fields, see ArgumentParser::help().
+     * @return The help text
+     */
+    std::string help() const {
+        return describe().help();
+    }
+
+private:
+    /**
+     * Returns the field bound last for modification, throws a
+     * std::logic_error if there is none.
+     */
+    Field& last() {
+        if (m_fields.empty()) {
+            throw std::logic_error("No field bound");
+        }
+        m_describedValid = false;
+        return m_fields.back();
+    }
+};
+
+}
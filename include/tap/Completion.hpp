@@ -0,0 +1,64 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Completion.hpp
+ * @brief Contains the definitions for shell completion.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace TAP {
+
+/**
+ * Shells supported by completion_script().
+ */
+enum class Shell {
+    /** GNU Bash */
+    Bash,
+    /** Z shell */
+    Zsh,
+    /** Friendly interactive shell */
+    Fish
+};
+
+/** Name of the argument requesting completion, see
+ * ArgumentParser::complete() */
+constexpr char completeName[] = "complete";
+
+/** Candidate printed by ArgumentParser::complete() if file names should be
+ * completed by the shell */
+constexpr char completeFiles[] = "::files";
+
+/**
+ * Generate the shell glue that completes the command line of a program by
+ * calling it with the completion request, see ArgumentParser::complete().
+ * The script is meant to be sourced by the shell (or installed as a
+ * completion file), e.g. printed by the program on request.
+ * @tparam Syntax Syntax of the parser of the program (see DefaultSyntax)
+ * @param shell Shell to generate the script for
+ * @param program Name of the program as invoked by users
+ * @return Script registering the completion
+ */
+template<typename Syntax = DefaultSyntax>
+std::string completion_script(Shell shell, const std::string& program);
+
+}
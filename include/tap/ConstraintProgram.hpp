@@ -0,0 +1,424 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file ConstraintProgram.hpp
+ * @brief Contains the definitions for compiled constraint evaluation.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Dense set of bits, used to represent which arguments of a frozen parser are
+ * set. Bit i corresponds to the argument with dense index i (see
+ * ConstraintProgram::add()). Sets of different sizes can be combined, missing
+ * words are treated as zero.
+ */
+class BitSet {
+protected:
+    /** Words holding the bits */
+    std::vector<std::uint64_t> m_words;
+
+public:
+    /** Number of bits per word */
+    static constexpr std::size_t wordBits = 64u;
+
+    /**
+     * Create an empty BitSet.
+     */
+    BitSet() {
+    }
+
+    /**
+     * Create a BitSet able to hold the given number of bits, all cleared.
+     * @param bits Number of bits
+     */
+    explicit BitSet(std::size_t bits) : m_words((bits + wordBits - 1) / wordBits, 0u) {
+    }
+
+    /**
+     * Resize to the given number of bits and clear all bits, reusing the
+     * allocated words.
+     * @param bits Number of bits
+     */
+    void assign(std::size_t bits) {
+        m_words.assign((bits + wordBits - 1) / wordBits, 0u);
+    }
+
+    /**
+     * Returns the number of words in use.
+     * @return Number of words
+     */
+    std::size_t words() const {
+        return m_words.size();
+    }
+
+    /**
+     * Returns the raw words of this BitSet.
+     * @return Pointer to the first word
+     */
+    const std::uint64_t* data() const {
+        return m_words.data();
+    }
+
+    /**
+     * Set the given bit, growing the set if required.
+     * @param bit Index of bit to set
+     */
+    void set(std::size_t bit) {
+        std::size_t word = bit / wordBits;
+        if (word >= m_words.size()) {
+            m_words.resize(word + 1, 0u);
+        }
+        m_words[word] |= (std::uint64_t(1) << (bit % wordBits));
+    }
+
+    /**
+     * Returns whether the given bit is set.
+     * @param bit Index of bit to test
+     * @return True iff the bit is set
+     */
+    bool test(std::size_t bit) const {
+        std::size_t word = bit / wordBits;
+        return word < m_words.size() && (m_words[word] & (std::uint64_t(1) << (bit % wordBits))) != 0u;
+    }
+
+    /**
+     * Clear the given bit.
+     * @param bit Index of bit to clear
+     */
+    void reset(std::size_t bit) {
+        std::size_t word = bit / wordBits;
+        if (word < m_words.size()) {
+            m_words[word] &= ~(std::uint64_t(1) << (bit % wordBits));
+        }
+    }
+
+    /**
+     * Clear all bits, keeping the size.
+     */
+    void reset() {
+        std::fill(m_words.begin(), m_words.end(), 0u);
+    }
+
+    /**
+     * Returns whether no bit is set.
+     * @return True iff no bit is set
+     */
+    bool none() const;
+
+    /**
+     * Returns whether this set and other have any bit in common.
+     * @param other Set to intersect with
+     * @return True iff the intersection is not empty
+     */
+    bool intersects(const BitSet& other) const;
+
+    /**
+     * Returns whether any bit is set in this set, but not in other.
+     * @param other Set to subtract
+     * @return True iff the difference is not empty
+     */
+    bool exceeds(const BitSet& other) const;
+
+    /**
+     * Returns the number of bits set in both this set and other.
+     * @param other Set to intersect with
+     * @return Number of bits in the intersection
+     */
+    unsigned int count_common(const BitSet& other) const;
+
+    /**
+     * Add all bits set in other to this set.
+     * @param other Set to add
+     * @return Reference to this set
+     */
+    BitSet& operator|=(const BitSet& other);
+};
+
+/**
+ * Single compiled constraint. Each ArgumentConstraint (and ArgumentSet) in a
+ * frozen parser is translated into one operation, which evaluates the
+ * constraint using only the dense set of set arguments.
+ */
+struct ConstraintOp {
+    /** Type of the constraint */
+    ConstraintType type;
+    /** Bound for counting constraint types (see ArgumentConstraint::bound()) */
+    unsigned int bound;
+    /** Number of direct children of the constraint */
+    unsigned int size;
+    /** True if the constraint itself is required */
+    bool required;
+    /** Index of the parent operation, or ConstraintProgram::npos */
+    std::size_t parent;
+    /** All arguments contained in the constraint, directly or nested */
+    BitSet mask;
+    /** Direct Argument children */
+    BitSet singles;
+    /** Direct Argument children that are required */
+    BitSet requiredSingles;
+    /** Nested children (all children for ConstraintType::Imp), in order */
+    std::vector<BitSet> groups;
+    /** For each entry in groups, whether it is required */
+    std::vector<bool> requiredGroups;
+    /** Constraint this operation was compiled from, used to report errors */
+    const BaseArgument* source;
+    /** Predicates over argument values attached to the constraint */
+    std::vector< std::shared_ptr<const ValuePredicate> > predicates;
+};
+
+/**
+ * Compiled form of the argument and constraint checks of a parser. Arguments
+ * are assigned a dense index, and each constraint is turned into a
+ * ConstraintOp operating on a BitSet indicating which arguments are set. This
+ * way, checking a parse result is only a couple of word operations per
+ * constraint, and multiple results can be checked in one go.
+ */
+class ConstraintProgram {
+protected:
+    /** Arguments by dense index */
+    std::vector<const Argument*> m_args;
+
+    /** Dense index of arguments, by Argument::key() */
+    std::unordered_map<const void*, std::size_t> m_index;
+
+    /** Compiled constraints, in pre-order (parents before children) */
+    std::vector<ConstraintOp> m_ops;
+
+    /** Operations in post-order (children before parents) */
+    std::vector<std::size_t> m_postOrder;
+
+    /** Per argument, the operations with an upper bound containing it */
+    std::vector< std::vector<std::size_t> > m_bounded;
+
+public:
+    /** Index indicating no argument or operation */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Remove all arguments and operations.
+     */
+    void clear();
+
+    /**
+     * Assign a dense index to the given argument. Copies of an argument share
+     * the same index.
+     * @param arg Argument to add
+     * @return Dense index of the argument
+     */
+    std::size_t add(const Argument& arg);
+
+    /**
+     * Compile the given argument (usually an ArgumentSet) as a root
+     * constraint, which is always checked.
+     * @param root Argument or constraint to compile
+     */
+    void add_root(const BaseArgument& root);
+
+    /**
+     * Add an operation for a constraint. Used by BaseArgument::compile().
+     * @param type Type of the constraint
+     * @param bound Bound of the constraint
+     * @param required True if the constraint is required
+     * @param parent Index of the parent operation
+     * @param source Constraint the operation is compiled from
+     * @return Index of the new operation
+     */
+    std::size_t add_op(ConstraintType type, unsigned int bound, bool required, std::size_t parent, const BaseArgument& source);
+
+    /**
+     * Mark the operation as complete, after all its children have been
+     * compiled. Used by BaseArgument::compile().
+     * @param op Index of the operation
+     */
+    void finish_op(std::size_t op) {
+        m_postOrder.push_back(op);
+    }
+
+    /**
+     * Returns the operation at the given index.
+     * @param op Index of the operation
+     * @return Reference to the operation
+     */
+    ConstraintOp& op(std::size_t op) {
+        return m_ops[op];
+    }
+
+    /**
+     * Returns the number of arguments with a dense index.
+     * @return Number of arguments
+     */
+    std::size_t size() const {
+        return m_args.size();
+    }
+
+    /**
+     * Returns the argument with the given dense index.
+     * @param index Dense index of the argument
+     * @return Reference to the argument
+     */
+    const Argument& argument(std::size_t index) const {
+        return *m_args[index];
+    }
+
+    /**
+     * Returns the dense index of the given argument.
+     * @param arg Argument to look up
+     * @return Dense index, or npos if the argument is unknown
+     */
+    std::size_t index(const Argument& arg) const;
+
+    /**
+     * Store which arguments are currently set.
+     * @param set BitSet to store the result in
+     */
+    void state(BitSet& set) const;
+
+    /**
+     * Evaluate all constraints against the given set of set arguments.
+     * @param set Set arguments
+     * @return Index of the first failing operation, or npos if all
+     *         constraints are satisfied
+     */
+    std::size_t check(const BitSet& set) const;
+
+    /**
+     * Evaluate all constraints against a batch of results. Operations are
+     * evaluated for all results at once.
+     * @param sets Set arguments, per result
+     * @param failed Index of the first failing operation per result, or npos
+     */
+    void check(const std::vector<BitSet>& sets, std::vector<std::size_t>& failed) const;
+
+    /**
+     * Evaluate all constraints against the given set of set arguments,
+     * collecting every failing operation instead of only the first.
+     * @param set Set arguments
+     * @param isActive Per operation, non-zero iff it was checked
+     * @param failed Indices of the failing operations are appended to this
+     */
+    void check_all(const BitSet& set, std::vector<unsigned char>& isActive, std::vector<std::size_t>& failed) const;
+
+    /**
+     * Returns the operation at the given index.
+     * @param op Index of the operation
+     * @return Reference to the operation
+     */
+    const ConstraintOp& op(std::size_t op) const {
+        return m_ops[op];
+    }
+
+    /**
+     * Incrementally update set with the given argument, which is about to be
+     * set. Throws an exception if this makes it impossible to satisfy the
+     * occurrence count of the argument, or any constraint with an upper bound
+     * on the number of set arguments (such as ConstraintType::One).
+     * Constraints that can still be satisfied by setting further arguments
+     * are left to check_valid().
+     * @param index Dense index of the argument about to be set
+     * @param set Set arguments, updated with index
+     */
+    void check_set(std::size_t index, BitSet& set) const;
+
+    /**
+     * Non-throwing version of check_set(). The set is only updated if
+     * setting the argument is allowed.
+     * @param index Dense index of the argument about to be set
+     * @param set Set arguments, updated with index
+     * @return ParseError::CountMismatch or ParseError::ConstraintViolated if
+     *         the argument cannot be set, a successful result otherwise
+     */
+    ParseResult try_set(std::size_t index, BitSet& set) const;
+
+    /**
+     * Throw the exception check_set() throws for the given result of
+     * try_set().
+     * @param result Failed result of try_set()
+     */
+    [[noreturn]] void raise_set(const ParseResult& result) const;
+
+    /**
+     * Check the occurrence counts of all arguments and all constraints,
+     * throwing an exception describing the problem if not satisfied (see
+     * BaseArgument::check_valid()). Afterwards, the value predicates of all
+     * checked constraints are evaluated, nested constraints first (see
+     * ArgumentConstraint::check_values()).
+     */
+    void check_valid() const;
+
+    /**
+     * Non-throwing version of check_valid(), checking in the same order. The
+     * buffers are kept by the caller, so repeated checks do not allocate.
+     * @param set Buffer for the set arguments
+     * @param isActive Buffer for the operations checked
+     * @return ParseError::CountMismatch with the argument, or
+     *         ParseError::ConstraintViolated with the constraint of the first
+     *         problem found, a successful result otherwise
+     */
+    ParseResult try_valid(BitSet& set, std::vector<unsigned char>& isActive) const;
+
+protected:
+    /**
+     * Evaluate all constraints against the given set of set arguments,
+     * storing which operations were checked.
+     * @param set Set arguments
+     * @param isActive Per operation, non-zero iff it was checked
+     * @return Index of the first failing operation, or npos
+     */
+    std::size_t check(const BitSet& set, std::vector<unsigned char>& isActive) const;
+
+    /**
+     * Returns whether operation op is to be checked, given whether its parent
+     * is.
+     * @param op Operation to test
+     * @param set Set arguments
+     * @param parentActive True iff the parent operation is checked
+     * @return True iff the operation should be checked
+     */
+    bool active(const ConstraintOp& op, const BitSet& set, bool parentActive) const;
+
+    /**
+     * Returns whether the given (active) operation is satisfied.
+     * @param op Operation to test
+     * @param set Set arguments
+     * @return True iff the operation is satisfied
+     */
+    bool satisfied(const ConstraintOp& op, const BitSet& set) const;
+
+    /**
+     * Returns the number of direct children of a counting operation that
+     * are set.
+     * @param op Operation to count for
+     * @param set Set arguments
+     * @return Number of set children
+     */
+    unsigned int count(const ConstraintOp& op, const BitSet& set) const;
+};
+
+}
+
+}
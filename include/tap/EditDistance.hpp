@@ -0,0 +1,154 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file EditDistance.hpp
+ * @brief Contains the definitions for EditDistance.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Levenshtein distance between a fixed pattern and any number of texts, used
+ * to suggest names for unknown arguments (see ArgumentIndex::suggest()).
+ * Patterns of up to 64 characters use the bit-parallel algorithm of Myers
+ * (1999), computing a column of the distance matrix per character of the
+ * text in a few word operations. Longer patterns fall back to the classic
+ * dynamic program.
+ *
+ * Texts can also be compared a character at a time (see Column), so texts
+ * sharing a prefix only compute the columns of the prefix once, and texts
+ * can be abandoned as soon as a lower bound on their distance is too large.
+ */
+class EditDistance {
+public:
+    /** Longest pattern handled by the bit-parallel algorithm */
+    static constexpr std::size_t maxWordLength = 64;
+
+    /**
+     * Column of the distance matrix, for a prefix of the text. Row i
+     * corresponds to the first i characters of the pattern.
+     */
+    struct Column {
+        /** Bit i set if row i + 1 is one more than row i */
+        std::uint64_t pv;
+        /** Bit i set if row i + 1 is one less than row i */
+        std::uint64_t mv;
+        /** Value of the last row, the distance between the pattern and the
+         * prefix of the text */
+        std::size_t score;
+    };
+
+private:
+    /** Per character, the positions in the pattern where it occurs */
+    std::array<std::uint64_t, 256> m_peq;
+
+    /** The pattern */
+    std::string m_pattern;
+
+    /** Mask of the bits used for the rows of the pattern */
+    std::uint64_t m_mask;
+
+public:
+    /**
+     * Prepare the distance computation for the given pattern.
+     * @param pattern Pattern to compare texts with
+     */
+    explicit EditDistance(std::string pattern);
+
+    /**
+     * Returns whether the pattern can be compared a character at a time,
+     * see Column.
+     * @return True iff the pattern has at most maxWordLength characters
+     */
+    bool bit_parallel() const {
+        return m_pattern.length() <= maxWordLength;
+    }
+
+    /**
+     * Compute the edit distance between the pattern and the given text,
+     * giving up once it is known to exceed max.
+     * @param text Text to compare with
+     * @param max Largest distance of interest
+     * @return The edit distance, or a value larger than max if it exceeds max
+     */
+    std::size_t operator()(const std::string& text, std::size_t max) const {
+        return (*this)(text.data(), text.length(), max);
+    }
+
+    /**
+     * See operator()(const std::string&, std::size_t).
+     * @param text Characters of the text to compare with
+     * @param length Number of characters in text
+     * @param max Largest distance of interest
+     * @return The edit distance, or a value larger than max if it exceeds max
+     */
+    std::size_t operator()(const char* text, std::size_t length, std::size_t max) const;
+
+    /**
+     * Returns the column for the empty text. Requires bit_parallel().
+     * @return First column of the distance matrix
+     */
+    Column start() const {
+        return Column{~std::uint64_t(0), 0u, m_pattern.length()};
+    }
+
+    /**
+     * Compute the next column of the distance matrix. Requires
+     * bit_parallel().
+     * @param column Column to update
+     * @param c Next character of the text
+     */
+    void step(Column& column, char c) const;
+
+    /**
+     * Returns a lower bound on the distance between the pattern and any text
+     * of the given length starting with the prefix of column. Values on a
+     * diagonal of the distance matrix never decrease, so the cell of column
+     * on the diagonal ending in the last cell is a lower bound. Requires
+     * bit_parallel().
+     * @param column Column for a prefix of the text
+     * @param prefix Length of the prefix
+     * @param length Length of the full text
+     * @return Lower bound of the distance
+     */
+    std::size_t lower_bound(const Column& column, std::size_t prefix, std::size_t length) const;
+
+private:
+    /**
+     * Fallback for patterns longer than maxWordLength, see operator()().
+     * @param text Characters of the text to compare with
+     * @param length Number of characters in text
+     * @param max Largest distance of interest
+     * @return The edit distance, or a value larger than max if it exceeds max
+     */
+    std::size_t dynamic(const char* text, std::size_t length, std::size_t max) const;
+};
+
+}
+
+}
@@ -0,0 +1,646 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Embedded.hpp
+ * @brief Contains the definitions for the embedded profile (see TAP_EMBEDDED).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace TAP {
+
+/**
+ * Embedded profile of TAP, which is all that is available when TAP_EMBEDDED
+ * is defined. It mirrors the
+ * main Argument, ValueArgument, ArgumentSet and ArgumentParser classes, but
+ * never allocates and never throws: all containers have a capacity fixed at
+ * compile time, and errors are reported as an Error code. It can be built with
+ * -fno-exceptions and -fno-rtti.
+ * Unlike the main library, the parser stores references to the arguments
+ * instead of copies, so arguments have to outlive the parser.
+ */
+namespace embedded {
+
+/**
+ * Error codes reported by the embedded parser.
+ */
+enum class Error {
+    /** No error */
+    None,
+    /** An argument that is not known to the parser */
+    UnknownArgument,
+    /** An argument that requires a value is not given one */
+    MissingValue,
+    /** An argument that does not take a value is given one */
+    NoValue,
+    /** The value of an argument cannot be converted */
+    InvalidValue,
+    /** An argument occurs more often than allowed */
+    TooManyOccurrences,
+    /** A required argument is not set */
+    MissingRequired,
+    /** A container was filled beyond its capacity */
+    CapacityExceeded,
+    /** Arguments that exclude each other are set together */
+    Conflict
+};
+
+/**
+ * Returns a short description of the given error.
+ * @param error Error to describe
+ * @return Static string describing the error
+ */
+const char* error_string(Error error);
+
+class Argument;
+
+/**
+ * Result of a parse, see ArgumentParser::parse().
+ */
+struct ParseResult {
+    /** Error that occurred, Error::None on success */
+    Error error;
+    /** Index in argv of the offending token, or argc if the error was found
+     * after all tokens were read */
+    int index;
+    /** Argument involved in the error, if any */
+    const Argument* argument;
+
+    /**
+     * Returns whether parsing succeeded.
+     * @return True iff error is Error::None
+     */
+    explicit operator bool() const {
+        return error == Error::None;
+    }
+};
+
+/**
+ * Vector with a fixed capacity, stored inline. Elements are default
+ * constructed up front, so T has to be default constructible.
+ * Template parameter T indicates the type of the elements.
+ * Template parameter N indicates the capacity.
+ */
+template<typename T, std::size_t N>
+class StaticVector {
+    static_assert(N > 0, "StaticVector needs a capacity of at least one");
+
+    /** Storage of the elements */
+    T m_data[N];
+    /** Number of elements in use */
+    std::size_t m_size = 0;
+
+public:
+    /**
+     * Append an element. Fails if the vector is full.
+     * @param value Element to append
+     * @return True iff the element was appended
+     */
+    bool push_back(const T& value) {
+        if (m_size == N) {
+            return false;
+        }
+        m_data[m_size++] = value;
+        return true;
+    }
+
+    /**
+     * Remove all elements.
+     */
+    void clear() {
+        m_size = 0;
+    }
+
+    /** Returns the number of elements */
+    std::size_t size() const {
+        return m_size;
+    }
+
+    /** Returns the capacity */
+    static constexpr std::size_t capacity() {
+        return N;
+    }
+
+    /** Returns true iff there are no elements */
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    /** Returns true iff no more elements fit */
+    bool full() const {
+        return m_size == N;
+    }
+
+    /** Access the element at the given index, which has to be in range */
+    const T& operator[](std::size_t index) const {
+        return m_data[index];
+    }
+
+    /** Access the element at the given index, which has to be in range */
+    T& operator[](std::size_t index) {
+        return m_data[index];
+    }
+
+    /** Returns an iterator to the first element */
+    const T* begin() const {
+        return m_data;
+    }
+
+    /** Returns an iterator past the last element */
+    const T* end() const {
+        return m_data + m_size;
+    }
+};
+
+/**
+ * Argument of the embedded profile, see TAP::Argument. An Argument without a
+ * value is a switch. Arguments without flag and name are positional, which is
+ * only valid for arguments that take a value.
+ */
+class Argument {
+public:
+    /**
+     * Function to set the value of an argument, a null-pointer for arguments
+     * that do not take a value.
+     */
+    using SetValueFunc = Error (*)(Argument& arg, const char* value);
+
+private:
+    /** Description or help text of argument */
+    const char* m_description;
+    /** Flag of this argument, '\0' if none */
+    char m_flag;
+    /** Name of this argument, nullptr if none */
+    const char* m_name;
+    /** Whether the argument has to be set */
+    bool m_required = false;
+    /** Maximum number of occurrences. 0 means no limit */
+    unsigned int m_max = 1;
+    /** Counted number of occurrences */
+    unsigned int m_count = 0;
+    /** Function to set the value, see SetValueFunc */
+    SetValueFunc m_setValue;
+
+protected:
+    /**
+     * Create an argument that takes a value.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument, '\0' if none
+     * @param name Name identifier of this argument, nullptr if none
+     * @param setValue Function to set the value of this argument
+     */
+    Argument(const char* description, char flag, const char* name, SetValueFunc setValue) :
+        m_description(description), m_flag(flag), m_name(name), m_setValue(setValue) {
+    }
+
+public:
+    /**
+     * Create a switch with a flag and optionally a name.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument
+     * @param name Name identifier of this argument, nullptr if none
+     */
+    Argument(const char* description, char flag, const char* name = nullptr) :
+        Argument(description, flag, name, nullptr) {
+    }
+
+    /**
+     * Create a switch with a name.
+     * @param description Description of the argument (used in help text)
+     * @param name Name identifier of this argument
+     */
+    Argument(const char* description, const char* name) :
+        Argument(description, '\0', name, nullptr) {
+    }
+
+    /**
+     * Set whether this argument has to be set.
+     * @param required True if the argument is required
+     * @return Reference to this argument
+     */
+    Argument& set_required(bool required = true) {
+        m_required = required;
+        return *this;
+    }
+
+    /** Returns whether this argument is required */
+    bool required() const {
+        return m_required;
+    }
+
+    /**
+     * Set the maximum number of occurrences, 0 for no limit.
+     * @param max Maximum number of occurrences
+     * @return Reference to this argument
+     */
+    Argument& max(unsigned int max) {
+        m_max = max;
+        return *this;
+    }
+
+    /** Returns the maximum number of occurrences, 0 if unlimited */
+    unsigned int max() const {
+        return m_max;
+    }
+
+    /** Returns the number of times this argument was set */
+    unsigned int count() const {
+        return m_count;
+    }
+
+    /** Returns true iff the argument was set at least once */
+    explicit operator bool() const {
+        return m_count > 0;
+    }
+
+    /** Returns the description of this argument */
+    const char* description() const {
+        return m_description;
+    }
+
+    /** Returns the flag of this argument, '\0' if none */
+    char flag() const {
+        return m_flag;
+    }
+
+    /** Returns the name of this argument, nullptr if none */
+    const char* name() const {
+        return m_name;
+    }
+
+    /** Returns true iff this argument takes a value */
+    bool takes_value() const {
+        return m_setValue != nullptr;
+    }
+
+    /** Returns true iff this argument is positional */
+    bool positional() const {
+        return m_flag == '\0' && m_name == nullptr && takes_value();
+    }
+
+    /** Returns true iff the argument can be set another time */
+    bool can_set() const {
+        return m_max == 0 || m_count < m_max;
+    }
+
+    /**
+     * Returns whether this argument is identified by the given name.
+     * @param name Start of the name to compare
+     * @param length Length of the name to compare
+     * @return True iff the name matches
+     */
+    bool matches(const char* name, std::size_t length) const {
+        return m_name != nullptr && std::strncmp(m_name, name, length) == 0 && m_name[length] == '\0';
+    }
+
+    /**
+     * Set this argument, which must not take a value.
+     * @return Error::TooManyOccurrences if set too often, Error::None otherwise
+     */
+    Error set();
+
+    /**
+     * Set this argument with the given value, which must take a value.
+     * @param value Value to set
+     * @return Error::None on success, otherwise the reason of failure
+     */
+    Error set(const char* value);
+};
+
+namespace detail {
+
+/**
+ * Convert a string to a value, without allocating. Integers accept the
+ * prefixes of strtol (base 0), and have to fit the type.
+ * @param value String to convert
+ * @param storage Variable to write the value to, untouched on failure
+ * @return True iff the conversion succeeded
+ */
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+convert(const char* value, T& storage);
+
+/** See convert(const char*, T&) */
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, bool>::type
+convert(const char* value, T& storage);
+
+/** See convert(const char*, T&) */
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+convert(const char* value, T& storage);
+
+/** Store the string itself, which points into argv. See convert(const char*, T&) */
+inline bool convert(const char* value, const char*& storage) {
+    storage = value;
+    return true;
+}
+
+/**
+ * Result of scan(), the error that stopped reading if any.
+ * Template parameter Entry indicates the type of the entries of the handler.
+ */
+template<typename Entry>
+struct ScanResult {
+    /** Error that stopped reading, Error::None if all tokens were read */
+    Error error;
+    /** Index in argv of the offending token, or argc */
+    int index;
+    /** Entry involved in the error, if any */
+    Entry* entry;
+};
+
+/**
+ * Read the given program arguments with the rules of ArgumentParser::parse(),
+ * looking up each argument and setting it through the handler, without
+ * allocating or throwing. Both the embedded ArgumentParser and StaticParser
+ * read their arguments with it, like the main parser uses TAP::detail::scan().
+ * The handler finds entries (of type Handler::Entry) with find() for
+ * positional arguments, find(flag) and find(name, length), which return
+ * nullptr if there is none. It tells whether an entry takes a value with
+ * takes_value(entry), and sets it with set(entry) or set(entry, value),
+ * returning an Error. Reading stops at the first error.
+ * Template parameter Syntax indicates the syntax policy, see
+ * TAP::DefaultSyntax.
+ * @param argc Number of items in the argv array
+ * @param argv Program arguments, including the program name
+ * @param handler Handler to find and set the arguments
+ * @return The error that stopped reading, or Error::None with index argc
+ */
+template<typename Syntax, typename Handler>
+ScanResult<typename Handler::Entry> scan(int argc, const char* const argv[], Handler& handler);
+
+/**
+ * Parse the given program arguments into the given arguments, see
+ * ArgumentParser::parse().
+ * @param args Arguments to parse into
+ * @param size Number of arguments
+ * @param argc Number of items in the argv array
+ * @param argv Program arguments, including the program name
+ * @return Result of parsing
+ */
+ParseResult parse(Argument* const* args, std::size_t size, int argc, const char* const argv[]);
+
+}
+
+/**
+ * Argument of the embedded profile holding a single value, see
+ * TAP::ValueArgument. If set multiple times (see Argument::max()), the value
+ * is overwritten each time.
+ * Template parameter T indicates the type of the value: an arithmetic type,
+ * or const char* to refer to the string in argv.
+ */
+template<typename T>
+class ValueArgument: public Argument {
+    /** The value */
+    T m_value;
+
+    /** See Argument::SetValueFunc */
+    static Error set_value(Argument& arg, const char* value);
+
+public:
+    /**
+     * Create a positional argument.
+     * @param description Description of the argument (used in help text)
+     * @param value Default value
+     */
+    explicit ValueArgument(const char* description, T value = T()) :
+        Argument(description, '\0', nullptr, &set_value), m_value(value) {
+    }
+
+    /**
+     * Create an argument with a flag and optionally a name.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument
+     * @param name Name identifier of this argument, nullptr if none
+     * @param value Default value
+     */
+    ValueArgument(const char* description, char flag, const char* name = nullptr, T value = T()) :
+        Argument(description, flag, name, &set_value), m_value(value) {
+    }
+
+    /**
+     * Create an argument with a name.
+     * @param description Description of the argument (used in help text)
+     * @param name Name identifier of this argument
+     * @param value Default value
+     */
+    ValueArgument(const char* description, const char* name, T value) :
+        Argument(description, '\0', name, &set_value), m_value(value) {
+    }
+
+    /** Returns the value of this argument */
+    const T& value() const {
+        return m_value;
+    }
+};
+
+/**
+ * Argument of the embedded profile holding up to N values, see
+ * TAP::MultiValueArgument. The maximum number of occurrences defaults to N.
+ * Template parameter T indicates the type of the values, see ValueArgument.
+ * Template parameter N indicates the maximum number of values.
+ */
+template<typename T, std::size_t N>
+class MultiValueArgument: public Argument {
+    /** The values */
+    StaticVector<T, N> m_values;
+
+    /** See Argument::SetValueFunc */
+    static Error set_value(Argument& arg, const char* value);
+
+public:
+    /**
+     * Create a positional argument.
+     * @param description Description of the argument (used in help text)
+     */
+    explicit MultiValueArgument(const char* description) :
+        Argument(description, '\0', nullptr, &set_value) {
+        max(static_cast<unsigned int>(N));
+    }
+
+    /**
+     * Create an argument with a flag and optionally a name.
+     * @param description Description of the argument (used in help text)
+     * @param flag Flag identifier of this argument
+     * @param name Name identifier of this argument, nullptr if none
+     */
+    MultiValueArgument(const char* description, char flag, const char* name = nullptr) :
+        Argument(description, flag, name, &set_value) {
+        max(static_cast<unsigned int>(N));
+    }
+
+    /** Returns the values of this argument */
+    const StaticVector<T, N>& value() const {
+        return m_values;
+    }
+};
+
+/**
+ * Named group of up to N arguments of the embedded profile, see
+ * TAP::ArgumentSet. The set refers to the arguments, it does not copy them.
+ * Template parameter N indicates the maximum number of arguments.
+ */
+template<std::size_t N>
+class ArgumentSet {
+    /** Name of the set */
+    const char* m_name;
+    /** The arguments */
+    StaticVector<Argument*, N> m_args;
+    /** Set if an argument did not fit */
+    bool m_overflow = false;
+
+public:
+    /**
+     * Create a set with the given name and arguments.
+     * @param name Name of the set
+     * @param args Arguments to add
+     */
+    template<typename ... A>
+    explicit ArgumentSet(const char* name, A& ... args) : m_name(name) {
+        add(args...);
+    }
+
+    /**
+     * Add arguments to the set. If the set is full, the arguments that do not
+     * fit are dropped, and the error is reported by the parser.
+     * @param arg Argument to add
+     * @param args Further arguments to add
+     * @return False if the set is full
+     */
+    template<typename ... A>
+    bool add(Argument& arg, A& ... args) {
+        if (!m_args.push_back(&arg)) {
+            m_overflow = true;
+        }
+        return add(args...);
+    }
+
+    /** End of add(Argument&, A&...) */
+    bool add() {
+        return !m_overflow;
+    }
+
+    /** Returns the name of the set */
+    const char* name() const {
+        return m_name;
+    }
+
+    /** Returns the arguments of the set */
+    const StaticVector<Argument*, N>& args() const {
+        return m_args;
+    }
+
+    /** Returns true iff an argument did not fit */
+    bool overflow() const {
+        return m_overflow;
+    }
+};
+
+/**
+ * Parser of the embedded profile for up to N arguments, see
+ * TAP::ArgumentParser. Parsing follows the same rules as the main parser,
+ * and reports errors as a ParseResult.
+ * Template parameter N indicates the maximum number of arguments.
+ */
+template<std::size_t N>
+class ArgumentParser {
+    /** The arguments, in the order added */
+    StaticVector<Argument*, N> m_args;
+    /** Set if an argument did not fit */
+    bool m_overflow = false;
+
+public:
+    /**
+     * Create a parser with the given arguments and argument sets.
+     * @param args Arguments and sets to add
+     */
+    template<typename ... A>
+    explicit ArgumentParser(A& ... args) {
+        add(args...);
+    }
+
+    /**
+     * Add an argument. If the parser is full, the argument is dropped, and
+     * parse() reports Error::CapacityExceeded.
+     * @param arg Argument to add
+     * @return False if the parser is full
+     */
+    bool add(Argument& arg) {
+        if (!m_args.push_back(&arg)) {
+            m_overflow = true;
+        }
+        return !m_overflow;
+    }
+
+    /**
+     * Add all arguments of a set, see add(Argument&).
+     * @param set Set to add the arguments of
+     * @return False if the parser is full, or the set overflowed
+     */
+    template<std::size_t M>
+    bool add(ArgumentSet<M>& set) {
+        for (Argument* arg: set.args()) {
+            add(*arg);
+        }
+        m_overflow = m_overflow || set.overflow();
+        return !m_overflow;
+    }
+
+    /**
+     * Add several arguments and sets, see add(Argument&).
+     * @param arg First argument or set to add
+     * @param args Further arguments or sets to add
+     * @return False if the parser is full
+     */
+    template<typename Arg, typename ... A, typename = typename std::enable_if<(sizeof...(A) > 0)>::type>
+    bool add(Arg& arg, A& ... args) {
+        add(arg);
+        return add(args...);
+    }
+
+    /** End of add(Arg&, A&...) */
+    bool add() {
+        return !m_overflow;
+    }
+
+    /**
+     * Parses the given arguments as they are presented on main(). Parsing
+     * stops at the first error.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments. The first item is expected to be the
+     *             program invocation name
+     * @return Result of parsing, see ParseResult
+     */
+    ParseResult parse(int argc, const char* const argv[]) const {
+        if (m_overflow) {
+            return ParseResult{Error::CapacityExceeded, 0, nullptr};
+        }
+        return detail::parse(m_args.begin(), m_args.size(), argc, argv);
+    }
+};
+
+}
+
+}
@@ -32,11 +32,25 @@ namespace TAP {
 
 /**
  * Standard exception class for TAP. All TAP exceptions are derived from this.
+ * Derived classes may build their message on the first call to what() (see
+ * format()), which is not synchronized between threads.
  */
 class exception : public std::exception {
 protected:
     /** Description of the exception. See what(). */
-    std::string m_what;
+    mutable std::string m_what;
+
+    /** Whether m_what holds the full message, see format() */
+    mutable bool m_formatted = true;
+
+    /**
+     * Build the message of the exception, called on the first call to what()
+     * if m_formatted is false.
+     * @param what String to store the message in
+     */
+    virtual void format(std::string& what) const {
+        (void)what;
+    }
 
 public:
     /**
@@ -54,6 +68,14 @@ public:
      * See std::exception::what().
      */
     const char* what() const noexcept override {
+        if (!m_formatted) {
+            m_formatted = true;
+            try {
+                format(m_what);
+            } catch (...) {
+                // Out of memory, keep what was built so far
+            }
+        }
         return m_what.c_str();
     }
 };
@@ -71,55 +93,133 @@ public:
  * Exception class raised when an unknown argument is encountered.
  */
 class unknown_argument : public command_error {
+    /** The unknown name, if any */
+    std::string m_name;
+    /** The unknown flag, if any */
+    char m_flag = '\0';
+    /** Names of known arguments similar to m_name */
+    std::vector<std::string> m_suggestions;
+    /** Marker suggestions are shown with, see Markers::current() */
+    const char* m_nameStart = Markers::current().nameStart;
+
+protected:
+    /**
+     * See exception::format().
+     */
+    void format(std::string& what) const override;
+
 public:
     /**
      * Creates the exception for positional arguments.
      */
-    unknown_argument() :
-        command_error("No positional arguments are supported") {
+    unknown_argument() : command_error() {
+        m_formatted = false;
     }
 
     /**
      * Creates the exception for flag arguments.
      * @param flag The unknown flag
      */
-    unknown_argument(char flag) :
-        command_error(std::string("The flag argument ") + flag + " is unknown") {
+    unknown_argument(char flag) : command_error(), m_flag(flag) {
+        m_formatted = false;
     }
 
     /**
      * Creates the exception for name arguments.
      * @param name The unknown name
      */
-    unknown_argument(std::string name) :
-        command_error(std::string("The named argument ") + name + " is unknown") {
+    unknown_argument(std::string name) : command_error(), m_name(std::move(name)) {
+        m_formatted = false;
+    }
+
+    /**
+     * Creates the exception for name arguments, suggesting similar names
+     * (see ArgumentParser::suggest()).
+     * @param name The unknown name
+     * @param suggestions Names of known arguments similar to name
+     */
+    unknown_argument(std::string name, std::vector<std::string> suggestions) :
+        command_error(), m_name(std::move(name)), m_suggestions(std::move(suggestions)) {
+        m_formatted = false;
+    }
+
+    /**
+     * Returns the names of known arguments similar to the unknown name,
+     * closest first.
+     * @return Suggested names, without TAP::nameStart
+     */
+    const std::vector<std::string>& suggestions() const {
+        return m_suggestions;
     }
 };
 
 /**
  * Exception class raised when an error occurs verifying a command line
- * argument.
+ * argument. The exception refers to the argument by a shared handle, see
+ * arg(), and builds its message on the first call to what().
  */
 class argument_error : public exception {
+public:
+    /** Shared handle to the argument involved in an error */
+    using Handle = std::shared_ptr<const Argument>;
+
+    /** Value of index() if the position of the error is not known */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
 protected:
-    /** Copy of the argument involved in the error */
-    std::unique_ptr<Argument> m_arg;
+    /** The argument involved in the error, shared between copies of the
+     * exception. Shares ownership with the parser where possible, otherwise
+     * owns a copy of the argument */
+    Handle m_arg;
+
+    /** Index in argv of the offending token, see index() */
+    std::size_t m_index;
+
+    /** Reason of the error, if not described by a derived class */
+    std::string m_reason;
+
+    /** Markers the argument is shown with, current when the exception was
+     * created (see Markers::current()) */
+    Markers m_markers = Markers::current();
+
+    /**
+     * See exception::format(). Builds the message from the usage of the
+     * argument followed by the reason (see reason()).
+     */
+    void format(std::string& what) const override;
+
+    /**
+     * Append the reason of the error to the message, preceded by a space.
+     * @param what Message to append to
+     */
+    virtual void reason(std::string& what) const;
 
 public:
     /**
      * Creates the exception for the given argument, without a specified
      * reason.
-     * @param arg The argument with an error
+     * @param arg The argument with an error, copied
      */
     argument_error(const Argument& arg);
 
     /**
      * Creates the exception for the given argument, with a specified reason.
-     * @param arg The argument with an error
+     * @param arg The argument with an error, copied
      * @param reason The reason of the error
      */
     argument_error(const Argument& arg, const std::string& reason);
 
+    /**
+     * Creates the exception for the given argument handle, without copying
+     * the argument.
+     * @param arg The argument with an error
+     * @param index Index in argv of the offending token, if known
+     */
+    explicit argument_error(Handle arg, std::size_t index = npos) :
+        exception(), m_arg(std::move(arg)), m_index(index) {
+        m_formatted = false;
+    }
+
     /**
      * Returns the argument triggering the error.
      * @return The argument triggering the error
@@ -127,13 +227,48 @@ public:
     const Argument& arg() const {
         return *m_arg;
     }
+
+    /**
+     * Returns the index in argv of the token that caused the error. Errors
+     * found after reading all tokens refer past the last one, see
+     * ParseResult::index().
+     * @return Index of the offending token, or npos if not known
+     */
+    std::size_t index() const {
+        return m_index;
+    }
 };
 
+namespace detail {
+
+/**
+ * Copy the given argument into a handle for argument_error, for arguments
+ * that are not owned by a parser.
+ * @param arg Argument to copy
+ * @return Handle owning the copy
+ */
+inline argument_error::Handle copy_argument(const Argument& arg) {
+    return argument_error::Handle(static_cast<const Argument*>(arg.clone().release()));
+}
+
+}
+
 /**
  * Exception class raised when an argument is used an incorrect amount of
  * times.
  */
 class argument_count_mismatch : public argument_error {
+    /** The number of times the argument occurred */
+    unsigned int m_count;
+    /** The number of times the argument was expected to occur */
+    unsigned int m_expected;
+
+protected:
+    /**
+     * See argument_error::reason().
+     */
+    void reason(std::string& what) const override;
+
 public:
     /**
      * Creates the exception for the given argument, with the number of
@@ -144,20 +279,18 @@ public:
      * @param expected The number of times the argument was expected to occur
      */
     argument_count_mismatch(const Argument& arg, unsigned int count, unsigned int expected) :
-        argument_error(arg) {
-        if (count < expected) {
-            if (expected > 1) {
-                m_what += " is required to occur at least " + std::to_string(expected) + " times";
-            } else {
-                m_what += " is required";
-            }
-        } else {
-            if (expected > 1) {
-                m_what += " can occur at most " + std::to_string(expected) + " times";
-            } else {
-                m_what += " can only be set once";
-            }
-        }
+        argument_error(arg), m_count(count), m_expected(expected) {
+    }
+
+    /**
+     * See argument_count_mismatch(const Argument&, unsigned int, unsigned int).
+     * @param arg The argument with an error
+     * @param count The number of times the argument occurred
+     * @param expected The number of times the argument was expected to occur
+     * @param index Index in argv of the offending token, if known
+     */
+    argument_count_mismatch(Handle arg, unsigned int count, unsigned int expected, std::size_t index = npos) :
+        argument_error(std::move(arg), index), m_count(count), m_expected(expected) {
     }
 };
 
@@ -165,6 +298,18 @@ public:
  * Exception class raised when an argument value is incorrect.
  */
 class argument_invalid_value : public argument_error {
+    /** The value given on the command line */
+    std::string m_value;
+
+protected:
+    /**
+     * See argument_error::reason().
+     */
+    void reason(std::string& what) const override {
+        what += " does not accept the value ";
+        what += m_value;
+    }
+
 public:
     /**
      * Creates the exception for the given argument, with the incorrect value.
@@ -172,7 +317,25 @@ public:
      * @param value The value given on the command line
      */
     argument_invalid_value(const Argument& arg, const std::string& value) :
-        argument_error(arg, std::string("does not accept the value ") + value) {
+        argument_error(arg), m_value(value) {
+    }
+
+    /**
+     * See argument_invalid_value(const Argument&, const std::string&).
+     * @param arg The argument with an error
+     * @param value The value given on the command line
+     * @param index Index in argv of the offending token, if known
+     */
+    argument_invalid_value(Handle arg, std::string value, std::size_t index = npos) :
+        argument_error(std::move(arg), index), m_value(std::move(value)) {
+    }
+
+    /**
+     * Returns the value that was not accepted.
+     * @return The value given on the command line
+     */
+    const std::string& value() const {
+        return m_value;
     }
 };
 
@@ -181,12 +344,29 @@ public:
  * line.
  */
 class argument_missing_value : public argument_error {
+protected:
+    /**
+     * See argument_error::reason().
+     */
+    void reason(std::string& what) const override {
+        what += " requires a value";
+    }
+
 public:
     /**
      * Creates the exception for the given argument, which misses a value.
      */
     argument_missing_value(const Argument& arg) :
-        argument_error(arg, "requires a value") {
+        argument_error(arg) {
+    }
+
+    /**
+     * See argument_missing_value(const Argument&).
+     * @param arg The argument with an error
+     * @param index Index in argv of the offending token, if known
+     */
+    explicit argument_missing_value(Handle arg, std::size_t index = npos) :
+        argument_error(std::move(arg), index) {
     }
 };
 
@@ -194,13 +374,30 @@ public:
  * Exception class raised when an argument value is given but not expected.
  */
 class argument_no_value : public argument_error {
+protected:
+    /**
+     * See argument_error::reason().
+     */
+    void reason(std::string& what) const override {
+        what += " does not accept a value";
+    }
+
 public:
     /**
      * Creates the exception for the given argument, which was given a value
      * but does not accept one.
      */
     argument_no_value(const Argument& arg) :
-        argument_error(arg, "does not accept a value") {
+        argument_error(arg) {
+    }
+
+    /**
+     * See argument_no_value(const Argument&).
+     * @param arg The argument with an error
+     * @param index Index in argv of the offending token, if known
+     */
+    explicit argument_no_value(Handle arg, std::size_t index = npos) :
+        argument_error(std::move(arg), index) {
     }
 };
 
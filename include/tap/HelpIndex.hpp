@@ -0,0 +1,246 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file HelpIndex.hpp
+ * @brief Contains the definitions for HelpQuery and HelpIndex.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TAP {
+
+/**
+ * Selection of entries of the help text, see ArgumentParser::help(const
+ * HelpQuery&). Entries are selected by their group (see
+ * ArgumentSet::name()), a prefix of their names, or a substring of their
+ * identifier and description.
+ */
+class HelpQuery {
+public:
+    /**
+     * The ways entries can be selected.
+     */
+    enum class Kind {
+        /** Entries of the group with the given name */
+        Group,
+        /** Entries with a name (or flag) starting with the pattern */
+        Prefix,
+        /** Entries containing the pattern, ignoring case */
+        Substring
+    };
+
+private:
+    /** How entries are selected */
+    Kind m_kind;
+
+    /** Group name, prefix or substring */
+    std::string m_pattern;
+
+    /**
+     * Construct a query, see the named constructors.
+     * @param kind How entries are selected
+     * @param pattern Group name, prefix or substring
+     */
+    HelpQuery(Kind kind, std::string pattern) :
+        m_kind(kind), m_pattern(std::move(pattern)) {
+    }
+
+public:
+    /**
+     * Select the entries of a group. Namespaces form the group "Namespaces".
+     * @param name Name of the group
+     * @return The query
+     */
+    static HelpQuery group(std::string name) {
+        return HelpQuery(Kind::Group, std::move(name));
+    }
+
+    /**
+     * Select the entries with a name or flag starting with the given prefix,
+     * given without TAP::nameStart. Namespaces are matched by their path.
+     * @param prefix Prefix of the names
+     * @return The query
+     */
+    static HelpQuery prefix(std::string prefix) {
+        return HelpQuery(Kind::Prefix, std::move(prefix));
+    }
+
+    /**
+     * Select the entries whose help line contains the given text, ignoring
+     * case.
+     * @param text Text to search for
+     * @return The query
+     */
+    static HelpQuery search(std::string text) {
+        return HelpQuery(Kind::Substring, std::move(text));
+    }
+
+    /**
+     * Interpret a pattern as given by a user, e.g. the value of --help=pattern.
+     * A pattern ending with ':' selects a group (as titled in the help text),
+     * one ending with '*' selects names by prefix (the name or flag marker of
+     * Syntax may precede the prefix), and any other pattern is searched for.
+     * @tparam Syntax Syntax of the parser the query is for (see DefaultSyntax)
+     * @param pattern Pattern to interpret
+     * @return The query
+     */
+    template<typename Syntax = DefaultSyntax>
+    static HelpQuery parse(const std::string& pattern);
+
+    /**
+     * Returns how entries are selected.
+     * @return Kind of the query
+     */
+    Kind kind() const {
+        return m_kind;
+    }
+
+    /**
+     * Returns the group name, prefix or substring of the query.
+     * @return Pattern of the query
+     */
+    const std::string& pattern() const {
+        return m_pattern;
+    }
+};
+
+namespace detail {
+
+/**
+ * Index over the entries of a HelpLayout, answering HelpQuery. The rows of
+ * the groups and entries are recorded while the layout is built, the lookup
+ * structures are built on the first query (see finish()):
+ * * the names of all entries, sorted, so a prefix selects a contiguous range;
+ * * the distinct trigrams of each lower cased entry line, sorted, so a
+ *   substring of at least three characters only needs to verify the entries
+ *   containing its rarest trigram.
+ * Shorter substrings are verified against every entry.
+ */
+class HelpIndex {
+    /**
+     * Group of entries, see group().
+     */
+    struct Group {
+        /** Name of the group */
+        std::string name;
+        /** Row separating the group from the previous one */
+        std::size_t separator;
+        /** Row of the title */
+        std::size_t title;
+        /** First entry */
+        std::size_t first;
+        /** One past the last entry */
+        std::size_t last;
+    };
+
+    /** Groups, in the order of the layout */
+    std::vector<Group> m_groups;
+
+    /** Row of each entry */
+    std::vector<std::size_t> m_rows;
+
+    /** Group of each entry */
+    std::vector<std::size_t> m_groupOf;
+
+    /** Names with their entry, sorted once finished */
+    std::vector<std::pair<std::string, std::size_t> > m_names;
+
+    /** Lower cased line of each entry, valid once finished */
+    std::vector<std::string> m_texts;
+
+    /** Trigrams with the entries containing them, sorted */
+    std::vector<std::pair<std::uint32_t, std::size_t> > m_trigrams;
+
+    /** True if finish() has been called since the last clear() */
+    bool m_finished = false;
+
+public:
+    /**
+     * Remove all groups and entries.
+     */
+    void clear();
+
+    /**
+     * Start a new group, following entries belong to it.
+     * @param name Name of the group
+     * @param separator Row separating the group from the previous one
+     * @param title Row of the title of the group
+     */
+    void group(std::string name, std::size_t separator, std::size_t title);
+
+    /**
+     * Add an entry to the current group.
+     * @param row Row of the entry
+     */
+    void entry(std::size_t row);
+
+    /**
+     * Add a name to the last entry, matched by HelpQuery::prefix().
+     * @param name Name of the entry
+     */
+    void name(std::string name);
+
+    /**
+     * Returns whether the lookup structures have been built.
+     * @return True iff finish() has been called since the last clear()
+     */
+    bool finished() const {
+        return m_finished;
+    }
+
+    /**
+     * Build the lookup structures from the rows of the finished layout.
+     * @param layout Layout the rows refer to
+     */
+    void finish(const HelpLayout& layout);
+
+    /**
+     * Select the rows to show for a query: the matching entries with the
+     * titles of their groups, in the order of the layout. Requires
+     * finished().
+     * @param query Query to answer
+     * @param rows Vector to append the rows to
+     */
+    void rows(const HelpQuery& query, std::vector<std::size_t>& rows) const;
+
+private:
+    /**
+     * Collect the entries matching a query, in any order.
+     * @param query Query to answer
+     * @param entries Vector to append the entries to
+     */
+    void find(const HelpQuery& query, std::vector<std::size_t>& entries) const;
+
+    /**
+     * Returns the key of a trigram.
+     * @param text First of the three characters
+     * @return Trigram key
+     */
+    static std::uint32_t trigram(const char* text);
+};
+
+}
+
+}
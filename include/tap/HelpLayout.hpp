@@ -0,0 +1,238 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file HelpLayout.hpp
+ * @brief Contains the definitions for HelpLayout.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if !defined(TAP_NOPOSIX) && (defined(__unix__) || defined(__APPLE__))
+#define TAP_POSIX 1
+#endif
+
+namespace TAP {
+
+/**
+ * Returns the width of the terminal the given file descriptor refers to, to
+ * wrap help text with (see ArgumentParser::write_help()). Falls back on the
+ * COLUMNS environment variable if the descriptor is not a terminal, or if
+ * the terminal cannot be queried (without TAP_POSIX).
+ * @param fd File descriptor to query
+ * @return Width in characters, or 0 if unknown
+ */
+std::size_t terminal_width(int fd = 1);
+
+namespace detail {
+
+/**
+ * Rendered help text, laid out once and kept by the parser until its
+ * arguments change (see ArgumentParser::help()). The text consists of rows:
+ * plain lines, and entries with an identifier and a description aligned to
+ * a common column. The unwrapped text is stored as a single string; wrapping
+ * to a width produces a list of pieces pointing into that string, which can
+ * be written without further copying (see write_pieces()).
+ */
+class HelpLayout {
+public:
+    /**
+     * Range of characters of the output.
+     */
+    struct Piece {
+        /** First character */
+        const char* data;
+        /** Number of characters */
+        std::size_t length;
+    };
+
+private:
+    /**
+     * Row of the text, as offsets into m_text (excluding the newline).
+     */
+    struct Row {
+        /** Offset of the first character */
+        std::size_t start;
+        /** Offset of the first character the row may be wrapped at */
+        std::size_t keep;
+        /** Offset past the last character */
+        std::size_t end;
+        /** Indentation of continuation lines when wrapped */
+        std::size_t hang;
+    };
+
+    /**
+     * Row added but not yet laid out, see finish().
+     */
+    struct Pending {
+        /** Line, or identifier of an entry */
+        std::string text;
+        /** Description of an entry */
+        std::string description;
+        /** True for entries */
+        bool entry;
+        /** Unbreakable prefix of a line, also the indentation of its
+         * continuation lines */
+        std::size_t hang;
+    };
+
+    /** Rows waiting for finish() */
+    std::vector<Pending> m_pending;
+
+    /** Laid out rows, valid if m_valid is set */
+    std::vector<Row> m_rows;
+
+    /** Unwrapped text */
+    std::string m_text;
+
+    /** Newline followed by spaces, source of continuation indents */
+    std::string m_indent;
+
+    /** True if finish() has been called since the last clear() */
+    bool m_valid = false;
+
+    /** Width of the cached m_pieces, 0 if none */
+    std::size_t m_width = 0;
+
+    /** Pieces of the text wrapped to m_width */
+    std::vector<Piece> m_pieces;
+
+public:
+    /** Indentation of entries */
+    static constexpr std::size_t entryIndent = 2;
+
+    /** Minimal space between the identifier and description of entries */
+    static constexpr std::size_t entryGap = 2;
+
+    /**
+     * Narrowest line wrapping leaves for text, rows with a larger
+     * indentation are not wrapped.
+     */
+    static constexpr std::size_t minWrap = 16;
+
+    /**
+     * Remove all rows, the layout is invalid until finish() is called.
+     */
+    void clear();
+
+    /**
+     * Returns whether the layout is complete, see finish().
+     * @return True iff finish() has been called since the last clear()
+     */
+    bool valid() const {
+        return m_valid;
+    }
+
+    /**
+     * Add a plain line.
+     * @param text Line, without newline
+     * @param hang Length of the prefix of the line that is not wrapped, also
+     *        the indentation of its continuation lines
+     * @return Index of the row
+     */
+    std::size_t line(std::string text, std::size_t hang = 0);
+
+    /**
+     * Add an entry, aligning its description with those of other entries.
+     * @param ident Identifier of the entry
+     * @param description Description of the entry
+     * @return Index of the row
+     */
+    std::size_t entry(std::string ident, std::string description);
+
+    /**
+     * Lay out the added rows. The column of descriptions follows the longest
+     * identifier.
+     */
+    void finish();
+
+    /**
+     * Returns the unwrapped text. Requires valid().
+     * @return The help text
+     */
+    const std::string& str() const {
+        return m_text;
+    }
+
+    /**
+     * Returns the text of a row, without newline. Requires valid().
+     * @param index Index of the row, see line() and entry()
+     * @return Characters of the row
+     */
+    Piece row(std::size_t index) const {
+        const Row& row = m_rows[index];
+        return Piece{m_text.data() + row.start, row.end - row.start};
+    }
+
+    /**
+     * Returns the text wrapped to the given width. Rows are broken at spaces
+     * and newlines of the wrappable part, continuation lines are indented
+     * (to the description column for entries). Words longer than a line are
+     * not broken. The pieces of the last width are cached. Requires valid().
+     * @param width Maximal line length, 0 to not wrap
+     * @return Pieces of the text, valid until the layout changes
+     */
+    const std::vector<Piece>& pieces(std::size_t width);
+
+    /**
+     * Append the pieces of the given rows wrapped to a width, see
+     * pieces(std::size_t). Takes time linear in the length of these rows
+     * only. Requires valid().
+     * @param rows Indices of the rows, see line() and entry()
+     * @param width Maximal line length, 0 to not wrap
+     * @param pieces Vector to append the pieces to
+     */
+    void pieces(const std::vector<std::size_t>& rows, std::size_t width, std::vector<Piece>& pieces) const;
+
+private:
+    /**
+     * Append the pieces of a row wrapped to a width.
+     * @param row Row to wrap
+     * @param width Maximal line length, 0 to not wrap
+     * @param pieces Vector to append the pieces to
+     */
+    void wrap(const Row& row, std::size_t width, std::vector<Piece>& pieces) const;
+};
+
+/**
+ * Write pieces of text to a stream.
+ * @param out Stream to write to
+ * @param pieces Pieces to write
+ */
+void write_pieces(std::ostream& out, const std::vector<HelpLayout::Piece>& pieces);
+
+#ifdef TAP_POSIX
+/**
+ * Write pieces of text to a file descriptor, gathering as many pieces as
+ * allowed in each writev() call. Retries interrupted and partial writes.
+ * @param fd File descriptor to write to
+ * @param pieces Pieces to write
+ * @return True iff all pieces were written
+ */
+bool write_pieces(int fd, const std::vector<HelpLayout::Piece>& pieces);
+#endif
+
+}
+
+}
@@ -0,0 +1,144 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Markup.hpp
+ *
+ * @brief Contains the definitions for description markup parsed at compile
+ * time.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Description with its flag and name markers parsed at compile time, see
+ * markup(). Holds the same result as Argument::parse_description(): the
+ * description without markers, and the flags and names found.
+ * Template parameter L indicates the size of the description, including the
+ * terminating null character.
+ */
+template<std::size_t L>
+struct Markup {
+    /** Description without the markers, null terminated */
+    char text[L];
+    /** Length of text */
+    std::size_t length;
+    /** Flags marked in the description */
+    char flags[L];
+    /** Number of flags */
+    std::size_t flagCount;
+    /** Names marked in the description, each followed by a null character */
+    char names[L];
+    /** Number of names */
+    std::size_t nameCount;
+};
+
+/**
+ * Returns whether c is alphanumeric (ASCII), usable at compile time.
+ * @param c Character to test
+ * @return True iff c is a letter or digit
+ */
+constexpr bool is_alnum(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+}
+
+/**
+ * Parse the flag and name markers of a description at compile time, like
+ * Argument::parse_description() does at runtime when TAP_AUTOFLAG is defined.
+ * The result can be passed in place of a description to any argument
+ * constructor, which then only copies the precomputed aliases and text:
+ * @code
+ * static constexpr auto helpText = TAP::markup("Show this &help text");
+ * TAP::Argument help(helpText);
+ * @endcode
+ * @param description Description with flag and/or name markers
+ * @return The parsed description
+ */
+template<std::size_t L>
+constexpr detail::Markup<L> markup(const char (&description)[L]);
+
+/**
+ * Description of an argument, as passed to the argument constructors. Either
+ * a plain string, in which markers are parsed at runtime if TAP_AUTOFLAG is
+ * defined, or the result of markup(), which already holds the aliases.
+ * Descriptions from markup() only refer to it, so they are meant to be
+ * passed directly to a constructor.
+ */
+class Description {
+    /** Description, without the markers if parsed */
+    std::string m_text;
+    /** Flags found by markup(), each a single character */
+    const char* m_flags = nullptr;
+    /** Number of flags */
+    std::size_t m_flagCount = 0;
+    /** Names found by markup(), each null terminated */
+    const char* m_names = nullptr;
+    /** Number of names */
+    std::size_t m_nameCount = 0;
+    /** True if the markers have been parsed by markup() */
+    bool m_parsed = false;
+
+    friend class Argument;
+
+public:
+    /**
+     * Create a description from a string.
+     * @param text Text of the description
+     */
+    Description(std::string text) : m_text(std::move(text)) {
+    }
+
+    /**
+     * Create a description from a string.
+     * @param text Text of the description
+     */
+    Description(const char* text) : m_text(text) {
+    }
+
+    /**
+     * Create a description from markers parsed by markup().
+     * @param markup Parsed description, which has to outlive this object
+     */
+    template<std::size_t L>
+    Description(const detail::Markup<L>& markup) :
+        m_text(markup.text, markup.length), m_flags(markup.flags), m_flagCount(markup.flagCount),
+        m_names(markup.names), m_nameCount(markup.nameCount), m_parsed(true) {
+    }
+
+    /** Returns whether the markers have been parsed by markup() */
+    bool parsed() const {
+        return m_parsed;
+    }
+
+    /** Returns the text of the description */
+    const std::string& text() const {
+        return m_text;
+    }
+};
+
+}
@@ -0,0 +1,217 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Namespace.hpp
+ * @brief Contains the definitions for lazily loaded argument namespaces.
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+
+namespace TAP {
+
+/**
+ * Function that adds the arguments of a namespace to the given set, see
+ * ArgumentParser::add_namespace(). The set is named after the path of the
+ * namespace.
+ */
+using NamespaceFactory = std::function<void(ArgumentSet& args)>;
+
+namespace detail {
+
+/**
+ * Node of a trie of argument namespaces, keyed by the segments of namespaced
+ * names (see TAP::namespaceDelim). A node may hold a factory that provides
+ * the arguments of the namespace, which is only invoked the first time a name
+ * in the namespace is looked up (see load()).
+ */
+class Namespace {
+protected:
+    /**
+     * Arguments of a loaded namespace. Shared between copies of a Namespace,
+     * as it is not modified once loaded.
+     */
+    struct Loaded {
+        /** Arguments provided by the factory */
+        ArgumentSet args;
+        /** Lookup of the arguments */
+        ArgumentIndex index;
+        /** Compiled checks of the arguments, see try_valid() */
+        ConstraintProgram program;
+
+        /**
+         * Create an empty set of arguments.
+         * @param path Path of the namespace
+         */
+        Loaded(const std::string& path) : args(path) {
+        }
+    };
+
+    /** Full path of the namespace */
+    std::string m_path;
+
+    /** Description of the namespace, shown in help text */
+    std::string m_description;
+
+    /** Factory providing the arguments, may be empty */
+    NamespaceFactory m_factory;
+
+    /** Nested namespaces by segment */
+    std::map<std::string, Namespace> m_children;
+
+    /** Arguments of the namespace, once loaded */
+    mutable std::shared_ptr<const Loaded> m_loaded;
+
+public:
+    /**
+     * Create an empty namespace.
+     * @param path Full path of the namespace
+     */
+    explicit Namespace(std::string path = std::string()) : m_path(std::move(path)) {
+    }
+
+    /**
+     * Returns the full path of the namespace.
+     * @return Path of the namespace
+     */
+    const std::string& path() const {
+        return m_path;
+    }
+
+    /**
+     * Returns the description of the namespace.
+     * @return Description of the namespace
+     */
+    const std::string& description() const {
+        return m_description;
+    }
+
+    /**
+     * Returns whether the namespace has a factory.
+     * @return True iff arguments can be loaded from the namespace
+     */
+    bool has_factory() const {
+        return static_cast<bool>(m_factory);
+    }
+
+    /**
+     * Returns whether the arguments of the namespace have been loaded.
+     * @return True iff the namespace is loaded
+     */
+    bool loaded() const {
+        return m_loaded != nullptr;
+    }
+
+    /**
+     * Returns whether the namespace has any nested namespaces.
+     * @return True iff there are no nested namespaces
+     */
+    bool empty() const {
+        return m_children.empty();
+    }
+
+    /**
+     * Add a namespace below this one, creating intermediate namespaces as
+     * needed. Replaces the factory of an existing namespace.
+     * @param path Path of the namespace, relative to this one
+     * @param description Description of the namespace
+     * @param factory Factory providing the arguments
+     */
+    void insert(const std::string& path, std::string description, NamespaceFactory factory);
+
+    /**
+     * Find a namespace by its path, relative to this one.
+     * @param path Path of the namespace
+     * @return The namespace, or nullptr if not found
+     */
+    const Namespace* find_namespace(const std::string& path) const;
+
+    /**
+     * Find an argument by its full name. The namespaces along the path of the
+     * name are searched deepest first, loading them if needed.
+     * @param name Name of the argument
+     * @return The frozen entry of the argument, or nullptr if not found
+     */
+    const FrozenArgument* find(const std::string& name) const {
+        return find_if(CanSet(), name);
+    }
+
+    /**
+     * Find an argument by its full name, with canSet deciding whether an
+     * argument can still be set (see ArgumentIndex::find_if()).
+     * @param canSet Predicate on FrozenArgument
+     * @param name Name of the argument
+     * @return The frozen entry of the argument, or nullptr if not found
+     */
+    template<typename C>
+    const FrozenArgument* find_if(C canSet, const std::string& name) const;
+
+    /**
+     * Load the arguments of this namespace, invoking the factory if not done
+     * before.
+     * @return Arguments of this namespace
+     */
+    const ArgumentSet& load() const;
+
+    /**
+     * Check all loaded namespaces, see BaseArgument::check_valid().
+     */
+    void check_valid() const;
+
+    /**
+     * Non-throwing version of check_valid(), see
+     * ConstraintProgram::try_valid().
+     * @param set Buffer for the set arguments
+     * @param isActive Buffer for the operations checked
+     * @return Result describing the first problem found
+     */
+    ParseResult try_valid(BitSet& set, std::vector<unsigned char>& isActive) const;
+
+    /**
+     * Returns a handle to the given argument sharing ownership of the loaded
+     * namespace that provides it, see argument_error.
+     * @param arg Argument to share
+     * @return Handle to the argument, or nullptr if not provided by a loaded
+     *         namespace
+     */
+    std::shared_ptr<const Argument> share(const Argument& arg) const;
+
+    /**
+     * Call the given function for all namespaces below this one that have a
+     * factory, in order of their path.
+     * @param func Function to call with each namespace
+     */
+    template<typename F>
+    void for_each(F func) const {
+        for (auto const& child: m_children) {
+            if (child.second.has_factory()) {
+                func(child.second);
+            }
+            child.second.for_each(func);
+        }
+    }
+};
+
+}
+
+}
+
@@ -26,14 +26,149 @@ freely, subject to the following restrictions:
 #pragma once
 
 namespace TAP {
+
+namespace detail {
+
+/**
+ * Constraint expression, as created by the constraint operators (such as
+ * operator^()). An expression is an ArgumentConstraint that owns its
+ * contents while it is built: chaining operators on it (e.g.
+ * `a ^ b ^ c ^ d`) appends to the same contents instead of copying them, so
+ * every argument is copied once. Copies of an expression share their
+ * contents until either is modified, like ArgumentConstraint.
+ * Template parameter CType indicates the type of the constraint.
+ */
+template<ConstraintType CType>
+class ConstraintExpr : public ArgumentConstraint<CType> {
+public:
+    /**
+     * Create a constraint expression holding a single argument.
+     * @param arg Argument of the constraint
+     */
+    explicit ConstraintExpr(Argument& arg) :
+        ArgumentConstraint<CType>(arg) {
+    }
+
+    /**
+     * Create a constraint expression holding two arguments.
+     * @param left First argument of the constraint
+     * @param right Second argument of the constraint
+     */
+    ConstraintExpr(Argument& left, Argument& right) :
+        ArgumentConstraint<CType>(left, right) {
+    }
+
+    /**
+     * ConstraintExpr copy constructor, see ArgumentConstraint.
+     */
+    ConstraintExpr(const ConstraintExpr&) = default;
+
+    /**
+     * ConstraintExpr move constructor. Takes over the contents of other,
+     * so that appending to this expression does not copy them. The moved
+     * from expression may only be destroyed or assigned to.
+     */
+    ConstraintExpr(ConstraintExpr&& other) :
+        ArgumentConstraint<CType>(other) {
+        other.m_data.reset();
+    }
+
+    /**
+     * ConstraintExpr assignment operator, see ArgumentConstraint.
+     */
+    ConstraintExpr& operator=(const ConstraintExpr&) = default;
+};
+
+/**
+ * Append an argument to a constraint expression.
+ * @param left Expression to append to
+ * @param right Argument to append
+ * @return The expression, with right appended
+ */
+template<ConstraintType CType>
+ConstraintExpr<CType> append(ConstraintExpr<CType> left, Argument& right);
+
+/**
+ * Prepend an argument to a constraint expression.
+ * @param left Argument to prepend
+ * @param right Expression to prepend to
+ * @return Expression holding left followed by the arguments of right
+ */
+template<ConstraintType CType>
+ConstraintExpr<CType> prepend(Argument& left, const ConstraintExpr<CType>& right);
+
+/**
+ * Join two constraint expressions into one, containing the arguments of
+ * left followed by those of right.
+ * @param left Left expression
+ * @param right Right expression
+ * @return Joined expression
+ */
+template<ConstraintType CType>
+ConstraintExpr<CType> join(ConstraintExpr<CType> left, const ConstraintExpr<CType>& right);
+
+/**
+ * Returns the given argument or constraint as-is, see flatten(const
+ * ConstraintExpr&).
+ * @param arg Argument to return
+ * @return The argument
+ */
+template<typename Arg, typename = typename std::enable_if<
+        !IsConstraintExpr<ConstraintType::Imp, typename std::decay<Arg>::type>::value &&
+        !IsConstraintExpr<ConstraintType::One, typename std::decay<Arg>::type>::value &&
+        !IsConstraintExpr<ConstraintType::Any, typename std::decay<Arg>::type>::value >::type >
+Arg&& flatten(Arg&& arg) {
+    return std::forward<Arg>(arg);
+}
+
+/**
+ * Convert a constraint expression into a plain ArgumentConstraint, which
+ * shares its contents.
+ * @param expr Expression to convert
+ * @return ArgumentConstraint holding the arguments of the expression
+ */
+template<ConstraintType CType>
+ArgumentConstraint<CType> flatten(const ConstraintExpr<CType>& expr) {
+    return expr;
+}
+
+}
+
 /**
  * Joins two arguments together using the ConstraintType::One operator.
  * @param left Left argument
  * @param right Right argument
- * @return An ArgumentConstraint containing the given arguments, using the
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::One operator
+ */
+detail::ConstraintExpr<ConstraintType::One> operator^(Argument& left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::One operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::One operator
+ */
+detail::ConstraintExpr<ConstraintType::One> operator^(detail::ConstraintExpr<ConstraintType::One> left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::One operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::One operator
+ */
+detail::ConstraintExpr<ConstraintType::One> operator^(Argument& left, const detail::ConstraintExpr<ConstraintType::One>& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::One operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
  *         ConstraintType::One operator
  */
-ArgumentConstraint<ConstraintType::One> operator^(Argument& left, Argument& right);
+detail::ConstraintExpr<ConstraintType::One> operator^(detail::ConstraintExpr<ConstraintType::One> left, const detail::ConstraintExpr<ConstraintType::One>& right);
 
 /**
  * Joins two arguments together using the ConstraintType::One operator.
@@ -57,10 +192,37 @@ ArgumentConstraint<ConstraintType::One> operator^(Argument& left, ArgumentConstr
  * Joins two arguments together using the ConstraintType::Any operator.
  * @param left Left argument
  * @param right Right argument
- * @return An ArgumentConstraint containing the given arguments, using the
- *         ConstraintType::One operator
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Any operator
+ */
+detail::ConstraintExpr<ConstraintType::Any> operator|(Argument& left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Any operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Any operator
  */
-ArgumentConstraint<ConstraintType::Any> operator|(Argument& left, Argument& right);
+detail::ConstraintExpr<ConstraintType::Any> operator|(detail::ConstraintExpr<ConstraintType::Any> left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Any operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Any operator
+ */
+detail::ConstraintExpr<ConstraintType::Any> operator|(Argument& left, const detail::ConstraintExpr<ConstraintType::Any>& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Any operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Any operator
+ */
+detail::ConstraintExpr<ConstraintType::Any> operator|(detail::ConstraintExpr<ConstraintType::Any> left, const detail::ConstraintExpr<ConstraintType::Any>& right);
 
 /**
  * Joins two arguments together using the ConstraintType::Any operator.
@@ -84,17 +246,44 @@ ArgumentConstraint<ConstraintType::Any> operator|(Argument& left, ArgumentConstr
  * Joins two arguments together using the ConstraintType::Imp operator.
  * @param left Left argument
  * @param right Right argument
- * @return An ArgumentConstraint containing the given arguments, using the
- *         ConstraintType::All operator
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Imp operator
  */
-ArgumentConstraint<ConstraintType::Imp> operator>(Argument& left, Argument& right);
+detail::ConstraintExpr<ConstraintType::Imp> operator>(Argument& left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Imp operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Imp operator
+ */
+detail::ConstraintExpr<ConstraintType::Imp> operator>(detail::ConstraintExpr<ConstraintType::Imp> left, Argument& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Imp operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Imp operator
+ */
+detail::ConstraintExpr<ConstraintType::Imp> operator>(Argument& left, const detail::ConstraintExpr<ConstraintType::Imp>& right);
+
+/**
+ * Joins two arguments together using the ConstraintType::Imp operator.
+ * @param left Left argument
+ * @param right Right argument
+ * @return A constraint expression containing the given arguments, using the
+ *         ConstraintType::Imp operator
+ */
+detail::ConstraintExpr<ConstraintType::Imp> operator>(detail::ConstraintExpr<ConstraintType::Imp> left, const detail::ConstraintExpr<ConstraintType::Imp>& right);
 
 /**
  * Joins two arguments together using the ConstraintType::Imp operator.
  * @param left Left argument
  * @param right Right argument
  * @return An ArgumentConstraint containing the given arguments, using the
- *         ConstraintType::All operator
+ *         ConstraintType::Imp operator
  */
 ArgumentConstraint<ConstraintType::Imp> operator>(ArgumentConstraint<ConstraintType::Imp> left, Argument& right);
 
@@ -103,7 +292,7 @@ ArgumentConstraint<ConstraintType::Imp> operator>(ArgumentConstraint<ConstraintT
  * @param left Left argument
  * @param right Right argument
  * @return An ArgumentConstraint containing the given arguments, using the
- *         ConstraintType::All operator
+ *         ConstraintType::Imp operator
  */
 ArgumentConstraint<ConstraintType::Imp> operator>(Argument& left, ArgumentConstraint<ConstraintType::Imp>& right);
 
@@ -122,6 +311,14 @@ Argument& operator-(Argument& arg);
 template<ConstraintType CType>
 ArgumentConstraint<CType>& operator-(ArgumentConstraint<CType>& arg);
 
+/**
+ * Makes a constraint expression optional.
+ * @param expr Constraint expression to make optional
+ * @return Optional constraint expression
+ */
+template<ConstraintType CType>
+detail::ConstraintExpr<CType> operator-(detail::ConstraintExpr<CType> expr);
+
 /**
  * Makes an argument required.
  * @param arg Argument to make required
@@ -152,6 +349,14 @@ ArgumentConstraint<CType>& operator+(ArgumentConstraint<CType>& arg);
 template<ConstraintType CType>
 ArgumentConstraint<CType>&& operator+(ArgumentConstraint<CType>&& arg);
 
+/**
+ * Makes a constraint expression required.
+ * @param expr Constraint expression to make required
+ * @return Required constraint expression
+ */
+template<ConstraintType CType>
+detail::ConstraintExpr<CType> operator+(detail::ConstraintExpr<CType> expr);
+
 }
 
 
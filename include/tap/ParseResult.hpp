@@ -0,0 +1,252 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file ParseResult.hpp
+ * @brief Contains the definitions for ParseResult.
+ */
+
+#pragma once
+
+#include <exception>
+
+namespace TAP {
+
+namespace detail {
+class ValuePredicate;
+}
+
+/**
+ * Kind of error found while parsing, see ParseResult.
+ */
+enum class ParseError {
+    /** No error */
+    None,
+    /** An argument that is not known to the parser (see unknown_argument) */
+    UnknownArgument,
+    /** An argument that requires a value is not given one (see
+     * argument_missing_value) */
+    MissingValue,
+    /** An argument that does not take a value is given one (see
+     * argument_no_value) */
+    NoValue,
+    /** The value of an argument cannot be converted (see
+     * argument_invalid_value) */
+    InvalidValue,
+    /** An argument occurs too few or too many times (see
+     * argument_count_mismatch) */
+    CountMismatch,
+    /** A constraint or value predicate is not satisfied (see
+     * constraint_error) */
+    ConstraintViolated,
+    /** A check function threw an exception (see Argument::check()) */
+    CheckFailed
+};
+
+/**
+ * Result of ArgumentParser::try_parse(). Describes the first error found, if
+ * any, or the action argument that stopped parsing, without throwing. The
+ * exception ArgumentParser::parse() would throw is only built when requested,
+ * see ArgumentParser::raise().
+ */
+class ParseResult {
+    /** Kind of the error */
+    ParseError m_error = ParseError::None;
+    /** Index in argv of the offending token */
+    std::size_t m_index = 0;
+    /** Offset within the offending token */
+    std::size_t m_offset = 0;
+    /** Offending flag, if any */
+    char m_flag = '\0';
+    /** Argument involved in the error */
+    const Argument* m_argument = nullptr;
+    /** Constraint involved in the error */
+    const BaseArgument* m_constraint = nullptr;
+    /** Value predicate that does not hold */
+    const detail::ValuePredicate* m_predicate = nullptr;
+    /** Exception thrown by a check function */
+    std::exception_ptr m_exception;
+    /** Code of the action argument that stopped parsing */
+    int m_action = 0;
+
+public:
+    /**
+     * Create a successful result.
+     */
+    ParseResult() = default;
+
+    /**
+     * Create a result for the given error.
+     * @param error Kind of the error
+     * @param argument Argument involved in the error, if any
+     * @param constraint Constraint involved in the error, if any
+     */
+    ParseResult(ParseError error, const Argument* argument = nullptr, const BaseArgument* constraint = nullptr) :
+        m_error(error), m_argument(argument), m_constraint(constraint) {
+    }
+
+    /**
+     * Create a result for an unknown flag.
+     * @param flag The unknown flag
+     */
+    static ParseResult unknown_flag(char flag) {
+        ParseResult result(ParseError::UnknownArgument);
+        result.m_flag = flag;
+        return result;
+    }
+
+    /**
+     * Create a result for a value predicate that does not hold.
+     * @param predicate The predicate
+     * @param constraint The constraint the predicate is attached to
+     */
+    static ParseResult predicate_failed(const detail::ValuePredicate* predicate, const BaseArgument* constraint) {
+        ParseResult result(ParseError::ConstraintViolated, nullptr, constraint);
+        result.m_predicate = predicate;
+        return result;
+    }
+
+    /**
+     * Create a result for an exception thrown by a check function.
+     * @param exception The exception
+     * @param argument The argument being set
+     */
+    static ParseResult check_failed(std::exception_ptr exception, const Argument* argument) {
+        ParseResult result(ParseError::CheckFailed, argument);
+        result.m_exception = std::move(exception);
+        return result;
+    }
+
+    /**
+     * Create a successful result for an action argument, which stops
+     * parsing (see ActionArgument).
+     * @param action Code of the action, not 0
+     */
+    static ParseResult stop(int action) {
+        ParseResult result;
+        result.m_action = action;
+        return result;
+    }
+
+    /**
+     * Set the location of the error.
+     * @param index Index in argv of the offending token
+     * @param offset Offset within the token, see offset()
+     * @return Reference to this result
+     */
+    ParseResult& at(std::size_t index, std::size_t offset = 0) {
+        m_index = index;
+        m_offset = offset;
+        return *this;
+    }
+
+    /**
+     * Returns whether parsing succeeded.
+     * @return True iff error() is ParseError::None
+     */
+    explicit operator bool() const {
+        return m_error == ParseError::None;
+    }
+
+    /**
+     * Returns the kind of the error.
+     * @return Kind of the error, ParseError::None on success
+     */
+    ParseError error() const {
+        return m_error;
+    }
+
+    /**
+     * Returns the index in argv of the offending token. Errors found after
+     * all tokens were read (such as missing required arguments) have index
+     * argc.
+     * @return Index of the offending token
+     */
+    std::size_t index() const {
+        return m_index;
+    }
+
+    /**
+     * Returns the offset within the offending token where the problem starts:
+     * the flag for unknown flags, the name for unknown names, and the value
+     * for values given in the same token as their argument. Zero otherwise.
+     * @return Offset within the token
+     */
+    std::size_t offset() const {
+        return m_offset;
+    }
+
+    /**
+     * Returns the offending flag, for unknown flags.
+     * @return The flag, or '\0' if the error does not concern a flag
+     */
+    char flag() const {
+        return m_flag;
+    }
+
+    /**
+     * Returns the argument involved in the error. Copies of the argument
+     * share its count and value.
+     * @return The argument, or nullptr if no single argument is involved
+     */
+    const Argument* argument() const {
+        return m_argument;
+    }
+
+    /**
+     * Returns the constraint involved in the error, for
+     * ParseError::ConstraintViolated.
+     * @return The constraint, or nullptr if none
+     */
+    const BaseArgument* constraint() const {
+        return m_constraint;
+    }
+
+    /**
+     * Returns the value predicate that does not hold, for
+     * ParseError::ConstraintViolated (see
+     * ArgumentConstraint::check_values()).
+     * @return The predicate, or nullptr if a constraint itself is violated
+     */
+    const detail::ValuePredicate* predicate() const {
+        return m_predicate;
+    }
+
+    /**
+     * Returns the exception thrown by a check function, for
+     * ParseError::CheckFailed.
+     * @return The exception, or a null exception_ptr
+     */
+    const std::exception_ptr& exception() const {
+        return m_exception;
+    }
+
+    /**
+     * Returns the code of the action argument that stopped parsing, see
+     * ActionArgument. The arguments after it were not read, and neither
+     * occurrence counts nor constraints were checked. The index of the
+     * result is that of the action argument.
+     * @return The code, or 0 if parsing was not stopped by an action
+     */
+    int action() const {
+        return m_action;
+    }
+};
+
+}
@@ -25,9 +25,99 @@ freely, subject to the following restrictions:
 #pragma once
 
 #include <algorithm> // min/max
+#include <cstring>
 
 namespace TAP {
 
+template<typename Syntax = DefaultSyntax>
+class BasicArgumentParser;
+
+namespace detail {
+
+/**
+ * Read the given program arguments with the rules of BasicArgumentParser,
+ * looking up each argument and passing it to the handler. The handler finds
+ * entries (of type Handler::Entry, with a takesValue member), sets them and
+ * decides whether to continue after an error, see
+ * BasicArgumentParser::SetHandler. Reading stops after an argument without
+ * value for which handler.action(entry) is not 0, see ActionArgument.
+ * Template parameter Syntax indicates the syntax policy, see DefaultSyntax.
+ * @param argv Program arguments, including the program name
+ * @param argc Number of items in the argv array, at least 1
+ * @param handler Handler to set or check the arguments
+ * @return The error that stopped reading, or a successful result
+ */
+template<typename Syntax, typename Handler>
+ParseResult scan(const char* const argv[], std::size_t argc, Handler& handler);
+
+/**
+ * Find the candidates for a word of a command line, see
+ * BasicArgumentParser::completions(). The preceding words are read with
+ * scan(), with a handler that does not convert values. Besides the interface
+ * of scan(), the handler provides pending() (the entry missing its value),
+ * can_set(entry), and adds candidates in complete_value(entry, value, lead,
+ * candidates), complete_names(prefix, candidates) and
+ * complete_flags(candidates), see BasicArgumentParser::CompleteHandler.
+ * @param words Words of the command line, including the program name
+ * @param count Number of words
+ * @param index Index of the word to complete, in [1, count]
+ * @param handler Handler to find and complete the arguments
+ * @param candidates Vector to append the candidates to
+ */
+template<typename Syntax, typename Handler>
+void complete(const char* const words[], std::size_t count, std::size_t index, Handler& handler, std::vector<std::string>& candidates);
+
+}
+
+/**
+ * Errors found by ArgumentParser::validate() in a command line. Reusing the
+ * same object for many command lines avoids allocating for each of them.
+ */
+class ValidationResult {
+    template<typename Syntax>
+    friend class BasicArgumentParser;
+
+    /** All errors found, in order of the tokens */
+    std::vector<ParseResult> m_errors;
+    /** Occurrences per dense argument index */
+    std::vector<unsigned int> m_counts;
+    /** Arguments set, by dense index */
+    detail::BitSet m_set;
+    /** Per constraint operation, whether it was checked */
+    std::vector<unsigned char> m_active;
+    /** Failing constraint operations */
+    std::vector<std::size_t> m_failed;
+    /** Code of the action argument that stopped validation */
+    int m_action = 0;
+
+public:
+    /**
+     * Returns whether the command line is valid.
+     * @return True iff no errors were found
+     */
+    explicit operator bool() const {
+        return m_errors.empty();
+    }
+
+    /**
+     * Returns all errors found, in order of the tokens. Errors found after
+     * reading all tokens (see ParseResult::index()) come last.
+     * @return The errors
+     */
+    const std::vector<ParseResult>& errors() const {
+        return m_errors;
+    }
+
+    /**
+     * Returns the code of the action argument that stopped validation, see
+     * ActionArgument. Only the errors before it are reported.
+     * @return The code, or 0 if the whole command line was checked
+     */
+    int action() const {
+        return m_action;
+    }
+};
+
 /**
  * Argument parser class. Main job is to parse a given set of command line
  * options and feed them into a set of Argument instances, checking the
@@ -42,8 +132,13 @@ namespace TAP {
  * argument itself (e.g. '--alpha=value', see TAP::nameDelim). Effectively,
  * parsing is similar to that of GNU get_opt_long(), except Perl like arguments
  * are not supported.
+ * Template parameter Syntax indicates the markers and delimiter of the
+ * command line (see DefaultSyntax), fixed at compile time. The help text and
+ * exceptions show aliases with the markers of the syntax as well (see
+ * Markers). Use ArgumentParser for the default syntax.
  */
-class ArgumentParser {
+template<typename Syntax>
+class BasicArgumentParser {
 protected:
     /** Collection ArgumentSets (groups) */
     std::vector<ArgumentSet> m_argSets;
@@ -54,19 +149,86 @@ protected:
     /** Program name as displayed in help text. If not set explicitly, will use
      * the first argument of the parse function */
     std::string m_programName;
+
+    /** Compiled argument and constraint checks, valid if m_frozen is set */
+    detail::ConstraintProgram m_program;
+
+    /** Arguments set while parsing, reused by every parse (see
+     * ConstraintProgram::state() and ConstraintProgram::try_valid()) */
+    mutable detail::BitSet m_state;
+
+    /** Operations checked by the last parse, reused by every parse (see
+     * ConstraintProgram::try_valid()) */
+    mutable std::vector<unsigned char> m_active;
+
+    /** Copy of the ArgumentSets sharing the frozen arguments, keeps them alive
+     * for exceptions thrown by raise(). Created on the first error, see
+     * share() */
+    mutable std::shared_ptr<const std::vector<ArgumentSet> > m_owner;
+
+    /** True if the parser has been frozen, see freeze() */
+    bool m_frozen = false;
+
+    /** True if constraints are checked while parsing, see fail_fast() */
+    bool m_failFast = false;
+
+    /** Lookup of arguments by flag and name, valid if m_frozen is set */
+    detail::ArgumentIndex m_index;
+
+    /** False if freezing checks for duplicate aliases, see allow_duplicates() */
+    bool m_allowDuplicates = true;
+
+    /** Root of the namespaces, see add_namespace() */
+    detail::Namespace m_namespaces;
+
+    /** Laid out help text, built by the first call to help() after the
+     * parser has changed */
+    mutable detail::HelpLayout m_help;
+
+    /** Index over m_help for filtered help, built by the first query after
+     * the parser has changed, see help(const HelpQuery&) */
+    mutable detail::HelpIndex m_helpIndex;
 public:
     /**
      * Construct a new ArgumentParser. The given list of Arguments is added to
      * the parser immediately. Does not generate help text.
      * @param args Arguments (or constraints) to add
      */
-    template<typename... Args>
-    ArgumentParser(Args&&... args);
+    template<typename... Args, typename = typename std::enable_if<
+            !detail::IsSingle<BasicArgumentParser, typename std::decay<Args>::type...>::value >::type >
+    BasicArgumentParser(Args&&... args);
+
+    /**
+     * ArgumentParser copy constructor. Arguments and constraints are shared
+     * with other (see ArgumentConstraint), so copying takes time linear in
+     * the number of ArgumentSets only. The copy is not frozen.
+     */
+    BasicArgumentParser(const BasicArgumentParser& other) :
+        m_argSets(other.m_argSets), m_constraints(other.m_constraints),
+        m_programName(other.m_programName), m_failFast(other.m_failFast),
+        m_allowDuplicates(other.m_allowDuplicates), m_namespaces(other.m_namespaces) {
+    }
 
     /**
      * ArgumentParser destructor.
      */
-    virtual ~ArgumentParser() {
+    virtual ~BasicArgumentParser() {
+    }
+
+    /**
+     * ArgumentParser assignment operator, see the copy constructor.
+     */
+    BasicArgumentParser& operator=(const BasicArgumentParser& other) {
+        m_argSets = other.m_argSets;
+        m_constraints = other.m_constraints;
+        m_programName = other.m_programName;
+        m_failFast = other.m_failFast;
+        m_allowDuplicates = other.m_allowDuplicates;
+        m_namespaces = other.m_namespaces;
+        m_owner.reset();
+        m_frozen = false;
+        clear_help();
+        return *this;
     }
 
     /**
@@ -75,8 +237,9 @@ public:
      * is used instead.
      * @return Reference to this ArgumentParser
      */
-    ArgumentParser& program_name(const std::string& programName) {
+    BasicArgumentParser& program_name(const std::string& programName) {
         m_programName = programName;
+        clear_help();
         return *this;
     }
 
@@ -94,7 +257,7 @@ public:
      * @return Reference to this ArgumentParser
      */
     template<typename... Args>
-    ArgumentParser& addAll(Args&&... args);
+    BasicArgumentParser& addAll(Args&&... args);
 
     /**
      * Add the given argument, or constraint, to the parser.
@@ -102,14 +265,36 @@ public:
      * @return Reference to this ArgumentParser
      */
     template<typename Arg>
-    ArgumentParser& add(Arg&& arg);
+    BasicArgumentParser& add(Arg&& arg);
+
+    /**
+     * Add all arguments, or constraints, in the given range to the parser.
+     * Combined with reserve(), this allows to add large numbers of arguments
+     * in linear time.
+     * @param first Iterator to first argument to add
+     * @param last Iterator past the last argument to add
+     * @return Reference to this ArgumentParser
+     */
+    template<typename It>
+    BasicArgumentParser& addRange(It first, It last);
+
+    /**
+     * Reserve space for the given number of arguments to be added with add()
+     * or addRange().
+     * @param size Expected number of arguments
+     * @return Reference to this ArgumentParser
+     */
+    BasicArgumentParser& reserve(std::size_t size) {
+        m_argSets[0].reserve(size);
+        return *this;
+    }
 
     /**
      * Add the given ArgumentSet to the parser.
      * @param argSet ArgumentSet to add
      * @return Reference to this ArgumentParser
      */
-    ArgumentParser& add(ArgumentSet argSet);
+    BasicArgumentParser& add(ArgumentSet argSet);
 
     /**
      * Add the given constraint, to the parser. Constraints are not shown in
@@ -120,7 +305,53 @@ public:
      * @return Reference to this ArgumentParser
      */
     template<typename Arg>
-    ArgumentParser& addConstraint(Arg&& constr);
+    BasicArgumentParser& addConstraint(Arg&& constr);
+
+    /**
+     * Add a namespace of arguments to the parser. The arguments are provided
+     * by the given factory, which is only invoked once a name within the
+     * namespace occurs on the command line (or its help is requested, see
+     * help(const std::string&)). The names of the arguments must include the
+     * path of the namespace, for example:
+     * @code
+     * parser.add_namespace("db.pool", "Connection pool", [](ArgumentSet& args) {
+     *     args.add(ValueArgument<int>("Pool size", "db.pool.size", 8));
+     * });
+     * @endcode
+     * Namespaces are looked up through a trie of the segments of the name
+     * (see TAP::namespaceDelim), most specific namespace first, and only if
+     * no regular argument matches the name. Arguments of a namespace are
+     * checked after parsing (see BaseArgument::check_valid()) if the
+     * namespace has been loaded, but are not part of the constraints of the
+     * parser.
+     * @param path Path of the namespace, e.g. "db.pool"
+     * @param description Description of the namespace, shown in help text
+     * @param factory Function adding the arguments to the namespace
+     * @return Reference to this ArgumentParser
+     */
+    BasicArgumentParser& add_namespace(const std::string& path, std::string description, NamespaceFactory factory) {
+        m_namespaces.insert(path, std::move(description), std::move(factory));
+        clear_help();
+        return *this;
+    }
+
+    /**
+     * Add a predicate over the values of the given arguments to the parser,
+     * which is checked after all arguments have been parsed. See
+     * ArgumentConstraint::check_values() for details.
+     * @param reason Reason reported if the predicate does not hold
+     * @param predicate Function object called with the arguments, returning
+     *        true iff their values are valid
+     * @param args Arguments to pass to the predicate
+     * @return Reference to this ArgumentParser
+     */
+    template<typename F, typename... A>
+    BasicArgumentParser& check_values(std::string reason, F predicate, const A&... args) {
+        m_constraints.check_values(std::move(reason), std::move(predicate), args...);
+        m_frozen = false;
+        clear_help();
+        return *this;
+    }
 
     /**
      * Get the Argument given the flag. If the Argument is not contained
@@ -144,29 +375,294 @@ public:
      */
     const Argument& operator[](const std::string& name) const {
         const Argument* arg = findArg(name);
+        if (arg == nullptr) {
+            const detail::FrozenArgument* entry = m_namespaces.find(name);
+            arg = entry == nullptr ? nullptr : entry->arg;
+        }
         if (arg == nullptr) {
             throw std::out_of_range("Argument not found");
         }
         return *arg;
     }
 
+    /**
+     * Enable or disable failing fast. If enabled, the occurrence counts of
+     * arguments and constraints that limit the number of set arguments (such
+     * as ConstraintType::One) are checked each time an argument is
+     * encountered, before its value is converted. The parse is aborted as
+     * soon as they can no longer be satisfied, instead of after all
+     * arguments have been processed. Remaining constraints are still checked
+     * at the end.
+     * @param failFast If true, fail as soon as a constraint is violated
+     * @return Reference to this ArgumentParser
+     */
+    BasicArgumentParser& fail_fast(bool failFast = true) {
+        m_failFast = failFast;
+        return *this;
+    }
+
+    /**
+     * Returns whether the parser fails fast, see fail_fast(bool).
+     * @return True iff the parser fails fast
+     */
+    bool fail_fast() const {
+        return m_failFast;
+    }
+
+    /**
+     * Allow or disallow different arguments to share the same flag or name.
+     * By default this is allowed (see the Quirks section of the
+     * documentation). If disallowed, freeze() throws a std::logic_error when
+     * it finds such aliases.
+     * @param allow If false, check for duplicate aliases
+     * @return Reference to this ArgumentParser
+     */
+    BasicArgumentParser& allow_duplicates(bool allow = true) {
+        m_allowDuplicates = allow;
+        m_frozen = false;
+        return *this;
+    }
+
+    /**
+     * Returns whether different arguments may share the same flag or name,
+     * see allow_duplicates(bool).
+     * @return True iff duplicate aliases are allowed
+     */
+    bool allow_duplicates() const {
+        return m_allowDuplicates;
+    }
+
+    /**
+     * Freeze the parser. All arguments are assigned a dense index and hashed
+     * by flag and name (see detail::ArgumentIndex), and all constraints are
+     * compiled (see detail::ConstraintProgram), so checking the result of a
+     * parse only takes a few word operations per constraint. All of this
+     * takes time linear in the number of arguments. This is done
+     * automatically by parse() if needed. Adding arguments or constraints to
+     * the parser unfreezes it.
+     * @return Reference to this ArgumentParser
+     */
+    BasicArgumentParser& freeze();
+
+    /**
+     * Returns whether the parser is frozen, see freeze().
+     * @return True iff the parser is frozen
+     */
+    bool frozen() const {
+        return m_frozen;
+    }
+
+    /**
+     * Returns the compiled checks of this parser. Only valid if the parser
+     * is frozen, see freeze().
+     * @return Compiled argument and constraint checks
+     */
+    const detail::ConstraintProgram& program() const {
+        return m_program;
+    }
+
     /**
      * Generate a help string for the user to see. Contains a short usage line,
-     * and a list of accepted arguments with their descriptions.
+     * and a list of accepted arguments with their descriptions. The text is
+     * laid out once and kept until the parser changes, so repeated calls are
+     * cheap.
+     * @return A string with help text, valid until the parser changes
+     */
+    const std::string& help() const;
+
+    /**
+     * Write the help text (see help()) to a stream, wrapped to the given
+     * width. Descriptions continue on the next line at their column, the
+     * usage line is not wrapped.
+     * @param out Stream to write to
+     * @param width Maximal line length, 0 to not wrap
+     */
+    void write_help(std::ostream& out, std::size_t width = 0) const;
+
+#ifdef TAP_POSIX
+    /**
+     * Write the help text to a file descriptor, wrapped to the width of the
+     * terminal it refers to (see terminal_width()). The text is written with
+     * writev() directly from the cached layout, without building a string.
+     * @param fd File descriptor to write to
+     * @return True iff all text was written
+     */
+    bool write_help(int fd) const {
+        return write_help(fd, terminal_width(fd));
+    }
+
+    /**
+     * Write the help text to a file descriptor, wrapped to the given width.
+     * @param fd File descriptor to write to
+     * @param width Maximal line length, 0 to not wrap
+     * @return True iff all text was written
+     */
+    bool write_help(int fd, std::size_t width) const;
+#endif
+
+    /**
+     * Generate the help text of the entries selected by a query, with the
+     * titles of their groups but without the usage line. Queries are
+     * answered from an index built once after the parser changes, taking
+     * time proportional to the matches rather than all arguments (see
+     * HelpQuery for the kinds of queries).
+     * @param query Entries to show
+     * @return Help text of the matching entries, empty if none match
+     */
+    std::string help(const HelpQuery& query) const;
+
+    /**
+     * Write the help text of the entries selected by a query to a stream,
+     * see help(const HelpQuery&) and write_help(std::ostream&, std::size_t).
+     * @param out Stream to write to
+     * @param query Entries to show
+     * @param width Maximal line length, 0 to not wrap
+     */
+    void write_help(std::ostream& out, const HelpQuery& query, std::size_t width = 0) const;
+
+#ifdef TAP_POSIX
+    /**
+     * Write the help text of the entries selected by a query to a file
+     * descriptor, see help(const HelpQuery&) and write_help(int).
+     * @param fd File descriptor to write to
+     * @param query Entries to show
+     * @param width Maximal line length, 0 to not wrap
+     * @return True iff all text was written
+     */
+    bool write_help(int fd, const HelpQuery& query, std::size_t width) const;
+#endif
+
+    /**
+     * Generate a help string for the given namespace (see add_namespace()),
+     * loading it if needed. Contains the description and arguments of the
+     * namespace, and lists nested namespaces. Throws std::out_of_range if
+     * the namespace does not exist.
+     * @param path Path of the namespace
      * @return A string with help text.
      */
-    std::string help() const;
+    std::string help(const std::string& path) const;
 
     /**
      * Parses the given arguments as they are presented on main() (see the
      * parsing rules in the description of the ArgumentParser class). Throws an
-     * exception if parsing fails, otherwise returns a boolean indicating if the
-     * program should continue or stop (e.g. after displaying help).
+     * exception if parsing fails, otherwise returns the code of the action
+     * argument that stopped parsing (e.g. to display help, see
+     * ActionArgument), or 0 if the program should continue.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments. The first item is expected to be the
+     *             program invocation name
+     * @return Code of the action to perform, or 0
+     */
+    int parse(int argc, const char* const argv[]);
+
+    /**
+     * Parses the given arguments like parse(), but reports the first problem
+     * found as a ParseResult instead of throwing. No exceptions are thrown
+     * while parsing, except by check functions (see Argument::check()).
+     * Any std::exception they throw is caught and reported as
+     * ParseError::CheckFailed.
      * @param argc Number of items in the argv array
      * @param argv Program arguments. The first item is expected to be the
      *             program invocation name
+     * @return Result of parsing, see ParseResult
+     */
+    ParseResult try_parse(int argc, const char* const argv[]);
+
+    /**
+     * Throw the exception parse() throws for the given failed result of
+     * try_parse(). Does nothing if the result is successful. Errors found
+     * after reading all arguments are described by checking the arguments and
+     * constraints again.
+     * @param result Result of try_parse()
+     * @param argc Number of items in the argv array passed to try_parse()
+     * @param argv Program arguments passed to try_parse()
+     */
+    void raise(const ParseResult& result, int argc, const char* const argv[]) const;
+
+    /**
+     * Suggest names of arguments similar to the given unknown name, such as a
+     * mistyped name. Names are considered similar if their edit distance is
+     * at most about a third of the length of name (at least one). Names
+     * provided by namespaces are not considered. Suggestions are also included
+     * in the unknown_argument exception thrown by parse().
+     * @param name The unknown name, without TAP::nameStart
+     * @param count Largest number of names to return
+     * @return Similar names, closest first
+     */
+    std::vector<std::string> suggest(const std::string& name, std::size_t count = 3);
+
+    /**
+     * Find the candidates for a word of a command line, for shell completion.
+     * Only the context of the word is resolved from the preceding words,
+     * values are neither converted nor checked:
+     * * if the preceding word is an argument missing its value, or the word
+     *   is a name or flag cluster with a value attached, the choices of that
+     *   argument (see Argument::choices());
+     * * if the word starts with TAP::nameStart, the names with that prefix
+     *   that can still be set, and the namespaces (see add_namespace());
+     * * if the word is a flag cluster of known flags, the word itself;
+     * * otherwise the choices of the positional argument receiving the word,
+     *   or all flags, names and namespaces if the word is empty and no
+     *   positional argument receives it.
+     * Arguments offering file names add TAP::completeFiles to the
+     * candidates. Freezes the parser if needed.
+     * @param words Words of the command line, including the program name
+     * @param count Number of words
+     * @param index Index of the word to complete, may be count for a new word
+     * @return Candidates for the word, sorted for names
+     */
+    std::vector<std::string> completions(const char* const words[], std::size_t count, std::size_t index);
+
+    /**
+     * Answer a completion request, as sent by the scripts of
+     * completion_script(). If the first argument is TAP::completeName after
+     * the name marker of the syntax (e.g. '--complete'), the arguments are the index of the word to complete
+     * followed by the words of the command line, and the candidates (see
+     * completions()) are written to out one per line. Call before parse(),
+     * and exit if this returns true: @code
+     * if (parser.complete(argc, argv, std::cout)) {
+     *     return 0;
+     * }
+     * parser.parse(argc, argv);
+     * @endcode
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments
+     * @param out Stream to write the candidates to
+     * @return True iff the arguments were a completion request
      */
-    void parse(int argc, const char* const argv[]);
+    bool complete(int argc, const char* const argv[], std::ostream& out);
+
+    /**
+     * Export the arguments as a schema, which SchemaView reads in place, e.g.
+     * from a file mapped with MappedFile. Other programs can then validate
+     * and complete command lines of this program without running it. The
+     * schema holds the flags and names (as a trie), descriptions, value
+     * kinds (see ValueKind), choices, occurrence counts and the syntax. The
+     * arguments of namespaces, pattern arguments and constraints are not
+     * exported. The format is versioned and uses the byte order of this
+     * machine. Freezes the parser if needed.
+     * @return The schema
+     */
+    std::string export_schema();
+
+    /**
+     * Check the given arguments without setting them, collecting all errors
+     * instead of stopping at the first. Arguments are looked up and values are
+     * converted as by parse(), but neither the counts nor the values of the
+     * arguments are modified, and check functions are not called. Afterwards,
+     * occurrence counts and constraints are checked, unless an action
+     * argument stopped validation (see ValidationResult::action()). Value
+     * predicates (see
+     * check_values()) and constraints within namespaces are not checked, as
+     * they need the values to be set.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments. The first item is expected to be the
+     *             program invocation name
+     * @param result Buffer to store the errors in, previous contents are
+     *               discarded
+     * @return True iff the arguments are valid
+     */
+    bool validate(int argc, const char* const argv[], ValidationResult& result);
 
 private:
     /**
@@ -190,22 +686,67 @@ private:
     const Argument* findArg(Ident ident) const;
 
     /**
-     * Parses the given argument vector (see the parsing rules in the
-     * description of the ArgumentParser class). Throws an exception if parsing
-     * fails, otherwise returns a Boolean indicating if the program should
-     * continue or stop (e.g. after displaying help).
-     * @param argv Program arguments. This vector may be modified by this
-     *             function
+     * Parses the given program arguments (see the parsing rules in the
+     * description of the ArgumentParser class), see try_parse(). The
+     * arguments are read in place, names and values are assembled in buffers
+     * that are reused for every token.
+     * @param argv Program arguments, including the program name
+     * @param argc Number of items in the argv array, at least 1
+     * @return Result of parsing
      */
-    void parse(std::vector<std::string>& argv) const;
+    ParseResult parse_args(const char* const argv[], std::size_t argc) const;
 
     /**
-     * Helper function to set the value of an Argument of which takes_value()
-     * returns true.
-     * @param arg Argument to set value to
-     * @param value Value to set
+     * Returns a handle to the given argument for exceptions (see
+     * argument_error), sharing ownership of the frozen arguments of this
+     * parser or its namespaces instead of copying the argument.
+     * @param arg Argument to share, copied if not owned by this parser
+     * @return Handle to the argument
      */
-    void set_arg_value(const Argument* arg, const std::string& value) const;
+    std::shared_ptr<const Argument> share(const Argument& arg) const;
+
+    /**
+     * Returns the laid out help text, laying it out if the parser changed
+     * since the last call.
+     * @return The help layout
+     */
+    detail::HelpLayout& layout() const;
+
+    /**
+     * Collect the pieces of the help text of the entries selected by a
+     * query, building the index if needed.
+     * @param query Entries to show
+     * @param width Maximal line length, 0 to not wrap
+     * @param pieces Vector to append the pieces to
+     */
+    void help_pieces(const HelpQuery& query, std::size_t width, std::vector<detail::HelpLayout::Piece>& pieces) const;
+
+    /**
+     * Discard the help layout and index, after the parser changed.
+     */
+    void clear_help() const {
+        m_help.clear();
+        m_helpIndex.clear();
+    }
+
+    class SetHandler;
+    class CheckHandler;
+    class CompleteHandler;
+
+    /**
+     * When failing fast, update the given state with an argument that is
+     * about to be set (see fail_fast() and ConstraintProgram::try_set()).
+     * @param arg Frozen entry of the argument about to be set
+     * @param state Arguments set so far
+     * @return Failed result if the argument cannot be set
+     */
+    ParseResult try_set(const detail::FrozenArgument& arg, detail::BitSet& state) const;
 };
 
+/**
+ * Argument parser with the syntax configured in Tap.h, see
+ * BasicArgumentParser and DefaultSyntax.
+ */
+using ArgumentParser = BasicArgumentParser<>;
+
 }
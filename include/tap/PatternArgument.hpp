@@ -0,0 +1,239 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file PatternArgument.hpp
+ * @brief Contains the definitions for PatternArguments.
+ */
+
+#pragma once
+
+#include <map>
+
+namespace TAP {
+
+/**
+ * Argument matching a family of names, instead of a fixed name. A name
+ * matches if it consists of a fixed prefix, followed by a key and a fixed
+ * suffix. The key must be convertible to type K, for example:
+ * @code
+ * // Matches --shard-0-weight, --shard-1-weight, ...
+ * PatternArgument<unsigned int, double> weights("Shard weight", "shard-", "-weight");
+ * // Matches --feature.<name>, with any non-empty name
+ * PatternArgument<std::string, std::string> features("Feature", "feature.");
+ * @endcode
+ * Each key that occurs stores its value in a map (see values()), so a family
+ * costs one argument regardless of the number of keys. Names are only
+ * matched against patterns if no argument matches them exactly. By default,
+ * a PatternArgument may occur any number of times, but min() and max() apply
+ * to the total number of occurrences.
+ * Template parameter K indicates the type of the key.
+ * Template parameter T indicates the type of the value. If bool, the argument
+ * does not take a value, and true is stored for each key that occurs.
+ */
+template<typename K, typename T>
+class PatternArgument : public Argument, public ValueAcceptor {
+    static_assert(!std::is_void<T>::value, "Cannot make void arguments, use plain Argument");
+    static_assert(!std::is_const<T>::value, "Cannot make const arguments");
+    static_assert(!std::is_reference<T>::value, "Cannot make reference arguments");
+
+protected:
+    /** Prefix of matching names */
+    std::string m_prefix;
+
+    /** Suffix of matching names */
+    std::string m_suffix;
+
+    /** Values by key, shared between copies of the argument */
+    std::shared_ptr< std::map<K, T> > m_values;
+
+    /** Key of the name last matched by matches_pattern() */
+    mutable K m_key;
+
+    /** Name of the accepted value, used in the identifier */
+    std::string m_valueName = std::string("value");
+
+public:
+    /**
+     * Create a PatternArgument matching names consisting of the given prefix,
+     * a key, and the given suffix.
+     * @param description Description of the argument (used in help text)
+     * @param prefix Prefix of matching names
+     * @param suffix Suffix of matching names
+     */
+    PatternArgument(Description description, std::string prefix, std::string suffix = std::string()) :
+        Argument(std::move(description)), m_prefix(std::move(prefix)), m_suffix(std::move(suffix)),
+        m_values(std::make_shared< std::map<K, T> >()), m_key() {
+        m_isPositional = false;
+        m_max = 0;
+    }
+
+    /**
+     * PatternArgument copy constructor.
+     */
+    PatternArgument(const PatternArgument&) = default;
+
+    /**
+     * PatternArgument move constructor.
+     */
+    PatternArgument(PatternArgument&&) = default;
+
+    /**
+     * PatternArgument destructor.
+     */
+    virtual ~PatternArgument() = default;
+
+    /**
+     * PatternArgument copy assignment operator.
+     */
+    PatternArgument& operator=(const PatternArgument&) = default;
+
+    /**
+     * PatternArgument move assignment operator.
+     */
+    PatternArgument& operator=(PatternArgument&&) = default;
+
+    /**
+     * Set the name of the value, as displayed in the help text.
+     * @param valueName Name of the value
+     * @return Reference to this argument
+     */
+    PatternArgument& valuename(const std::string& valueName) {
+        m_valueName = valueName;
+        return *this;
+    }
+
+    /**
+     * Returns the name of the value, see valuename(const std::string&).
+     * @return Name of the value
+     */
+    const std::string& valuename() const {
+        return m_valueName;
+    }
+
+    /**
+     * Returns the values of all keys that occurred.
+     * @return Map from key to value
+     */
+    const std::map<K, T>& values() const {
+        return *m_values;
+    }
+
+    /**
+     * See Argument::matches_pattern(). If the name matches, its key is used
+     * when the argument is set next.
+     */
+    bool matches_pattern(const std::string& name) const override;
+
+    /**
+     * See Argument::pattern()
+     */
+    const std::string* pattern() const override {
+        return &m_prefix;
+    }
+
+    /**
+     * See Argument::takes_value()
+     */
+    bool takes_value() const override {
+        return !std::is_same<bool, T>::value;
+    }
+
+    /**
+     * See Argument::ops()
+     */
+    const detail::ArgumentOps& ops() const override {
+        static const detail::ArgumentOps ops = { &Argument::set_argument, &PatternArgument::set_value, &PatternArgument::check_value, ValueKind::Text };
+        return ops;
+    }
+
+    /**
+     * See Argument::acceptor()
+     */
+    const ValueAcceptor* acceptor() const override {
+        return this;
+    }
+
+    /**
+     * See Argument::set()
+     */
+    void set() const override;
+
+    /**
+     * See ValueAcceptor::set(). To change how values are set, override
+     * try_set() instead, which is what the parser calls.
+     */
+    void set(const std::string& value) const final;
+
+    /**
+     * See ValueAcceptor::try_set()
+     */
+    bool try_set(const std::string& value) const override;
+
+    /**
+     * See ValueAcceptor::accepts()
+     */
+    bool accepts(const std::string& value) const override;
+
+    /**
+     * See BaseArgument::usage()
+     */
+    std::string usage() const override;
+
+    /**
+     * See Argument::ident()
+     */
+    std::string ident() const override;
+
+    /**
+     * See BaseArgument::clone().
+     */
+    std::unique_ptr<BaseArgument> clone() const & override {
+        return std::unique_ptr<BaseArgument>(new PatternArgument(*this));
+    }
+
+    /**
+     * See BaseArgument::clone().
+     */
+    std::unique_ptr<BaseArgument> clone() && override {
+        return std::unique_ptr<BaseArgument>(new PatternArgument(std::move(*this)));
+    }
+
+protected:
+    /**
+     * Set the value of the given argument through try_set(), see
+     * detail::ArgumentOps::setValue.
+     * @param arg Argument to set, must be a PatternArgument
+     * @param value The value to set, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool set_value(const Argument& arg, const std::string& value);
+
+    /**
+     * Check a value for the given argument through accepts(), see
+     * detail::ArgumentOps::checkValue.
+     * @param arg Argument to check the value for, must be a PatternArgument
+     * @param value The value to check, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool check_value(const Argument& arg, const std::string& value);
+};
+
+}
+
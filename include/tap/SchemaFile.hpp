@@ -0,0 +1,483 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file SchemaFile.hpp
+ * @brief Contains the definitions for exported parser schemas.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TAP {
+
+namespace detail {
+
+/** Version of the schema format, see ArgumentParser::export_schema() */
+constexpr std::uint32_t schemaVersion = 1u;
+
+/** Byte order mark of a schema, written in the byte order of the machine */
+constexpr std::uint32_t schemaByteOrder = 0x01020304u;
+
+/** Attribute of a positional argument, see SchemaArgument::attributes */
+constexpr std::uint8_t schemaPositional = 1u;
+/** Attribute of a required argument */
+constexpr std::uint8_t schemaRequired = 2u;
+/** Attribute of an argument completed with file names */
+constexpr std::uint8_t schemaFiles = 4u;
+
+/**
+ * Table of records in a schema.
+ */
+struct SchemaTable {
+    /** Offset in bytes from the start of the schema */
+    std::uint32_t offset;
+    /** Number of records */
+    std::uint32_t count;
+};
+
+/**
+ * Range of records within a table of a schema.
+ */
+struct SchemaRange {
+    /** Index of the first record */
+    std::uint32_t first;
+    /** Number of records */
+    std::uint32_t count;
+};
+
+/**
+ * String in the text of a schema. The text is terminated by a zero byte,
+ * so it can be used as a C string without copying.
+ */
+struct SchemaString {
+    /** Offset of the first character in the text */
+    std::uint32_t offset;
+    /** Number of characters, excluding the zero byte */
+    std::uint32_t length;
+};
+
+/**
+ * Node of the trie of names in a schema. The name of a node is given by the
+ * labels of the edges leading to it from the root (the first node).
+ */
+struct SchemaNode {
+    /** Outgoing edges in the table of edges, sorted by label */
+    SchemaRange edges;
+    /** Schema indices of the arguments with this name, in the table of
+     * matches and in lookup order (see ArgumentParser::findArg()) */
+    SchemaRange matches;
+};
+
+/**
+ * Edge of the trie of names in a schema.
+ */
+struct SchemaEdge {
+    /** Character of the edge, as unsigned char */
+    std::uint32_t label;
+    /** Index of the target node, always larger than that of the source */
+    std::uint32_t child;
+};
+
+/**
+ * Header at the start of a schema. All numbers are stored in the byte order
+ * of the machine writing the schema, all records are aligned to 4 bytes.
+ */
+struct SchemaHeader {
+    /** Identifies the format, "TAPS" */
+    char magic[4];
+    /** See schemaVersion */
+    std::uint32_t version;
+    /** See schemaByteOrder */
+    std::uint32_t byteOrder;
+    /** Size of the schema in bytes */
+    std::uint32_t size;
+    /** Arguments, of type SchemaArgument */
+    SchemaTable arguments;
+    /** Nodes of the trie of names, of type SchemaNode */
+    SchemaTable nodes;
+    /** Edges of the trie of names, of type SchemaEdge */
+    SchemaTable edges;
+    /** Lists of schema indices, of type std::uint32_t */
+    SchemaTable matches;
+    /** Arguments by flag (as unsigned char), 256 ranges in matches */
+    SchemaTable flags;
+    /** Names and choices of the arguments, of type SchemaString */
+    SchemaTable strings;
+    /** Characters of all strings, count is the number of bytes */
+    SchemaTable text;
+    /** Positional arguments, in matches */
+    SchemaRange positional;
+    /** Name of the program, see ArgumentParser::program_name() */
+    SchemaString program;
+    /** Flag marker of the syntax */
+    SchemaString flagStart;
+    /** Name marker of the syntax */
+    SchemaString nameStart;
+    /** Skip marker of the syntax */
+    SchemaString skip;
+    /** Value delimiter of the syntax, as unsigned char */
+    std::uint32_t nameDelim;
+    /** Unused, zero */
+    std::uint32_t reserved;
+};
+
+class ArgumentIndex;
+
+/**
+ * Write the arguments of an index as a schema, see
+ * ArgumentParser::export_schema().
+ * @param index Index of a frozen parser
+ * @param program Name of the program
+ * @param flagStart Flag marker of the syntax
+ * @param nameStart Name marker of the syntax
+ * @param nameDelim Value delimiter of the syntax
+ * @param skip Skip marker of the syntax
+ * @return The schema
+ */
+std::string write_schema(const ArgumentIndex& index, const std::string& program, const char* flagStart, const char* nameStart, char nameDelim, const char* skip);
+
+}
+
+/**
+ * Argument of an exported schema, see SchemaView. The record is read in place
+ * from the schema, strings are looked up with SchemaView::text() and
+ * SchemaView::string().
+ */
+struct SchemaArgument {
+    /** See Argument::description() */
+    detail::SchemaString description;
+    /** Identifier used in help text and messages, see Argument::ident() */
+    detail::SchemaString ident;
+    /** Flags of the argument, as a string */
+    detail::SchemaString flags;
+    /** Names of the argument, in the table of strings */
+    detail::SchemaRange names;
+    /** Values offered by completion (see Argument::choices()), in the table
+     * of strings */
+    detail::SchemaRange choices;
+    /** See Argument::min() */
+    std::uint32_t min;
+    /** See Argument::max(), 0 for no limit */
+    std::uint32_t max;
+    /** See Argument::action(), 0 for no action */
+    std::int32_t action;
+    /** True if the argument takes a value */
+    std::uint8_t takesValue;
+    /** Kind of the values, see ValueKind */
+    std::uint8_t kind;
+    /** Bitwise or of detail::schemaPositional, detail::schemaRequired and
+     * detail::schemaFiles */
+    std::uint8_t attributes;
+    /** Unused, zero */
+    std::uint8_t reserved;
+
+    /**
+     * Returns whether the argument is positional.
+     * @return True iff the argument is positional
+     */
+    bool positional() const {
+        return (attributes & detail::schemaPositional) != 0u;
+    }
+
+    /**
+     * Returns whether the argument is required, see BaseArgument::required().
+     * @return True iff the argument is required
+     */
+    bool required() const {
+        return (attributes & detail::schemaRequired) != 0u;
+    }
+
+    /**
+     * Returns whether completion offers file names, see
+     * Argument::complete_files().
+     * @return True iff file names are offered
+     */
+    bool files() const {
+        return (attributes & detail::schemaFiles) != 0u;
+    }
+};
+
+static_assert(sizeof(detail::SchemaHeader) == 120 && sizeof(SchemaArgument) == 56,
+        "Records of the schema format must not be padded");
+
+/**
+ * Result of SchemaView::validate().
+ */
+struct SchemaResult {
+    /** Error that occurred, ParseError::None on success */
+    ParseError error = ParseError::None;
+    /** Index in argv of the offending token, or argc if the error was found
+     * after all tokens were read. For actions, the index of the action
+     * argument */
+    std::size_t index = 0;
+    /** Offset within the offending token */
+    std::size_t offset = 0;
+    /** Schema index of the argument involved, or npos */
+    std::size_t argument = npos;
+    /** Code of the action argument that stopped validation, see
+     * ActionArgument */
+    int action = 0;
+
+    /** Value of argument if no argument is involved */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Returns whether the command line is valid.
+     * @return True iff error is ParseError::None
+     */
+    explicit operator bool() const {
+        return error == ParseError::None;
+    }
+};
+
+/**
+ * Read-only view of a schema exported by ArgumentParser::export_schema(),
+ * e.g. mapped into memory with MappedFile. The records are used in place, so
+ * opening a schema only checks that all offsets and indices are in bounds.
+ * Arguments are referred to by their schema index. A view can look up
+ * arguments, validate and complete command lines without the program that
+ * exported the schema, following the same rules as the parser. Values are
+ * only checked by their kind (see ValueKind), not by the range of their type
+ * or any check functions. The data must outlive the view.
+ */
+class SchemaView {
+    /** Start of the schema */
+    const char* m_data;
+    /** Header of the schema */
+    const detail::SchemaHeader* m_header;
+    /** See detail::SchemaHeader::arguments */
+    const SchemaArgument* m_arguments;
+    /** See detail::SchemaHeader::nodes */
+    const detail::SchemaNode* m_nodes;
+    /** See detail::SchemaHeader::edges */
+    const detail::SchemaEdge* m_edges;
+    /** See detail::SchemaHeader::matches */
+    const std::uint32_t* m_matches;
+    /** See detail::SchemaHeader::flags */
+    const detail::SchemaRange* m_flags;
+    /** See detail::SchemaHeader::strings */
+    const detail::SchemaString* m_strings;
+    /** See detail::SchemaHeader::text */
+    const char* m_text;
+
+    class CheckHandler;
+    class CompleteHandler;
+
+public:
+    /** Value returned by find() if there is no argument */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Open a schema. Throws a std::runtime_error if the data is not a valid
+     * schema of this version and byte order.
+     * @param data Start of the schema, aligned to 4 bytes
+     * @param size Size of the data in bytes
+     */
+    SchemaView(const void* data, std::size_t size);
+
+    /**
+     * Returns the number of arguments.
+     * @return Number of arguments
+     */
+    std::size_t size() const {
+        return m_header->arguments.count;
+    }
+
+    /**
+     * Returns an argument.
+     * @param index Schema index of the argument, less than size()
+     * @return The argument
+     */
+    const SchemaArgument& argument(std::size_t index) const {
+        return m_arguments[index];
+    }
+
+    /**
+     * Returns a string of the schema.
+     * @param str The string
+     * @return Zero terminated characters of the string
+     */
+    const char* text(const detail::SchemaString& str) const {
+        return m_text + str.offset;
+    }
+
+    /**
+     * Returns a string of a list, e.g. SchemaArgument::names.
+     * @param list The list
+     * @param index Index in the list, less than list.count
+     * @return Zero terminated characters of the string
+     */
+    const char* string(const detail::SchemaRange& list, std::size_t index) const {
+        return text(m_strings[list.first + index]);
+    }
+
+    /**
+     * Returns the name of the program that exported the schema.
+     * @return Name of the program
+     */
+    const char* program() const {
+        return text(m_header->program);
+    }
+
+    /**
+     * Find an argument by flag. If several arguments have the flag, returns
+     * the first in lookup order.
+     * @param flag Flag to find
+     * @return Schema index of the argument, or npos
+     */
+    std::size_t find(char flag) const;
+
+    /**
+     * Find an argument by name, see find(char).
+     * @param name Name to find
+     * @return Schema index of the argument, or npos
+     */
+    std::size_t find(const std::string& name) const;
+
+    /**
+     * Find the names starting with the given prefix.
+     * @param prefix Prefix of the names
+     * @param names Vector to append the names to, in lexicographic order
+     */
+    void complete(const std::string& prefix, std::vector<std::string>& names) const;
+
+    /**
+     * Check a command line, like ArgumentParser::validate(): unknown
+     * arguments, missing or unexpected values, values not of the kind of
+     * their argument, occurrence counts and required arguments, unless an
+     * action argument stops validation. Constraints are not part of a
+     * schema. Throws a std::logic_error if the schema was
+     * exported with a different syntax.
+     * Template parameter Syntax indicates the syntax policy, see DefaultSyntax.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments, including the program name
+     * @return The first error found, or a successful result
+     */
+    template<typename Syntax = DefaultSyntax>
+    SchemaResult validate(int argc, const char* const argv[]) const;
+
+    /**
+     * Find the candidates for a word of a command line, like
+     * ArgumentParser::completions(). Throws a std::logic_error if the schema
+     * was exported with a different syntax.
+     * Template parameter Syntax indicates the syntax policy, see DefaultSyntax.
+     * @param words Words of the command line, including the program name
+     * @param count Number of words
+     * @param index Index of the word to complete, in [1, count]
+     * @return The candidates
+     */
+    template<typename Syntax = DefaultSyntax>
+    std::vector<std::string> completions(const char* const words[], std::size_t count, std::size_t index) const;
+
+private:
+    /**
+     * Returns a table of the schema, throwing a std::runtime_error if it is
+     * out of bounds.
+     * @param table Location of the table
+     * @param size Size of the schema
+     * @return First record of the table
+     */
+    template<typename T>
+    const T* table(const detail::SchemaTable& table, std::size_t size) const;
+
+    /**
+     * Throws a std::logic_error if the schema was exported with a syntax
+     * other than Syntax.
+     */
+    template<typename Syntax>
+    void check_syntax() const;
+
+    /**
+     * Returns the node of the trie with the given name.
+     * @param name Name of the node
+     * @return Index of the node, or npos
+     */
+    std::size_t node(const std::string& name) const;
+
+    /**
+     * Select an argument from a list, see ArgumentIndex::find().
+     * @param list Arguments in the table of matches
+     * @param counts Occurrences by schema index, nullptr to select the first
+     * @return Schema index of the argument, or npos if the list is empty
+     */
+    std::size_t select(const detail::SchemaRange& list, const std::vector<unsigned int>* counts) const;
+
+    /**
+     * Call f(name, matches) for the nodes below a node with arguments, in
+     * lexicographic order. Walks the trie with a stack on the heap, as its
+     * depth is not bounded.
+     * @param node Index of the node to start at
+     * @param name Name of the node, restored before returning
+     * @param f Function to call
+     */
+    template<typename F>
+    void visit(std::size_t node, std::string& name, F&& f) const;
+};
+
+/**
+ * Read-only contents of a file, e.g. for SchemaView. The file is mapped into
+ * memory if TAP_POSIX is defined, otherwise it is read into a buffer.
+ */
+class MappedFile {
+    /** Start of the contents */
+    const char* m_data = nullptr;
+    /** Size of the contents */
+    std::size_t m_size = 0;
+#ifndef TAP_POSIX
+    /** Contents of the file */
+    std::string m_buffer;
+#endif
+
+public:
+    /**
+     * Open a file, throws a std::runtime_error on failure.
+     * @param path Path of the file
+     */
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Release the contents.
+     */
+    ~MappedFile();
+
+    /**
+     * Returns the contents.
+     * @return Start of the contents, aligned to the page size if mapped
+     */
+    const char* data() const {
+        return m_data;
+    }
+
+    /**
+     * Returns the size of the contents.
+     * @return Size in bytes
+     */
+    std::size_t size() const {
+        return m_size;
+    }
+};
+
+}
@@ -0,0 +1,145 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file SmallFunction.hpp
+ * @brief Contains the definitions for SmallFunction.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace TAP {
+
+namespace detail {
+
+template<typename Signature, std::size_t Size = 4 * sizeof(void*)>
+class SmallFunction;
+
+/**
+ * Callable wrapper similar to std::function, but storing the callable in an
+ * inline buffer of Size bytes. It never allocates, so copying an argument with
+ * a callback is as cheap as copying the buffer. Callables that do not fit are
+ * rejected at compile time; capture large state by reference or pointer
+ * instead.
+ * Template parameter R is the return type, Args the parameter types.
+ */
+template<typename R, typename ... Args, std::size_t Size>
+class SmallFunction<R(Args...), Size> {
+    /** Table of operations on the stored callable */
+    struct Ops {
+        /** Invoke the callable stored at obj */
+        R (*invoke)(void* obj, Args... args);
+        /** Copy construct the callable at src into dst */
+        void (*copy)(void* dst, const void* src);
+        /** Destroy the callable stored at obj */
+        void (*destroy)(void* obj);
+    };
+
+    /**
+     * Returns the operations for callables of type F.
+     * @return Reference to a static table for F
+     */
+    template<typename F>
+    static const Ops& ops_for();
+
+    /** Storage of the callable */
+    mutable typename std::aligned_storage<Size, alignof(std::max_align_t)>::type m_buffer;
+
+    /** Operations on the stored callable, nullptr if empty */
+    const Ops* m_ops = nullptr;
+
+public:
+    /**
+     * Create an empty function.
+     */
+    SmallFunction() noexcept = default;
+
+    /**
+     * Create an empty function.
+     */
+    SmallFunction(std::nullptr_t) noexcept {
+    }
+
+    /**
+     * Create a function storing the given callable. The callable has to fit
+     * the inline buffer.
+     * @param func Callable to store
+     */
+    template<typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, SmallFunction>::value &&
+        !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value>::type>
+    SmallFunction(F&& func);
+
+    /**
+     * Copy the callable of the given function.
+     * @param other Function to copy
+     */
+    SmallFunction(const SmallFunction& other);
+
+    /**
+     * Replace the callable by a copy of that of the given function.
+     * @param other Function to copy
+     * @return Reference to this function
+     */
+    SmallFunction& operator=(const SmallFunction& other);
+
+    /**
+     * Destroy the stored callable, if any.
+     */
+    ~SmallFunction();
+
+    /**
+     * Invoke the stored callable. Behavior is undefined if empty.
+     * @param args Arguments to pass
+     * @return Result of the callable
+     */
+    R operator()(Args... args) const {
+        return m_ops->invoke(&m_buffer, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Returns whether a callable is stored.
+     * @return True iff not empty
+     */
+    explicit operator bool() const noexcept {
+        return m_ops != nullptr;
+    }
+
+    /**
+     * Compare with nullptr, true iff empty.
+     */
+    friend bool operator==(const SmallFunction& func, std::nullptr_t) noexcept {
+        return func.m_ops == nullptr;
+    }
+
+    /**
+     * Compare with nullptr, true iff not empty.
+     */
+    friend bool operator!=(const SmallFunction& func, std::nullptr_t) noexcept {
+        return func.m_ops != nullptr;
+    }
+};
+
+}
+
+}
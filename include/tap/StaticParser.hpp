@@ -0,0 +1,694 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file StaticParser.hpp
+ * @brief Contains the definitions for parsers with a compile-time schema.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace TAP {
+
+namespace embedded {
+
+/**
+ * Descriptor of an argument of a compile-time schema (see Schema), created by
+ * option() or positional(). All members are fixed at compile time.
+ * Template parameter T indicates the type of the value: bool for switches,
+ * an arithmetic type, or const char* to refer to the string in argv.
+ */
+template<typename T>
+struct Option {
+    /** Flag of the argument, '\0' if none */
+    char flag;
+    /** Name of the argument, nullptr if none */
+    const char* name;
+    /** Name of the value of positional arguments, used in help text */
+    const char* valueName;
+    /** Description of the argument, used in help text */
+    const char* description;
+    /** Minimum number of occurrences, the argument is required if not 0 */
+    unsigned int minCount;
+    /** Maximum number of occurrences, 0 means no limit */
+    unsigned int maxCount;
+    /** Default value */
+    T value;
+
+    /**
+     * Returns a copy of this descriptor that has to be set.
+     * @param required True if the argument is required
+     * @return The modified descriptor
+     */
+    constexpr Option set_required(bool required = true) const {
+        return Option{flag, name, valueName, description, required ? 1u : 0u, maxCount, value};
+    }
+
+    /**
+     * Returns a copy of this descriptor with the given maximum number of
+     * occurrences.
+     * @param max Maximum number of occurrences, 0 for no limit
+     * @return The modified descriptor
+     */
+    constexpr Option max(unsigned int max) const {
+        return Option{flag, name, valueName, description, minCount, max, value};
+    }
+};
+
+/**
+ * Create a descriptor of an argument with a flag and/or name.
+ * @param flag Flag of the argument, '\0' if none
+ * @param name Name of the argument, nullptr if none
+ * @param description Description of the argument (used in help text)
+ * @param value Default value
+ * @return The descriptor
+ */
+template<typename T>
+constexpr Option<T> option(char flag, const char* name, const char* description, T value = T()) {
+    return Option<T>{flag, name, nullptr, description, 0u, 1u, value};
+}
+
+/**
+ * Create a descriptor of a positional argument.
+ * @param valueName Name of the value (used in help text)
+ * @param description Description of the argument (used in help text)
+ * @param value Default value
+ * @return The descriptor
+ */
+template<typename T>
+constexpr Option<T> positional(const char* valueName, const char* description, T value = T()) {
+    return Option<T>{'\0', nullptr, valueName, description, 0u, 1u, value};
+}
+
+/**
+ * Result of StaticParser::parse().
+ */
+struct StaticParseResult {
+    /** Error that occurred, Error::None on success */
+    Error error;
+    /** Index in argv of the offending token, or argc if the error was found
+     * after all tokens were read */
+    int index;
+    /** Index in the schema of the argument involved, or npos */
+    std::size_t option;
+
+    /** Value of option if no argument is involved */
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Returns whether parsing succeeded.
+     * @return True iff error is Error::None
+     */
+    explicit operator bool() const {
+        return error == Error::None;
+    }
+};
+
+namespace detail {
+
+/**
+ * Descriptor of an argument without its type, see Option.
+ */
+struct OptionInfo {
+    /** See Option::flag */
+    char flag;
+    /** See Option::name */
+    const char* name;
+    /** See Option::valueName */
+    const char* valueName;
+    /** See Option::description */
+    const char* description;
+    /** See Option::minCount */
+    unsigned int minCount;
+    /** See Option::maxCount */
+    unsigned int maxCount;
+    /** True if the argument takes a value, i.e. is not a bool */
+    bool takesValue;
+};
+
+/**
+ * Returns the descriptor of opt without its type.
+ * @param opt Typed descriptor
+ * @return Untyped descriptor
+ */
+template<typename T>
+constexpr OptionInfo option_info(const Option<T>& opt) {
+    return OptionInfo{opt.flag, opt.name, opt.valueName, opt.description,
+        opt.minCount, opt.maxCount, !std::is_same<T, bool>::value};
+}
+
+/**
+ * Returns the bit mask of the given schema indices.
+ * @return Mask with the bits of keys set
+ */
+constexpr std::uint64_t key_mask() {
+    return 0u;
+}
+
+/** See key_mask() */
+template<typename K, typename ... R>
+constexpr std::uint64_t key_mask(K key, R ... rest) {
+    return (std::uint64_t(1) << static_cast<std::size_t>(key)) | key_mask(rest...);
+}
+
+/**
+ * Hash of a name for the perfect hash table of a StaticParser (FNV-1a).
+ * @param name Characters of the name
+ * @param length Number of characters
+ * @param seed Seed selecting the hash function
+ * @return Hash of the name
+ */
+constexpr std::uint32_t name_hash(const char* name, std::size_t length, std::uint32_t seed) {
+    std::uint32_t hash = 2166136261u ^ seed;
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Returns the size of the name table for N arguments: a power of two large
+ * enough that a perfect hash is found after a few seeds.
+ * @param N Number of arguments
+ * @return Number of slots
+ */
+constexpr std::size_t name_table_size(std::size_t N) {
+    std::size_t size = 8;
+    while (size < 8 * N) {
+        size *= 2;
+    }
+    return size;
+}
+
+}
+
+/**
+ * Compile-time schema of a StaticParser: the descriptors of all arguments and
+ * the groups of arguments that exclude each other. Usually created by
+ * make_schema().
+ * Template parameter T indicates the value types of the arguments, see
+ * Option.
+ */
+template<typename ... T>
+class Schema {
+    static_assert(sizeof...(T) > 0, "A schema needs at least one argument");
+    static_assert(sizeof...(T) <= 64, "A schema supports at most 64 arguments");
+
+public:
+    /** Number of arguments */
+    static constexpr std::size_t size = sizeof...(T);
+    /** Maximum number of groups of exclusive arguments, see exclude() */
+    static constexpr std::size_t maxExclusions = 8;
+    /** Values of the arguments */
+    using Values = std::tuple<T...>;
+
+    /** Descriptors of the arguments, by schema index */
+    detail::OptionInfo options[sizeof...(T)];
+    /** Default values of the arguments */
+    Values defaults;
+    /** Masks of schema indices of which at most one may be set */
+    std::uint64_t exclusions[maxExclusions];
+    /** Number of masks used in exclusions */
+    std::size_t exclusionCount;
+
+    /**
+     * Create a schema of the given arguments. Their position is their index,
+     * used to access their values (see StaticParser::get()).
+     * @param opts Descriptors of the arguments
+     */
+    constexpr Schema(const Option<T>& ... opts) :
+        options{ detail::option_info(opts)... }, defaults(opts.value...),
+        exclusions{}, exclusionCount(0) {
+    }
+
+    /**
+     * Returns a copy of this schema in which at most one of the given
+     * arguments may be set.
+     * @param keys Schema indices of the arguments
+     * @return The modified schema
+     */
+    template<typename ... K>
+    constexpr Schema exclude(K ... keys) const {
+        Schema result = *this;
+        if (result.exclusionCount < maxExclusions) {
+            result.exclusions[result.exclusionCount] = detail::key_mask(keys...);
+        }
+        // Overflow is reported when compiling the parser
+        ++result.exclusionCount;
+        return result;
+    }
+};
+
+/**
+ * Create a schema of the given arguments, see Schema.
+ * @param opts Descriptors of the arguments
+ * @return The schema
+ */
+template<typename ... T>
+constexpr Schema<T...> make_schema(const Option<T>& ... opts) {
+    return Schema<T...>(opts...);
+}
+
+namespace detail {
+
+/**
+ * Lookup tables of a StaticParser, computed from its schema at compile time
+ * (see compile_schema()).
+ * Template parameter N indicates the number of arguments.
+ */
+template<std::size_t N>
+struct SchemaTables {
+    /** Number of slots in names */
+    static constexpr std::size_t nameSlots = name_table_size(N);
+
+    /** Schema index + 1 by flag, 0 if no argument has the flag */
+    unsigned char flags[128];
+    /** Schema index + 1 by hash of the name (see name_hash()), 0 if empty */
+    unsigned char names[nameSlots];
+    /** Seed of the perfect hash of the names */
+    std::uint32_t seed;
+    /** Schema indices of the positional arguments, in order */
+    unsigned char positional[N];
+    /** Number of positional arguments */
+    std::size_t positionalCount;
+    /** Mask of the required arguments */
+    std::uint64_t required;
+
+    /** False if two arguments share a flag */
+    bool uniqueFlags;
+    /** False if two arguments share a name */
+    bool uniqueNames;
+    /** False if a flag is not an ASCII character */
+    bool asciiFlags;
+    /** False if a positional argument does not take a value */
+    bool positionalValues;
+    /** False if no perfect hash of the names was found */
+    bool hashed;
+    /** False if the schema has too many exclusions */
+    bool exclusionsFit;
+};
+
+/**
+ * Compute the lookup tables of a schema: a table of flags, a perfect hash of
+ * the names and masks of the required arguments.
+ * @param schema Schema to compile
+ * @return Tables of the schema
+ */
+template<typename S>
+constexpr SchemaTables<S::size> compile_schema(const S& schema) {
+    SchemaTables<S::size> tables{};
+    tables.uniqueFlags = true;
+    tables.uniqueNames = true;
+    tables.asciiFlags = true;
+    tables.positionalValues = true;
+    tables.exclusionsFit = schema.exclusionCount <= S::maxExclusions;
+
+    bool named = false;
+    for (std::size_t i = 0; i < S::size; ++i) {
+        const OptionInfo& info = schema.options[i];
+        if (info.flag != '\0') {
+            unsigned char flag = static_cast<unsigned char>(info.flag);
+            if (flag >= 128u) {
+                tables.asciiFlags = false;
+            } else {
+                tables.uniqueFlags = tables.uniqueFlags && tables.flags[flag] == 0u;
+                tables.flags[flag] = static_cast<unsigned char>(i + 1);
+            }
+        }
+        if (info.name != nullptr) {
+            named = true;
+            for (std::size_t j = 0; j < i; ++j) {
+                if (schema.options[j].name != nullptr && TAP::detail::static_equal(info.name, schema.options[j].name)) {
+                    tables.uniqueNames = false;
+                }
+            }
+        }
+        if (info.flag == '\0' && info.name == nullptr) {
+            tables.positionalValues = tables.positionalValues && info.takesValue;
+            tables.positional[tables.positionalCount++] = static_cast<unsigned char>(i);
+        }
+        if (info.minCount > 0u) {
+            tables.required |= std::uint64_t(1) << i;
+        }
+    }
+
+    // Find a seed without collisions
+    tables.hashed = !named;
+    for (std::uint32_t seed = 0; named && tables.uniqueNames && !tables.hashed && seed < 4096u; ++seed) {
+        for (std::size_t slot = 0; slot < tables.nameSlots; ++slot) {
+            tables.names[slot] = 0u;
+        }
+        tables.hashed = true;
+        for (std::size_t i = 0; i < S::size && tables.hashed; ++i) {
+            const char* name = schema.options[i].name;
+            if (name == nullptr) {
+                continue;
+            }
+            std::size_t slot = name_hash(name, TAP::detail::static_length(name), seed) & (tables.nameSlots - 1u);
+            tables.hashed = (tables.names[slot] == 0u);
+            tables.names[slot] = static_cast<unsigned char>(i + 1);
+        }
+        tables.seed = seed;
+    }
+    return tables;
+}
+
+/**
+ * String of a fixed size, built at compile time.
+ * Template parameter L indicates the size, including the terminating null
+ * character.
+ */
+template<std::size_t L>
+struct StaticString {
+    /** Characters of the string */
+    char data[L];
+};
+
+/**
+ * Returns the length of the first column of the help text for an argument,
+ * see TAP::Argument::ident().
+ * @param info Descriptor of the argument
+ * @return Length of the identification of the argument
+ */
+constexpr std::size_t ident_length(const OptionInfo& info) {
+    if (info.flag == '\0' && info.name == nullptr) {
+        return TAP::detail::static_length(info.valueName);
+    }
+    std::size_t length = 0;
+    if (info.flag != '\0') {
+        length += TAP::detail::static_length(flagStart) + 1;
+    }
+    if (info.name != nullptr) {
+        length += (info.flag != '\0' ? 2 : 0) + TAP::detail::static_length(nameStart) + TAP::detail::static_length(info.name);
+    }
+    return length;
+}
+
+/**
+ * Returns the width of the first column of the help text, see
+ * TAP::ArgumentParser::help().
+ * @param schema Schema to describe
+ * @return Width of the first column
+ */
+template<typename S>
+constexpr std::size_t help_width(const S& schema) {
+    std::size_t width = 0;
+    for (std::size_t i = 0; i < S::size; ++i) {
+        std::size_t length = ident_length(schema.options[i]);
+        width = (length > width ? length : width);
+    }
+    return width + 2;
+}
+
+/**
+ * Returns the length of the help text of a schema, see build_help().
+ * @param schema Schema to describe
+ * @return Length of the help text, without terminating null character
+ */
+template<typename S>
+constexpr std::size_t help_length(const S& schema) {
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < S::size; ++i) {
+        length += 2 + help_width(schema) + TAP::detail::static_length(schema.options[i].description) + 1;
+    }
+    return length;
+}
+
+/**
+ * Append a string to a StaticString under construction.
+ * @param help String to append to
+ * @param pos Position to append at, advanced past the string
+ * @param str String to append, may be nullptr
+ */
+template<std::size_t L>
+constexpr void static_append(StaticString<L>& help, std::size_t& pos, const char* str) {
+    for (std::size_t i = 0; str != nullptr && str[i] != '\0'; ++i) {
+        help.data[pos++] = str[i];
+    }
+}
+
+/**
+ * Build the help text of a schema at compile time: a line per argument with
+ * its flag and name (or value name if positional), followed by its
+ * description, formatted like TAP::ArgumentParser::help().
+ * Template parameter L indicates the size of the text, see help_length().
+ * @param schema Schema to describe
+ * @return The help text
+ */
+template<std::size_t L, typename S>
+constexpr StaticString<L> build_help(const S& schema) {
+    StaticString<L> help{};
+    const std::size_t width = help_width(schema);
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < S::size; ++i) {
+        const OptionInfo& info = schema.options[i];
+        static_append(help, pos, "  ");
+        std::size_t start = pos;
+        if (info.flag == '\0' && info.name == nullptr) {
+            static_append(help, pos, info.valueName);
+        }
+        if (info.flag != '\0') {
+            static_append(help, pos, flagStart);
+            help.data[pos++] = info.flag;
+        }
+        if (info.name != nullptr) {
+            if (info.flag != '\0') {
+                static_append(help, pos, ", ");
+            }
+            static_append(help, pos, nameStart);
+            static_append(help, pos, info.name);
+        }
+        while (pos < start + width) {
+            help.data[pos++] = ' ';
+        }
+        static_append(help, pos, info.description);
+        help.data[pos++] = '\n';
+    }
+    help.data[pos] = '\0';
+    return help;
+}
+
+/**
+ * Table of the functions setting each argument of a StaticParser, indexed by
+ * schema index.
+ * Template parameter P indicates the StaticParser.
+ * Template parameter I indicates the sequence of schema indices.
+ */
+template<typename P, typename I>
+struct SetTable;
+
+/**
+ * Store a value of a StaticParser, see convert(const char*, T&).
+ * @param value String to convert
+ * @param storage Variable to write the value to, untouched on failure
+ * @return True iff the conversion succeeded
+ */
+template<typename T>
+bool store(const char* value, T& storage) {
+    return convert(value, storage);
+}
+
+/** Set a switch, ignoring the value. See store(const char*, T&) */
+inline bool store(const char*, bool& storage) {
+    storage = true;
+    return true;
+}
+
+}
+
+/**
+ * Parser with a schema fixed at compile time. Lookup tables of flags and names
+ * (a perfect hash), masks of required and exclusive arguments and the help
+ * text are all computed by the compiler, so nothing is constructed at runtime
+ * and parsing needs no virtual calls. Values are stored in the parser and
+ * accessed by their index in the schema (see get()). Parsing follows the
+ * rules of the embedded ArgumentParser, and reports errors as a
+ * StaticParseResult.
+ *
+ * Template parameter Def indicates a class with a static constexpr function
+ * schema() returning the Schema, usually alongside an enum of the indices:
+ * @code
+ * struct Options {
+ *     enum Key { Verbose, Jobs, Input };
+ *     static constexpr auto schema() {
+ *         return TAP::embedded::make_schema(
+ *             TAP::embedded::option<bool>('v', "verbose", "Print more"),
+ *             TAP::embedded::option<int>('j', "jobs", "Number of jobs", 1),
+ *             TAP::embedded::positional<const char*>("input", "Input file").set_required());
+ *     }
+ * };
+ * TAP::embedded::StaticParser<Options> parser;
+ * if (parser.parse(argc, argv)) {
+ *     int jobs = parser.get<Options::Jobs>();
+ * }
+ * @endcode
+ */
+template<typename Def>
+class StaticParser {
+public:
+    /** Type of the schema */
+    using SchemaType = decltype(Def::schema());
+    /** Number of arguments */
+    static constexpr std::size_t size = SchemaType::size;
+
+    /** The schema */
+    static constexpr SchemaType schema = Def::schema();
+    /** Lookup tables of the schema */
+    static constexpr detail::SchemaTables<size> tables = detail::compile_schema(schema);
+
+    static_assert(tables.uniqueFlags, "Arguments of a schema need distinct flags");
+    static_assert(tables.uniqueNames, "Arguments of a schema need distinct names");
+    static_assert(tables.asciiFlags, "Flags of a schema need to be ASCII characters");
+    static_assert(tables.positionalValues, "Positional arguments need to take a value");
+    static_assert(tables.hashed, "No perfect hash found for the names of the schema");
+    static_assert(tables.exclusionsFit, "Too many exclusions in the schema");
+
+    /** Help text of the schema */
+    static constexpr detail::StaticString<detail::help_length(schema) + 1> helpText =
+            detail::build_help<detail::help_length(schema) + 1>(schema);
+
+private:
+    /** Values of the arguments */
+    typename SchemaType::Values m_values;
+    /** Number of occurrences by schema index */
+    unsigned int m_counts[size];
+    /** Mask of the arguments that are set */
+    std::uint64_t m_set;
+
+    /** Function to set the argument with a given schema index */
+    using SetFunc = Error (*)(StaticParser& parser, const char* value);
+
+    template<typename P, typename I>
+    friend struct detail::SetTable;
+
+    /**
+     * Set the argument with schema index I.
+     * @param parser Parser to set the argument of
+     * @param value Value to set, ignored for switches
+     * @return Error::None on success, otherwise the reason of failure
+     */
+    template<std::size_t I>
+    static Error set_value(StaticParser& parser, const char* value);
+
+    /**
+     * Find the positional argument to set: the first one that can be set, or
+     * the last one.
+     * @return Schema index, or StaticParseResult::npos if there is none
+     */
+    std::size_t find_positional() const;
+
+    /**
+     * Find an argument by name.
+     * @param name Characters of the name
+     * @param length Number of characters
+     * @return Schema index, or StaticParseResult::npos if there is none
+     */
+    static std::size_t find_name(const char* name, std::size_t length);
+
+    /**
+     * Find an argument by flag.
+     * @param flag Flag to find
+     * @return Schema index, or StaticParseResult::npos if there is none
+     */
+    static std::size_t find_flag(char flag);
+
+    /**
+     * Set the argument with the given schema index.
+     * @param index Schema index of the argument
+     * @param value Value to set, ignored for switches
+     * @return Error::None on success, otherwise the reason of failure
+     */
+    Error set(std::size_t index, const char* value);
+
+    class SetHandler;
+
+public:
+    /**
+     * Create a parser, with all values at their default.
+     */
+    StaticParser() : m_values(schema.defaults), m_counts(), m_set(0) {
+    }
+
+    /**
+     * Reset all values to their default and all counts to zero, so the
+     * parser can be used again.
+     */
+    void reset() {
+        m_values = schema.defaults;
+        for (unsigned int& count: m_counts) {
+            count = 0;
+        }
+        m_set = 0;
+    }
+
+    /**
+     * Parse the given program arguments, see embedded::ArgumentParser::parse().
+     * Values are stored as found, so on failure the arguments before the
+     * offending token are set. Afterwards, required arguments and exclusions
+     * (see Schema::exclude()) are checked.
+     * @param argc Number of items in the argv array
+     * @param argv Program arguments, including the program name
+     * @return Result of parsing
+     */
+    StaticParseResult parse(int argc, const char* const argv[]);
+
+    /**
+     * Returns the value of the argument with schema index K.
+     * @return The value
+     */
+    template<std::size_t K>
+    const typename std::tuple_element<K, typename SchemaType::Values>::type& get() const {
+        return std::get<K>(m_values);
+    }
+
+    /**
+     * Returns the number of times the argument with schema index K was set.
+     * @return The number of occurrences
+     */
+    template<std::size_t K>
+    unsigned int count() const {
+        static_assert(K < size, "Schema index out of range");
+        return m_counts[K];
+    }
+
+    /**
+     * Returns whether the argument with schema index K was set.
+     * @return True iff set at least once
+     */
+    template<std::size_t K>
+    bool is_set() const {
+        return count<K>() > 0;
+    }
+
+    /**
+     * Returns the help text, built at compile time: a line per argument.
+     * @return The help text
+     */
+    static constexpr const char* help() {
+        return helpText.data;
+    }
+};
+
+}
+
+}
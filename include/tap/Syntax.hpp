@@ -0,0 +1,165 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/**
+ * @file Syntax.hpp
+ * @brief Contains the definitions for the syntax policies of the parser.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Returns the length of a string, usable at compile time.
+ * @param str String to measure, may be nullptr
+ * @return Length of str, 0 for nullptr
+ */
+constexpr std::size_t static_length(const char* str) {
+    std::size_t length = 0;
+    while (str != nullptr && str[length] != '\0') {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * Returns whether two strings are equal, usable at compile time.
+ * @param a First string
+ * @param b Second string
+ * @return True iff the strings are equal
+ */
+constexpr bool static_equal(const char* a, const char* b) {
+    std::size_t i = 0;
+    while (a[i] != '\0' && a[i] == b[i]) {
+        ++i;
+    }
+    return a[i] == b[i];
+}
+
+/**
+ * Find the delimiter between a name and its attached value.
+ * @param name Name, possibly followed by the delimiter and a value
+ * @param delim The delimiter, '\0' if values cannot be attached (see
+ *        TAP::nameDelim)
+ * @return Position of the delimiter in name, or nullptr if there is none
+ */
+inline const char* find_delim(const char* name, char delim) {
+    // strchr() would find the terminator for '\0'
+    return delim == '\0' ? nullptr : std::strchr(name, delim);
+}
+
+}
+
+/**
+ * Syntax policy of the command line, the template parameter of
+ * BasicArgumentParser. A policy is a class with static constexpr functions
+ * returning the markers, so the parser can compute their lengths at compile
+ * time. Any class with the same functions can be used as a policy, allowing
+ * parsers with different syntaxes in a single program:
+ * @code
+ * struct SlashSyntax {
+ *     static constexpr const char* flagStart() { return "+"; }
+ *     static constexpr const char* nameStart() { return "/"; }
+ *     static constexpr char nameDelim() { return ':'; }
+ *     static constexpr const char* skip() { return "//"; }
+ * };
+ * TAP::BasicArgumentParser<SlashSyntax> parser;
+ * @endcode
+ * This policy uses the markers configured in Tap.h (see TAP_FLAG, TAP_NAME,
+ * TAP_NAMEDELIMITER and TAP_SKIP).
+ */
+struct DefaultSyntax {
+    /** Marker for flags, see TAP::flagStart */
+    static constexpr const char* flagStart() {
+        return TAP::flagStart;
+    }
+
+    /** Marker for names, see TAP::nameStart */
+    static constexpr const char* nameStart() {
+        return TAP::nameStart;
+    }
+
+    /** Delimiter between name and value, see TAP::nameDelim */
+    static constexpr char nameDelim() {
+        return TAP::nameDelim;
+    }
+
+    /** Marker after which all tokens are positional, see TAP::skip */
+    static constexpr const char* skip() {
+        return TAP::skip;
+    }
+};
+
+namespace detail {
+
+/**
+ * Markers of a syntax policy with their lengths, computed at compile time.
+ * Template parameter Syntax indicates the policy, see DefaultSyntax.
+ */
+template<typename Syntax>
+struct SyntaxTraits {
+    /** Length of Syntax::flagStart() */
+    static constexpr std::size_t flagStartLength = static_length(Syntax::flagStart());
+    /** Length of Syntax::nameStart() */
+    static constexpr std::size_t nameStartLength = static_length(Syntax::nameStart());
+
+    static_assert(flagStartLength > 0, "The flag marker of a syntax cannot be empty");
+    static_assert(nameStartLength > 0, "The name marker of a syntax cannot be empty");
+    static_assert(!static_equal(Syntax::flagStart(), Syntax::nameStart()),
+            "The flag and name markers of a syntax have to differ");
+
+    /**
+     * Returns whether a token starts with the given marker and has more
+     * characters after it.
+     * @param token Token to classify
+     * @param length Length of the token
+     * @param marker Marker to look for
+     * @param markerLength Length of the marker
+     * @return True iff the token consists of the marker and more
+     */
+    static bool starts(const char* token, std::size_t length, const char* marker, std::size_t markerLength) {
+        return length > markerLength && std::memcmp(token, marker, markerLength) == 0;
+    }
+
+    /** Returns whether a token is a named argument, see starts() */
+    static bool is_name(const char* token, std::size_t length) {
+        return starts(token, length, Syntax::nameStart(), nameStartLength);
+    }
+
+    /** Returns whether a token holds flag arguments, see starts() */
+    static bool is_flag(const char* token, std::size_t length) {
+        return starts(token, length, Syntax::flagStart(), flagStartLength);
+    }
+};
+
+template<typename Syntax>
+constexpr std::size_t SyntaxTraits<Syntax>::flagStartLength;
+
+template<typename Syntax>
+constexpr std::size_t SyntaxTraits<Syntax>::nameStartLength;
+
+}
+
+}
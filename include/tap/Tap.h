@@ -102,6 +102,12 @@ int main(int argc, const char* argv[]) {
  * flags or names to use in the description (see
  * TAP::Argument::parse_description()). You can use this to save on typing when
  * defining arguments.
+ * The markers can also be parsed by the compiler with TAP::markup(), which
+ * can be passed in place of any description, even without TAP_AUTOFLAG:
+ * @code
+ * static constexpr auto helpText = TAP::markup("Show this &help text");
+ * TAP::Argument help(helpText);
+ * @endcode
  *
  * Multiple argument classes exist that can be used, in short they are
  * * Argument: Simple argument class that can only be marked as set. They always
@@ -146,6 +152,21 @@ int main(int argc, const char* argv[]) {
  *   // note: this is a terrible way to interact
  *   TAP::SwitchArgument restart("Do not &restart on error", true);
  *   @endcode
+ * * PatternArgument: Matches a family of names, consisting of a prefix, a
+ *   typed key and an optional suffix. The value of each key is stored in a
+ *   map. Names are only matched against patterns if no argument has the
+ *   exact name.
+ *   @code
+ *   // Matches --shard-0-weight, --shard-1-weight, ...
+ *   TAP::PatternArgument<unsigned int, double> weights("Shard weight", "shard-", "-weight");
+ *   ...
+ *   for (const auto& weight: weights.values()) { ... }
+ *   @endcode
+ * * ActionArgument: Like Argument, but stops parsing when it occurs, see
+ *   @ref sec_argaction.
+ *   @code
+ *   TAP::ActionArgument help("Show this &help text", 1);
+ *   @endcode
  *
  *
  * @subsection sec_argreq Required arguments and argument counts
@@ -182,11 +203,11 @@ int main(int argc, const char* argv[]) {
  * @subsection sec_argcheck Argument callbacks
  * It is possible to assign a callback to an TAP::Argument that is called
  * whenever the argument is set. For example: @code
- * TAP::Argument help("Show this &help text");
- * TAP::ArgumentParser parser(help);
- * help.check([&parser](const TAP::Argument&) -> void {
- *     std::cout << parser.help() << std::endl; exit(1);
+ * TAP::Argument verbose("Be &verbose");
+ * verbose.many().check([](const TAP::Argument& arg) -> void {
+ *     std::clog << "Verbosity " << arg.count() << std::endl;
  * });
+ * TAP::ArgumentParser parser(verbose);
  * @endcode
  * For details see TAP::Argument::check() and TAP::ArgumentCheckFunc.
  *
@@ -202,6 +223,31 @@ int main(int argc, const char* argv[]) {
  * @endcode
  * For details see TAP::TypedArgument::check() and TAP::TypedArgumentCheckFunc.
  *
+ * Callbacks are stored inside the argument without allocating, in a buffer the
+ * size of four pointers (see TAP::detail::SmallFunction). Lambdas capturing
+ * more than that fail to compile; capture a reference or pointer to the state
+ * instead.
+ *
+ * @subsection sec_argaction Action arguments
+ * Arguments such as `--help` and `--version` make the program do something
+ * else than usual. A TAP::ActionArgument stops parsing as soon as it occurs,
+ * so the remaining arguments are not converted and required arguments may be
+ * missing. TAP::ArgumentParser::parse() returns the code of the action, or 0
+ * to continue normally: @code
+ * enum { Help = 1, Version };
+ * TAP::ArgumentParser parser(
+ *     TAP::ActionArgument("Show this &help text", Help),
+ *     TAP::ActionArgument("Show &version information", Version), ...);
+ * switch (parser.parse(argc, argv)) {
+ * case Help:
+ *     std::cout << parser.help();
+ *     return 0;
+ * case Version:
+ *     std::cout << "1.0" << std::endl;
+ *     return 0;
+ * }
+ * @endcode
+ *
  * @subsection sec_argconstr Argument constraints
  * Every now and then some arguments can only occur in certain combinations or
  * have some sort of constraint associated with them (aside from the number of
@@ -226,6 +272,31 @@ int main(int argc, const char* argv[]) {
  * either left or right be selected (so selecting neither is invalid), set the
  * constraint as required with set_required().
  *
+ * Aside from TAP::ConstraintType::One, constraints can require at most one
+ * (AtMostOne), at least N (AtLeast), exactly N (Exactly) or all (All) of their
+ * arguments to be set. The N is given with TAP::ArgumentConstraint::bound():
+ * @code
+ * TAP::ArgumentConstraint<TAP::ConstraintType::AtLeast> inputs(file, url, stdin);
+ * inputs.bound(2);
+ * @endcode
+ * When a parser is frozen (see TAP::ArgumentParser::freeze()), all
+ * constraints are compiled into a few bit operations over the set of set
+ * arguments, so checking them is cheap even for large numbers of constraints.
+ *
+ * Constraints can also restrict the values of their arguments, using
+ * TAP::ArgumentConstraint::check_values() (or
+ * TAP::ArgumentParser::check_values() for the parser as a whole). The given
+ * predicate is evaluated once, after all values have been parsed:
+ * @code
+ * TAP::ValueArgument<int> threads("Number of &threads", 1);
+ * TAP::ValueArgument<int> maxThreads("$max-threads allowed", 8);
+ * TAP::ArgumentParser parser(threads, maxThreads);
+ * parser.check_values("Too many threads: ",
+ *     [](const TAP::ValueArgument<int>& t, const TAP::ValueArgument<int>& m) {
+ *         return t.value() <= m.value();
+ *     }, threads, maxThreads);
+ * @endcode
+ *
  * Note: Be careful when adding arguments that are required to constraints with
  * an upper bound on the number of allowed arguments (such as
  * TAP::ConstraintType::One). This can lead to situations where the constraint
@@ -252,6 +323,10 @@ int main(int argc, const char* argv[]) {
  * TAP::ArgumentParser parser(+(left ^ right), help);
  * @endcode
  *
+ * Chains such as `a ^ b ^ c ^ d` result in one constraint of four
+ * arguments. Each operator appends to the constraint built so far instead of
+ * copying it, so every argument is copied only once.
+ *
  * @subsection sec_argparsing Parsing arguments
  * Parsing arguments is relatively straight-forward. After defining all
  * arguments and an argument parser, with the arguments added to the parser,
@@ -274,11 +349,100 @@ int main(int argc, const char* argv[]) {
  * Arguments can be added either in the constructor, or using the
  * TAP::ArgumentParser::add() method.
  *
+ * The help text is laid out once and kept until the parser changes.
+ * TAP::ArgumentParser::write_help() writes it wrapped to a given width, or
+ * to a file descriptor wrapped to the width of the terminal (e.g.
+ * `parser.write_help(1)` for standard output).
+ *
+ * Shells can complete command lines by asking the program itself:
+ * TAP::completion_script() generates the glue for bash, zsh and fish, which
+ * invokes the program as `program --complete <index> <words...>`. Answer these
+ * requests with TAP::ArgumentParser::complete() before parsing; it only
+ * resolves the context of the word (see
+ * TAP::ArgumentParser::completions()), offering names, the values set with
+ * TAP::Argument::choices(), or file names (see
+ * TAP::Argument::complete_files()).
+ *
+ * To avoid starting the program for each request, or to check its command
+ * lines from other tools, TAP::ArgumentParser::export_schema() writes the
+ * arguments as a compact binary schema. TAP::SchemaView reads it in place,
+ * e.g. mapped with TAP::MappedFile, to look up, validate and complete
+ * arguments without the program: @code
+ * TAP::MappedFile file("prog.schema");
+ * TAP::SchemaView schema(file.data(), file.size());
+ * for (const std::string& candidate: schema.completions(words, count, index)) {
+ *     std::cout << candidate << '\n';
+ * }
+ * @endcode
+ *
+ * For large parsers, TAP::ArgumentParser::help(const TAP::HelpQuery&) shows
+ * only the entries of a group, with names starting with a prefix, or
+ * containing some text. TAP::HelpQuery::parse() interprets patterns given by
+ * users, e.g. for `--help=pattern`: @code
+ * TAP::ArgumentParser parser(...);
+ * std::string topic;
+ * parser.add(TAP::VariableArgument<std::string>("Show help for a topic", "help", topic));
+ * parser.parse(argc, argv);
+ * if (!topic.empty()) {
+ *     std::cout << parser.help(TAP::HelpQuery::parse(topic));
+ * }
+ * @endcode
+ *
+ * By default, occurrence counts and constraints are checked once all
+ * arguments have been processed. With TAP::ArgumentParser::fail_fast(), a
+ * command line is rejected as soon as an argument occurs too often, or a
+ * constraint can no longer be satisfied (e.g. both arguments of `left ^ right`
+ * are given), without converting any of the remaining values.
+ *
+ * Where rejected command lines are common, TAP::ArgumentParser::try_parse()
+ * avoids the cost of exceptions. It returns a TAP::ParseResult with the kind
+ * of error, the index of the offending token in argv and the argument
+ * involved. The exception parse() would have thrown can still be obtained
+ * with TAP::ArgumentParser::raise().
+ * @code
+ * TAP::ParseResult result = parser.try_parse(argc, argv);
+ * if (!result) {
+ *     std::cerr << "Problem with argument " << result.index() << std::endl;
+ *     return 1;
+ * }
+ * @endcode
+ *
+ * To only check command lines, TAP::ArgumentParser::validate() reads all
+ * tokens and collects every problem in a reusable TAP::ValidationResult,
+ * without setting any argument. Values are converted into temporaries, check
+ * functions and value predicates are not run.
+ *
+ * When a name is not known, the TAP::unknown_argument exception suggests
+ * the closest known names (e.g. `--verbose` for `--verbsoe`), see
+ * TAP::ArgumentParser::suggest().
+ *
+ * Tools that keep their options in a struct can bind its fields directly with
+ * a TAP::Binding. Each field is then an entry in a table of member pointers
+ * instead of an argument object, and parsing fills in an instance of the
+ * struct:
+ * @code
+ * TAP::Binding<Config> binding;
+ * binding.bind(&Config::jobs, "Number of jobs", 'j', "jobs");
+ * Config config;
+ * binding.parse(argc, argv, config);
+ * @endcode
+ *
  * @subsubsection sec_arggroups Argument groups
  * To group arguments (useful mostly for the help text) a TAP::ArgumentSet can
  * be created (similar to a constraint), with a given name. When added to the
  * parser, its children are grouped separately in the help text.
  *
+ * @subsubsection sec_argnamespaces Argument namespaces
+ * Large applications can split their arguments into dotted namespaces (e.g.
+ * `--db.pool.size`), each provided by a factory that is only invoked once a
+ * name in the namespace is used. The main help text lists the namespaces,
+ * and TAP::ArgumentParser::help(const std::string&) shows a single one.
+ * @code
+ * parser.add_namespace("db.pool", "Connection pool", [](TAP::ArgumentSet& args) {
+ *     args.add(TAP::ValueArgument<int>("Pool size", "db.pool.size", 8));
+ * });
+ * @endcode
+ *
  * @subsection argtest_sec Argument testing and value retrieval
  * To determine if an argument is set, converting to bool is possible, e.g.
  * @code
@@ -304,14 +468,45 @@ int main(int argc, const char* argv[]) {
  *   that this requires stored variables to allow copy or move construction.
  * * TAP_AUTOFLAG : When defined, try to parse the description string to find
  *   flag and/or name markers. See also TAP::Argument::parse_description().
+ * * TAP_EMBEDDED : When defined, only the embedded profile in TAP::embedded is
+ *   available. It offers a subset of the library (switches, single and multi
+ *   valued arguments, argument sets and a parser) with capacities fixed at
+ *   compile time. It never allocates and reports errors as codes instead of
+ *   exceptions, so it can be used with -fno-exceptions. For example: @code
+ * TAP::embedded::Argument verbose("Be verbose", 'v');
+ * TAP::embedded::ValueArgument<int> jobs("Number of jobs", 'j', "jobs", 1);
+ * TAP::embedded::ArgumentParser<8> parser(verbose, jobs);
+ * TAP::embedded::ParseResult result = parser.parse(argc, argv);
+ * if (!result) {
+ *     fprintf(stderr, "%s\n", TAP::embedded::error_string(result.error));
+ *     return 1;
+ * }
+ * @endcode
+ *   The embedded profile is also available without TAP_EMBEDDED. Its
+ *   TAP::embedded::StaticParser takes a schema fixed at compile time, from
+ *   which the compiler builds the flag table, a perfect hash of the names and
+ *   the help text. Values are stored in the parser, accessed by their index.
  *
  * Aside from these options, other defines allow some of the syntax to be
  * tweaked (see Tap.h for more details):
  * * TAP_FLAG : Defines the string for TAP::flagStart
  * * TAP_NAME : Defines the string for TAP::nameStart
  * * TAP_NAMEDELIMITER : Defines the string for TAP::nameDelim
+ * * TAP_NAMESPACEDELIMITER : Defines the character for TAP::namespaceDelim
  * * TAP_SKIP: Defines the string for TAP::skip
  *
+ * These defines apply to the whole program. To parse with different markers,
+ * use TAP::BasicArgumentParser with a syntax policy (see TAP::DefaultSyntax),
+ * which can differ per parser. Its help text and exceptions show arguments
+ * with the markers of the syntax (see TAP::Markers).
+ *
+ * The library does not rely on RTTI, and may be compiled with -fno-rtti. When
+ * the parser is frozen, the way each argument is set is resolved once (see
+ * TAP::Argument::ops()), so parsing does not need to inspect argument types.
+ * Values are set through TAP::ValueAcceptor::try_set(), so classes that
+ * accept values without deriving from a library class must return
+ * themselves from TAP::Argument::acceptor().
+ *
  * @section sec_quirks Quirks
  * Though the library is intended to use relatively easy to use, it may not
  * always do what is expected. Some quirks are listed here:
@@ -319,16 +514,20 @@ int main(int argc, const char* argv[]) {
  *   Thus, adding an argument to the parser and modifying it afterwards does
  *   not work as one may expect. However, copies of arguments will share the
  *   same occurrence counter and value, thus adding an argument without
- *   modification to multiple constraints will still work.
- * * No argument duplication checks are made. If you add an argument (or two
- *   different arguments) with the same alias to the parser, constraint or
- *   group, the library will not generate an error. This is useful for the case
+ *   modification to multiple constraints will still work. Each argument is
+ *   copied once when added; copying constraints, groups or the parser
+ *   afterwards shares these copies instead of duplicating them.
+ * * By default, no argument duplication checks are made. If you add an
+ *   argument (or two different arguments) with the same alias to the parser,
+ *   constraint or group, the library will not generate an error. This is useful for the case
  *   where an argument occurs in multiple constraints (as they are stored as
  *   copies, see above point), but may yield surprising results otherwise. The
  *   parser will try to find arguments in the order they were added, so the
  *   first added argument has priority. However, if that argument is already
  *   set its maximum amount of times, it will look for the next. Only if that
- *   fails an error is generated.
+ *   fails an error is generated. To have the parser reject different
+ *   arguments with the same alias, use
+ *   TAP::ArgumentParser::allow_duplicates(false).
  * * The point above also implies something else: It is possible to add
  *   multiple positional arguments that can occur many times. In that case,
  *   only the first argument added will receive values.
@@ -349,32 +548,40 @@ namespace TAP {
 
 /** Marker for flags (one letter arg) */
 #ifndef TAP_FLAG
-const char flagStart[] = "-";
+constexpr char flagStart[] = "-";
 #else
-const char flagStart[] = TAP_FLAG;
+constexpr char flagStart[] = TAP_FLAG;
 #endif
 
 /** Marker for names (>1 letter arg) */
 #ifndef TAP_NAME
-const char nameStart[] = "--";
+constexpr char nameStart[] = "--";
 #else
-const char nameStart[] = TAP_NAME;
+constexpr char nameStart[] = TAP_NAME;
 #endif
 
 /** Delimiter between name and argument (e.g. --name=value).
  * Define as '\0' to disable */
 #ifndef TAP_NAMEDELIMITER
-const char nameDelim = '=';
+constexpr char nameDelim = '=';
 #else
-const char nameDelim = TAP_NAMEDELIMITER;
+constexpr char nameDelim = TAP_NAMEDELIMITER;
+#endif
+
+/** Delimiter between the segments of namespaced names (e.g. --db.pool.size),
+ * see ArgumentParser::add_namespace() */
+#ifndef TAP_NAMESPACEDELIMITER
+constexpr char namespaceDelim = '.';
+#else
+constexpr char namespaceDelim = TAP_NAMESPACEDELIMITER;
 #endif
 
 /** Define the parsed arg delimiter.
  * Define as "" to disable */
 #ifndef TAP_SKIP
-const char skip[] = "--";
+constexpr char skip[] = "--";
 #else
-const char skip[] = TAP_SKIP;
+constexpr char skip[] = TAP_SKIP;
 #endif
 
 // If TAP_STREAMSAFE is defined, stream operator will first check the result
@@ -383,21 +590,67 @@ const char skip[] = TAP_SKIP;
 
 // If TAP_AUTOFLAG defined, special characters in the argument description will
 // be used to define flags and names. It has a runtime hit but looks fancy.
+// Descriptions from TAP::markup() are parsed at compile time instead.
 //#define TAP_AUTOFLAG 1
 
+// If TAP_NOPOSIX is defined, help text is not written with writev() and the
+// terminal width is only read from the COLUMNS environment variable. It is
+// implied on platforms other than Unix and macOS.
+//#define TAP_NOPOSIX 1
+
+// If TAP_EMBEDDED is defined, only the allocation and exception free embedded
+// profile is available, see TAP::embedded. It is always included.
+//#define TAP_EMBEDDED 1
+
 }
 
+#include "tap/Syntax.hpp"
+#include "tap/Embedded.hpp"
+#include "tap/StaticParser.hpp"
+
+#include "tap/impl/Embedded.hpp"
+#include "tap/impl/StaticParser.hpp"
+
+#ifndef TAP_EMBEDDED
+
+#include "tap/SmallFunction.hpp"
 #include "tap/BaseArgument.hpp"
+#include "tap/Markup.hpp"
 #include "tap/Argument.hpp"
 #include "tap/TypedArgument.hpp"
+#include "tap/PatternArgument.hpp"
+#include "tap/ParseResult.hpp"
 #include "tap/ArgumentConstraint.hpp"
+#include "tap/ConstraintProgram.hpp"
+#include "tap/EditDistance.hpp"
+#include "tap/ArgumentIndex.hpp"
+#include "tap/Namespace.hpp"
+#include "tap/HelpLayout.hpp"
+#include "tap/HelpIndex.hpp"
+#include "tap/Completion.hpp"
+#include "tap/SchemaFile.hpp"
 #include "tap/Parser.hpp"
 #include "tap/Exceptions.hpp"
 #include "tap/Operators.hpp"
+#include "tap/Binding.hpp"
 
+#include "tap/impl/SmallFunction.hpp"
+#include "tap/impl/Markup.hpp"
 #include "tap/impl/Argument.hpp"
 #include "tap/impl/TypedArgument.hpp"
+#include "tap/impl/PatternArgument.hpp"
 #include "tap/impl/ArgumentConstraint.hpp"
+#include "tap/impl/ConstraintProgram.hpp"
+#include "tap/impl/EditDistance.hpp"
+#include "tap/impl/ArgumentIndex.hpp"
+#include "tap/impl/Namespace.hpp"
+#include "tap/impl/HelpLayout.hpp"
+#include "tap/impl/HelpIndex.hpp"
+#include "tap/impl/Completion.hpp"
 #include "tap/impl/Parser.hpp"
+#include "tap/impl/SchemaFile.hpp"
 #include "tap/impl/Exceptions.hpp"
 #include "tap/impl/Operators.hpp"
+#include "tap/impl/Binding.hpp"
+
+#endif
@@ -31,9 +31,27 @@ namespace TAP {
 template<typename T, bool multi = false>
 class TypedArgument;
 
-/** Function pointer that is used by ValueArgument::check() */
+/** Function that is used by ValueArgument::check(). Stored inline, without
+ * allocating (see detail::SmallFunction). */
 template<typename T, bool multi>
-using TypedArgumentCheckFunc = std::function<void(const TypedArgument<T, multi>&, const T& value)>;
+using TypedArgumentCheckFunc = detail::SmallFunction<void(const TypedArgument<T, multi>&, const T& value)>;
+
+namespace detail {
+
+/**
+ * Returns the kind of values of type T, as read by streaming (see
+ * detail::setValue()). Characters are read as text.
+ * @return Kind of the values
+ */
+template<typename T>
+constexpr ValueKind value_kind() {
+    return std::is_same<T, bool>::value ? ValueKind::None :
+        (std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value) ? ValueKind::Text :
+        std::is_integral<T>::value ? ValueKind::Integer :
+        std::is_floating_point<T>::value ? ValueKind::Real : ValueKind::Text;
+}
+
+}
 
 /**
  * Base class for arguments that hold a typed value. The class can optionally be
@@ -71,7 +89,7 @@ protected:
      * @param description Description of the argument (used in help text)
      * @param storage Pointer to storage variable
      */
-    TypedArgument(std::string description, ST* storage) :
+    TypedArgument(Description description, ST* storage) :
         Argument(std::move(description)), m_storage(storage) {
         m_max = (multi?0:1);
     }
@@ -84,7 +102,7 @@ protected:
      * @param flag Flag identifier of this argument
      * @param storage Pointer to storage variable
      */
-    TypedArgument(std::string description, char flag, ST* storage) :
+    TypedArgument(Description description, char flag, ST* storage) :
         Argument(std::move(description), flag), m_storage(storage) {
         m_max = (multi?0:1);
     }
@@ -97,7 +115,7 @@ protected:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    TypedArgument(std::string description, const std::string& name, ST* storage) :
+    TypedArgument(Description description, const std::string& name, ST* storage) :
         Argument(std::move(description), name), m_storage(storage) {
         m_max = (multi?0:1);
     }
@@ -111,7 +129,7 @@ protected:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    TypedArgument(std::string description, char flag, const std::string& name, ST* storage) :
+    TypedArgument(Description description, char flag, const std::string& name, ST* storage) :
         Argument(std::move(description), flag, name), m_storage(storage) {
         m_max = (multi?0:1);
     }
@@ -208,7 +226,7 @@ public:
      * @param description Description of the argument (used in help text)
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, ST* storage) :
+    VariableArgument(Description description, ST* storage) :
         TypedArgument<T, multi>(std::move(description), storage) {
     }
 
@@ -220,7 +238,7 @@ public:
      * @param flag Flag identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, char flag, ST* storage) :
+    VariableArgument(Description description, char flag, ST* storage) :
         TypedArgument<T, multi>(std::move(description), flag, storage) {
     }
 
@@ -232,7 +250,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, const std::string& name, ST* storage) :
+    VariableArgument(Description description, const std::string& name, ST* storage) :
         TypedArgument<T, multi>(std::move(description), name, storage) {
     }
 
@@ -245,7 +263,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, char flag, const std::string& name, ST* storage) :
+    VariableArgument(Description description, char flag, const std::string& name, ST* storage) :
         TypedArgument<T, multi>(std::move(description), flag, name, storage) {
     }
 
@@ -255,7 +273,7 @@ public:
      * @param description Description of the argument (used in help text)
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, ST& storage) :
+    VariableArgument(Description description, ST& storage) :
         TypedArgument<T, multi>(std::move(description), &storage) {
     }
 
@@ -267,7 +285,7 @@ public:
      * @param flag Flag identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, char flag, ST& storage) :
+    VariableArgument(Description description, char flag, ST& storage) :
         TypedArgument<T, multi>(std::move(description), flag, &storage) {
     }
 
@@ -279,7 +297,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, const std::string& name, ST& storage) :
+    VariableArgument(Description description, const std::string& name, ST& storage) :
         TypedArgument<T, multi>(std::move(description), name, &storage) {
     }
 
@@ -292,7 +310,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Pointer to storage variable
      */
-    VariableArgument(std::string description, char flag, const std::string& name, ST& storage) :
+    VariableArgument(Description description, char flag, const std::string& name, ST& storage) :
         TypedArgument<T, multi>(std::move(description), flag, name, &storage) {
     }
 
@@ -362,15 +380,42 @@ public:
         return !std::is_same<bool, T>::value;
     }
 
+    /**
+     * See Argument::ops()
+     */
+    const detail::ArgumentOps& ops() const override {
+        static const detail::ArgumentOps ops = { &Argument::set_argument, &VariableArgument::set_value, &VariableArgument::check_value,
+            detail::value_kind<T>() };
+        return ops;
+    }
+
+    /**
+     * See Argument::acceptor()
+     */
+    const ValueAcceptor* acceptor() const override {
+        return this;
+    }
+
     /**
      * Calling this function is an error, call set(std::string) instead.
      */
     void set() const override;
 
     /**
-     * See ValueAcceptor::set()
+     * See ValueAcceptor::set(). To change how values are set, override
+     * try_set() instead, which is what the parser calls.
+     */
+    void set(const std::string& value) const final;
+
+    /**
+     * See ValueAcceptor::try_set()
+     */
+    bool try_set(const std::string& value) const override;
+
+    /**
+     * See ValueAcceptor::accepts()
      */
-    void set(const std::string& value) const override;
+    bool accepts(const std::string& value) const override;
 
     /**
      * See Argument::usage()
@@ -381,6 +426,25 @@ public:
      * See Argument::ident()
      */
     std::string ident() const override;
+
+protected:
+    /**
+     * Set the value of the given argument through try_set(), see
+     * detail::ArgumentOps::setValue.
+     * @param arg Argument to set, must be a VariableArgument
+     * @param value The value to set, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool set_value(const Argument& arg, const std::string& value);
+
+    /**
+     * Check a value for the given argument through accepts(), see
+     * detail::ArgumentOps::checkValue.
+     * @param arg Argument to check the value for, must be a VariableArgument
+     * @param value The value to check, as a string
+     * @return False if the value cannot be converted
+     */
+    static bool check_value(const Argument& arg, const std::string& value);
 };
 
 /**
@@ -413,7 +477,7 @@ public:
      * @param params Arguments passed to the constructor of the value storage
      */
     template<typename... U, typename = typename std::enable_if< std::is_constructible<ST, U...>::value >::type >
-    ValueArgument(std::string description, U&&... params) :
+    ValueArgument(Description description, U&&... params) :
         VariableArgument<T, multi>(std::move(description), new ST(std::forward<U>(params)...)),
         m_ownStorage(m_storage)
     {
@@ -428,7 +492,7 @@ public:
      * @param params Arguments passed to the constructor of the value storage
      */
     template<typename... U, typename = typename std::enable_if< std::is_constructible<ST, U...>::value >::type>
-    ValueArgument(std::string description, char flag, U&&... params) :
+    ValueArgument(Description description, char flag, U&&... params) :
         VariableArgument<T, multi>(std::move(description), flag, new ST(std::forward<U>(params)...)),
         m_ownStorage(m_storage)
     {
@@ -443,7 +507,7 @@ public:
      * @param params Arguments passed to the constructor of the value storage
      */
     template<typename... U, typename = typename std::enable_if< std::is_constructible<ST, U...>::value >::type >
-    ValueArgument(std::string description, const std::string& name, U&&... params) :
+    ValueArgument(Description description, const std::string& name, U&&... params) :
         VariableArgument<T, multi>(std::move(description), name, new ST(std::forward<U>(params)...)),
         m_ownStorage(m_storage)
     {
@@ -459,7 +523,7 @@ public:
      * @param params Arguments passed to the constructor of the value storage
      */
     template<typename... U, typename = typename std::enable_if< std::is_constructible<ST, U...>::value >::type >
-    ValueArgument(std::string description, char flag, const std::string& name, U&&... params) :
+    ValueArgument(Description description, char flag, const std::string& name, U&&... params) :
         VariableArgument<T, multi>(std::move(description), flag, name, new ST(std::forward<U>(params)...)),
         m_ownStorage(m_storage)
     {
@@ -537,7 +601,7 @@ public:
      * @param storage Variable to store the value in
      * @param value Value to set the variable to when this argument is set
      */
-    ConstArgument(std::string description, T& storage, const T& value) :
+    ConstArgument(Description description, T& storage, const T& value) :
         TypedArgument<T, false>(std::move(description), &storage), m_value(value) {
     }
 #endif
@@ -550,7 +614,7 @@ public:
      * @param storage Variable to store the value in
      * @param value Value to set the variable to when this argument is set
      */
-    ConstArgument(std::string description, char flag, T& storage, const T& value) :
+    ConstArgument(Description description, char flag, T& storage, const T& value) :
         TypedArgument<T, false>(std::move(description), flag, &storage), m_value(value) {
     }
 
@@ -562,7 +626,7 @@ public:
      * @param storage Variable to store the value in
      * @param value Value to set the variable to when this argument is set
      */
-    ConstArgument(std::string description, const std::string& name, T& storage, const T& value) :
+    ConstArgument(Description description, const std::string& name, T& storage, const T& value) :
         TypedArgument<T, false>(std::move(description), name, &storage), m_value(value) {
     }
 
@@ -575,7 +639,7 @@ public:
      * @param storage Variable to store the value in
      * @param value Value to set the variable to when this argument is set
      */
-    ConstArgument(std::string description, char flag, const std::string& name, T& storage, const T& value) :
+    ConstArgument(Description description, char flag, const std::string& name, T& storage, const T& value) :
         TypedArgument<T, false>(std::move(description), flag, name, &storage), m_value(value) {
     }
 
@@ -658,7 +722,7 @@ public:
      *        contain flag or name markers
      * @param storage Variable to store the value in
      */
-    SwitchArgument(std::string description, bool& storage) :
+    SwitchArgument(Description description, bool& storage) :
         TypedArgument<bool, false>(std::move(description), &storage) {
     }
 #endif
@@ -670,7 +734,7 @@ public:
      * @param flag Flag identifier of this argument
      * @param storage Variable to store the value in
      */
-    SwitchArgument(std::string description, char flag, bool& storage) :
+    SwitchArgument(Description description, char flag, bool& storage) :
         TypedArgument<bool, false>(std::move(description), flag, &storage) {
     }
 
@@ -681,7 +745,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Variable to store the value in
      */
-    SwitchArgument(std::string description, const std::string& name, bool& storage) :
+    SwitchArgument(Description description, const std::string& name, bool& storage) :
         TypedArgument<bool, false>(std::move(description), name, &storage) {
     }
 
@@ -693,7 +757,7 @@ public:
      * @param name Name identifier of this argument
      * @param storage Variable to store the value in
      */
-    SwitchArgument(std::string description, char flag, const std::string& name, bool& storage) :
+    SwitchArgument(Description description, char flag, const std::string& name, bool& storage) :
         TypedArgument<bool, false>(std::move(description), flag, name, &storage) {
     }
 
@@ -707,7 +771,7 @@ public:
      * @param description Description of the argument (used in help text). Must
      *        contain flag or name markers
      */
-    SwitchArgument(std::string description) :
+    SwitchArgument(Description description) :
         TypedArgument<bool, false>(std::move(description), new bool()),
         m_ownStorage(m_storage) {
     }
@@ -719,7 +783,7 @@ public:
      * @param description Description of the argument (used in help text)
      * @param flag Flag identifier of this argument
      */
-    SwitchArgument(std::string description, char flag) :
+    SwitchArgument(Description description, char flag) :
         TypedArgument<bool, false>(std::move(description), flag, new bool()),
         m_ownStorage(m_storage) {
     }
@@ -730,7 +794,7 @@ public:
      * @param description Description of the argument (used in help text)
      * @param name Name identifier of this argument
      */
-    SwitchArgument(std::string description, const std::string& name) :
+    SwitchArgument(Description description, const std::string& name) :
         TypedArgument<bool, false>(std::move(description), name, new bool()),
         m_ownStorage(m_storage) {
     }
@@ -742,7 +806,7 @@ public:
      * @param flag Flag identifier of this argument
      * @param name Name identifier of this argument
      */
-    SwitchArgument(std::string description, char flag, const std::string& name) :
+    SwitchArgument(Description description, char flag, const std::string& name) :
         TypedArgument<bool, false>(std::move(description), flag, name, new bool()),
         m_ownStorage(m_storage)  {
     }
@@ -42,12 +42,13 @@ inline void Argument::check_valid() const {
  * See BaseArgument::usage()
  */
 inline std::string Argument::usage() const {
+    const Markers& markers = Markers::current();
     std::string usageStr;
     if (m_flags.length() > 0u) {
         // Print first flag only, aliases generally not needed
-        usageStr = std::string(flagStart) + m_flags[0];
+        usageStr = std::string(markers.flagStart) + m_flags[0];
     } else if (m_names.size() > 0u) {
-        usageStr = std::string(nameStart) + m_names[0];
+        usageStr = std::string(markers.nameStart) + m_names[0];
     } else {
         // else positional, needs an override
         throw std::logic_error("Base usage() called on positional argument");
@@ -56,16 +57,22 @@ inline std::string Argument::usage() const {
     return usageStr;
 }
 
+inline bool Argument::compile(detail::ConstraintProgram& program, std::size_t, std::size_t& index) const {
+    index = program.add(*this);
+    return false;
+}
+
 /**
  * Print a string representation of this argument to the given stream. This
  * is usually represented in the first column of help text.
  * @return String representation.
  */
 inline std::string Argument::ident() const {
+    const Markers& markers = Markers::current();
     std::string ident;
     if (m_flags.length() > 0u) {
         // Print first flag only, aliases generally not needed
-        ident += std::string(flagStart) + m_flags[0];
+        ident += std::string(markers.flagStart) + m_flags[0];
     }
 
     if (m_names.size() > 0u) {
@@ -73,7 +80,7 @@ inline std::string Argument::ident() const {
         if (m_flags.length() > 0u) {
             ident += ", ";
         }
-        ident += std::string(nameStart) + m_names[0];
+        ident += std::string(markers.nameStart) + m_names[0];
     }
 
     // if positional, needs override
@@ -81,4 +88,20 @@ inline std::string Argument::ident() const {
     return ident;
 }
 
+inline bool Argument::set_acceptor(const Argument& arg, const std::string& value) {
+    const ValueAcceptor* acceptor = arg.acceptor();
+    if (acceptor == nullptr) {
+        throw std::logic_error("Requested value interface on non-valued argument");
+    }
+    return acceptor->try_set(value);
+}
+
+inline bool Argument::check_acceptor(const Argument& arg, const std::string& value) {
+    const ValueAcceptor* acceptor = arg.acceptor();
+    if (acceptor == nullptr) {
+        throw std::logic_error("Requested value interface on non-valued argument");
+    }
+    return acceptor->accepts(value);
+}
+
 }
@@ -23,38 +23,85 @@ freely, subject to the following restrictions:
 namespace TAP {
 
 namespace detail {
-/** Internal type alias used by the constraints constructor */
-template<class T> using Temporary = T;
+
+inline void ValuePredicate::check() const {
+    if (!holds()) {
+        std::vector<const BaseArgument*> args;
+        arguments(args);
+        throw constraint_error(m_reason, args);
+    }
+}
 
 /**
  * Helper struct to define constraint traits for ArgumentConstraint.
  */
 template<ConstraintType CType>
 struct ConstraintTraits {
+    /** True if the sub-arguments are alternatives to each other */
+    static constexpr bool alternative() {
+        return CType == ConstraintType::One || CType == ConstraintType::AtMostOne;
+    }
+
     /** String used to concatenate usage string of sub-arguments */
     static constexpr const char* joinStr()  {
-        return " ";
+        return alternative() ? " | " : " ";
     }
 };
 
 /**
- * Helper struct to define constraint traits for ArgumentConstraint.
- * Specialized for ConstraintType::One.
+ * Returns whether a counting constraint is satisfied.
+ * @param type Type of the constraint
+ * @param count Number of sub-arguments that are set
+ * @param size Number of sub-arguments
+ * @param bound Bound of the constraint (see ArgumentConstraint::bound())
+ * @return True iff the constraint is satisfied by count
  */
-template<>
-struct ConstraintTraits<ConstraintType::One> {
-    /** String used to concatenate usage string of sub-arguments */
-    static constexpr const char* joinStr()  {
-        return " | ";
+inline bool constraint_accepts(ConstraintType type, unsigned int count, std::size_t size, unsigned int bound) {
+    switch (type) {
+    case ConstraintType::One:
+        return count == 1u;
+    case ConstraintType::AtMostOne:
+        return count <= 1u;
+    case ConstraintType::AtLeast:
+        return count >= bound;
+    case ConstraintType::Exactly:
+        return count == bound;
+    case ConstraintType::All:
+        return count == size;
+    default:
+        return true;
     }
-};
+}
+
+/**
+ * Returns the reason reported when a counting constraint is not satisfied.
+ * @param type Type of the constraint
+ * @param bound Bound of the constraint (see ArgumentConstraint::bound())
+ * @return Reason of failure, to be followed by the arguments involved
+ */
+inline std::string constraint_reason(ConstraintType type, unsigned int bound) {
+    switch (type) {
+    case ConstraintType::One:
+        return "Must set exactly one argument from ";
+    case ConstraintType::AtMostOne:
+        return "Must set at most one argument from ";
+    case ConstraintType::AtLeast:
+        return "Must set at least " + std::to_string(bound) + " arguments from ";
+    case ConstraintType::Exactly:
+        return "Must set exactly " + std::to_string(bound) + " arguments from ";
+    case ConstraintType::All:
+        return "Must set all arguments from ";
+    default:
+        return "Constraint not satisfied: ";
+    }
+}
 
 }
 
 template<ConstraintType CType>
-template<typename ... A>
+template<typename ... A, typename>
 inline ArgumentConstraint<CType>::ArgumentConstraint(A&& ... arguments) :
-    BaseArgument(), m_usageString() {
+    BaseArgument(), m_data(std::make_shared<detail::ConstraintData>()) {
     //static_assert(CType != ConstraintType::One || sizeof...(arguments) > 1, "ConstraintType::One needs at least two arguments");
     add(std::forward<A>(arguments)...);
 }
@@ -62,15 +109,28 @@ inline ArgumentConstraint<CType>::ArgumentConstraint(A&& ... arguments) :
 template<ConstraintType CType>
 template<typename Arg>
 inline ArgumentConstraint<CType>& ArgumentConstraint<CType>::add(Arg&& arg) {
-    auto newArg = std::forward<Arg>(arg).clone();
-    if (m_args.size() > 0) {
-        m_usageString += std::string(detail::ConstraintTraits<CType>::joinStr());
-    }
+    return add_argument(detail::flatten(std::forward<Arg>(arg)));
+}
 
-    m_usageString += usageArgument(static_cast<const Arg&>(*newArg));
+template<ConstraintType CType>
+template<typename Arg>
+inline ArgumentConstraint<CType>& ArgumentConstraint<CType>::add_argument(Arg&& arg) {
+    auto newArg = std::forward<Arg>(arg).clone();
+    detail::ConstraintData& data = modify();
+    data.wraps.push_back(usageArgument(static_cast<const Arg&>(*newArg)));
+    data.args.emplace_back(std::move(newArg));
 
-    m_args.emplace_back(std::move(newArg));
+    return *this;
+}
 
+template<ConstraintType CType>
+inline ArgumentConstraint<CType>& ArgumentConstraint<CType>::operator+=(ArgumentConstraint<CType> const& other) {
+    // Keep other alive, in case it shares the contents with this constraint
+    std::shared_ptr<const detail::ConstraintData> otherData = other.m_data;
+    detail::ConstraintData& data = modify();
+    data.wraps.insert(data.wraps.end(), otherData->wraps.begin(), otherData->wraps.end());
+    data.args.insert(data.args.end(), otherData->args.begin(), otherData->args.end());
+    data.predicates.insert(data.predicates.end(), otherData->predicates.begin(), otherData->predicates.end());
     return *this;
 }
 
@@ -83,11 +143,30 @@ inline ArgumentConstraint<CType>& ArgumentConstraint<CType>::add(Arg&& arg, A&&
     return *this;
 }
 
+template<ConstraintType CType>
+inline void ArgumentConstraint<CType>::check_valid() const {
+    unsigned int counter = 0;
+    for(auto const& arg: m_data->args) {
+        if (arg->is_set()) {
+            arg->check_valid();
+            ++counter;
+        }
+    }
+    if (!detail::constraint_accepts(CType, counter, m_data->args.size(), m_bound)) {
+        std::vector<const BaseArgument*> args;
+        for(auto const& arg: m_data->args) {
+            // Copy to raw pointer vector
+            args.push_back(arg.get());
+        }
+        throw constraint_error(detail::constraint_reason(CType, m_bound), args);
+    }
+}
+
 template<>
 inline void ArgumentConstraint<ConstraintType::Imp>::check_valid() const {
     bool checkNext = false;
-    BaseArgument* lastArg = nullptr;
-    for(auto const& arg: m_args) {
+    const BaseArgument* lastArg = nullptr;
+    for(auto const& arg: m_data->args) {
         if (arg->is_set()) {
             arg->check_valid();
         }
@@ -105,7 +184,7 @@ inline void ArgumentConstraint<ConstraintType::Imp>::check_valid() const {
 template<>
 inline void ArgumentConstraint<ConstraintType::One>::check_valid() const {
     unsigned int counter = 0;
-    for(auto const& arg: m_args) {
+    for(auto const& arg: m_data->args) {
         if (arg->is_set()) {
             arg->check_valid();
             ++counter;
@@ -113,18 +192,18 @@ inline void ArgumentConstraint<ConstraintType::One>::check_valid() const {
     }
     if (counter != 1) {
         std::vector<const BaseArgument*> args;
-        for(auto const& arg: m_args) {
+        for(auto const& arg: m_data->args) {
             // Copy to raw pointer vector
             args.push_back(arg.get());
         }
-        throw constraint_error("Must set exactly one argument from ", args);
+        throw constraint_error(detail::constraint_reason(ConstraintType::One, m_bound), args);
     }
 }
 
 template<>
 inline void ArgumentConstraint<ConstraintType::Any>::check_valid() const {
     std::vector<const BaseArgument*> failed_args;
-    for(auto const& arg: m_args) {
+    for(auto const& arg: m_data->args) {
         if (arg->is_set() || arg->required()) {
             arg->check_valid();
         }
@@ -141,7 +220,7 @@ inline void ArgumentConstraint<ConstraintType::Any>::check_valid() const {
 
 template<ConstraintType CType>
 inline unsigned int ArgumentConstraint<CType>::count() const {
-    for (auto const& arg : m_args) {
+    for (auto const& arg : m_data->args) {
         if (arg->is_set()) {
             return 1;
         }
@@ -149,37 +228,111 @@ inline unsigned int ArgumentConstraint<CType>::count() const {
     return 0;
 }
 
+template<ConstraintType CType>
+inline bool ArgumentConstraint<CType>::compile(detail::ConstraintProgram& program, std::size_t parent, std::size_t& index) const {
+    index = program.add_op(CType, m_bound, m_required, parent, *this);
+
+    detail::BitSet own;
+    detail::BitSet singles;
+    detail::BitSet requiredSingles;
+    std::vector<detail::BitSet> groups;
+    std::vector<bool> requiredGroups;
+    for (auto const& arg: m_data->args) {
+        std::size_t argIndex;
+        if (arg->compile(program, index, argIndex)) {
+            groups.push_back(program.op(argIndex).mask);
+            requiredGroups.push_back(arg->required());
+            own |= groups.back();
+        } else if (CType == ConstraintType::Imp) {
+            // Order matters for implications, so keep each argument separate
+            detail::BitSet argMask;
+            argMask.set(argIndex);
+            groups.push_back(std::move(argMask));
+            requiredGroups.push_back(arg->required());
+            own.set(argIndex);
+        } else {
+            // Set single bits, avoids temporary sets sized by the index
+            singles.set(argIndex);
+            if (arg->required()) {
+                requiredSingles.set(argIndex);
+            }
+            own.set(argIndex);
+        }
+    }
+
+    // Operations may have moved while compiling the children
+    detail::ConstraintOp& op = program.op(index);
+    op.size = static_cast<unsigned int>(m_data->args.size());
+    op.mask = own;
+    op.singles = std::move(singles);
+    op.requiredSingles = std::move(requiredSingles);
+    op.groups = std::move(groups);
+    op.requiredGroups = std::move(requiredGroups);
+    op.predicates = m_data->predicates;
+    program.finish_op(index);
+
+    return true;
+}
+
 template<ConstraintType CType>
 inline void ArgumentConstraint<CType>::diagnose_args() const {
-    for (auto const& arg : m_args) {
+    for (auto const& arg : m_data->args) {
         arg->check_valid();
     }
 }
 
 template<ConstraintType CType>
-inline std::string ArgumentConstraint<CType>::usageArgument(const Argument& arg) const {
+inline std::string ArgumentConstraint<CType>::usage() const {
+    const detail::ConstraintData& data = *m_data;
+    const Markers& markers = Markers::current();
+    if (!data.usageValid || !(data.usageMarkers == markers)) {
+        data.usage.clear();
+        for (std::size_t i = 0; i < data.args.size(); ++i) {
+            if (i > 0) {
+                data.usage += detail::ConstraintTraits<CType>::joinStr();
+            }
+            switch (data.wraps[i]) {
+            case detail::UsageWrap::Optional:
+                data.usage += "[ " + data.args[i]->usage() + " ]";
+                break;
+            case detail::UsageWrap::Group:
+                data.usage += "( " + data.args[i]->usage() + " )";
+                break;
+            default:
+                data.usage += data.args[i]->usage();
+                break;
+            }
+        }
+        data.usageValid = true;
+        data.usageMarkers = markers;
+    }
+    return data.usage;
+}
+
+template<ConstraintType CType>
+inline detail::UsageWrap ArgumentConstraint<CType>::usageArgument(const Argument& arg) const {
     if (!arg.required() && (CType == ConstraintType::Any)) {
-        return "[ " + arg.usage() + " ]";
+        return detail::UsageWrap::Optional;
     } else {
-        return arg.usage();
+        return detail::UsageWrap::None;
     }
 }
 
 template<ConstraintType CType>
 template<ConstraintType ACType>
-inline std::string ArgumentConstraint<CType>::usageArgument(const ArgumentConstraint<ACType>& arg) const {
+inline detail::UsageWrap ArgumentConstraint<CType>::usageArgument(const ArgumentConstraint<ACType>& arg) const {
     bool paren = (
-            (CType == ConstraintType::One) ||
+            detail::ConstraintTraits<CType>::alternative() ||
             (CType == ConstraintType::Any && ACType != ConstraintType::Any) ||
-            (ACType == ConstraintType::One)
+            detail::ConstraintTraits<ACType>::alternative()
         );
     if (!arg.required() && (CType == ConstraintType::Any && ACType != ConstraintType::Any)) {
-        return "[ " + arg.usage() + " ]";
+        return detail::UsageWrap::Optional;
     }
     if (paren && arg.size() > 0) {
-        return "( " + arg.usage() + " )";
+        return detail::UsageWrap::Group;
     } else {
-        return arg.usage();
+        return detail::UsageWrap::None;
     }
 }
 
@@ -0,0 +1,249 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+namespace detail {
+
+inline void ArgumentIndex::clear() {
+    m_entries.clear();
+    m_flags.clear();
+    m_names.clear();
+    m_positional.clear();
+    m_patterns.clear();
+    m_prefixLengths.clear();
+    m_lengths.clear();
+    m_sorted.clear();
+}
+
+inline void ArgumentIndex::add(const Argument& arg, std::size_t index, bool allowDuplicates) {
+    m_lengths.clear();
+    m_sorted.clear();
+    m_entries.push_back(FrozenArgument{&arg, index, arg.takes_value(), &arg.ops(), arg.action()});
+    const Markers& markers = Markers::current();
+    for (char flag: arg.flags()) {
+        insert(m_flags[flag], allowDuplicates, std::string(markers.flagStart) + flag);
+    }
+    for (const std::string& name: arg.names()) {
+        insert(m_names[name], allowDuplicates, std::string(markers.nameStart) + name);
+    }
+    if (arg.matches()) {
+        // Positional arguments are not identified by an alias, never duplicate
+        insert(m_positional, true, std::string());
+    }
+    const std::string* prefix = arg.pattern();
+    if (prefix != nullptr) {
+        // Patterns with the same prefix may still match different names
+        insert(m_patterns[*prefix], true, std::string());
+        auto pos = std::lower_bound(m_prefixLengths.begin(), m_prefixLengths.end(),
+                prefix->length(), std::greater<std::size_t>());
+        if (pos == m_prefixLengths.end() || *pos != prefix->length()) {
+            m_prefixLengths.insert(pos, prefix->length());
+        }
+    }
+}
+
+inline void ArgumentIndex::suggest(const std::string& name, std::size_t max, std::size_t count, std::vector<std::string>& suggestions) const {
+    suggestions.clear();
+    if (count == 0) {
+        return;
+    }
+    if (m_lengths.empty()) {
+        std::vector<const std::string*> names;
+        names.reserve(m_names.size());
+        for (auto const& entry: m_names) {
+            names.push_back(&entry.first);
+        }
+        // Names sharing a prefix become adjacent, so their columns are shared
+        std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b) {
+            return *a < *b;
+        });
+        for (const std::string* key: names) {
+            if (key->length() >= m_lengths.size()) {
+                m_lengths.resize(key->length() + 1);
+            }
+            m_lengths[key->length()].chars += *key;
+            m_lengths[key->length()].names.push_back(key);
+        }
+    }
+
+    typedef std::pair<std::size_t, const std::string*> Candidate;
+    auto closer = [](const Candidate& a, const Candidate& b) {
+        return a.first < b.first || (a.first == b.first && *a.second < *b.second);
+    };
+    // Closest names so far, sorted by closer
+    std::vector<Candidate> best;
+    best.reserve(count + 1);
+    auto offer = [&](std::size_t d, const std::string* key) {
+        Candidate entry(d, key);
+        if (d > max || (best.size() == count && !closer(entry, best.back()))) {
+            return;
+        }
+        best.insert(std::upper_bound(best.begin(), best.end(), entry, closer), entry);
+        if (best.size() > count) {
+            best.pop_back();
+        }
+        if (best.size() == count) {
+            max = best.back().first;
+        }
+    };
+
+    EditDistance distance(name);
+    std::vector<EditDistance::Column> columns;
+    // Visit the lengths nearest to that of name first, so max shrinks early
+    for (std::size_t delta = 0; delta <= max; ++delta) {
+        for (int side = 0; side < 2; ++side) {
+            if ((side == 0 && delta > name.length()) || (side == 1 && delta == 0)) {
+                continue;
+            }
+            std::size_t length = (side == 0 ? name.length() - delta : name.length() + delta);
+            if (length >= m_lengths.size()) {
+                continue;
+            }
+            const LengthBucket& bucket = m_lengths[length];
+            if (!distance.bit_parallel()) {
+                for (std::size_t i = 0; i < bucket.names.size(); ++i) {
+                    offer(distance(bucket.chars.data() + i * length, length, max), bucket.names[i]);
+                }
+                continue;
+            }
+
+            // Column j is for the first j characters of the previous name,
+            // valid up to column computed
+            columns.assign(length + 1, distance.start());
+            std::size_t computed = 0;
+            const char* previous = nullptr;
+            for (std::size_t i = 0; i < bucket.names.size(); ++i) {
+                const char* text = bucket.chars.data() + i * length;
+                std::size_t j = 0;
+                while (previous != nullptr && j < computed && text[j] == previous[j]) {
+                    ++j;
+                }
+                bool pruned = false;
+                for (; j < length; ++j) {
+                    columns[j + 1] = columns[j];
+                    distance.step(columns[j + 1], text[j]);
+                    if (distance.lower_bound(columns[j + 1], j + 1, length) > max) {
+                        pruned = true;
+                        break;
+                    }
+                }
+                previous = text;
+                if (pruned) {
+                    // No name with this prefix is close enough
+                    computed = j + 1;
+                    while (i + 1 < bucket.names.size() && std::equal(text, text + computed, text + length)) {
+                        ++i;
+                        text += length;
+                    }
+                    continue;
+                }
+                computed = length;
+                offer(columns[length].score, bucket.names[i]);
+            }
+        }
+    }
+    for (const Candidate& entry: best) {
+        suggestions.push_back(*entry.second);
+    }
+}
+
+inline void ArgumentIndex::complete(const std::string& prefix, std::vector<const std::string*>& names) const {
+    if (m_sorted.empty()) {
+        m_sorted.reserve(m_names.size());
+        for (auto const& entry: m_names) {
+            m_sorted.push_back(&entry.first);
+        }
+        std::sort(m_sorted.begin(), m_sorted.end(), [](const std::string* a, const std::string* b) {
+            return *a < *b;
+        });
+    }
+    auto it = std::lower_bound(m_sorted.begin(), m_sorted.end(), prefix, [](const std::string* a, const std::string& b) {
+        return *a < b;
+    });
+    for (; it != m_sorted.end() && (*it)->compare(0, prefix.length(), prefix) == 0; ++it) {
+        names.push_back(*it);
+    }
+}
+
+inline std::string ArgumentIndex::flags() const {
+    std::string flags;
+    for (auto const& entry: m_flags) {
+        flags += entry.first;
+    }
+    std::sort(flags.begin(), flags.end());
+    return flags;
+}
+
+template<typename C>
+inline const FrozenArgument* ArgumentIndex::find_pattern(const std::string& name, C canSet) const {
+    for (std::size_t length: m_prefixLengths) {
+        if (length > name.length()) {
+            continue;
+        }
+        auto it = m_patterns.find(name.substr(0, length));
+        if (it == m_patterns.end()) {
+            continue;
+        }
+        const FrozenArgument* found = nullptr;
+        for (std::size_t i: it->second) {
+            const FrozenArgument& entry = m_entries[i];
+            if (entry.arg->matches_pattern(name)) {
+                found = &entry;
+                if (canSet(entry)) {
+                    break;
+                }
+            }
+        }
+        if (found != nullptr) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+template<typename C>
+inline const FrozenArgument* ArgumentIndex::select(const std::vector<std::size_t>& candidates, C canSet) const {
+    for (std::size_t i: candidates) {
+        if (canSet(m_entries[i])) {
+            return &m_entries[i];
+        }
+    }
+    return candidates.empty() ? nullptr : &m_entries[candidates.back()];
+}
+
+inline void ArgumentIndex::insert(std::vector<std::size_t>& candidates, bool allowDuplicates, const std::string& alias) const {
+    std::size_t last = m_entries.size() - 1;
+    for (std::size_t i: candidates) {
+        if (m_entries[i].arg->key() == m_entries[last].arg->key()) {
+            return;
+        }
+    }
+    if (!allowDuplicates && !candidates.empty()) {
+        throw std::logic_error("Duplicate argument " + alias);
+    }
+    candidates.push_back(last);
+}
+
+}
+
+}
@@ -0,0 +1,309 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Set a switch field, inverting it like SwitchArgument.
+ * @param value Ignored, nullptr
+ * @param storage Field to set
+ * @return True
+ */
+inline bool setField(const std::string*, bool& storage) {
+    storage = !storage;
+    return true;
+}
+
+/**
+ * Set a field with a value, see setValue().
+ * @param value Value to set
+ * @param storage Field to set
+ * @return False if the value cannot be converted
+ */
+template<typename T>
+inline bool setField(const std::string* value, T& storage) {
+    return setValue(*value, storage);
+}
+
+}
+
+template<typename C, typename Syntax>
+constexpr std::size_t Binding<C, Syntax>::npos;
+
+/**
+ * Handler for detail::scan() that sets the fields of an object, stopping at
+ * the first error.
+ */
+template<typename C, typename Syntax>
+class Binding<C, Syntax>::Handler {
+public:
+    /** Entries found by the handler */
+    using Entry = Field;
+
+private:
+    /** Binding being parsed with */
+    Binding& m_binding;
+    /** Object to set the fields of */
+    C& m_object;
+    /** Field found last, involved in errors */
+    std::size_t m_last = npos;
+
+    /**
+     * Returns the field at the given position, or nullptr for npos.
+     */
+    const Field* found(std::size_t index) {
+        m_last = index;
+        return index == npos ? nullptr : &m_binding.m_fields[index];
+    }
+
+    /**
+     * Returns the position of the given field.
+     */
+    std::size_t index(const Field& field) const {
+        return static_cast<std::size_t>(&field - m_binding.m_fields.data());
+    }
+
+public:
+    /**
+     * Create a handler setting the fields of object.
+     * @param binding Binding being parsed with
+     * @param object Object to set the fields of
+     */
+    Handler(Binding& binding, C& object) : m_binding(binding), m_object(object) {
+    }
+
+    /** Find a positional field, the first that can still be set */
+    const Field* find() {
+        std::size_t result = npos;
+        for (std::size_t index: m_binding.m_positional) {
+            result = index;
+            const Field& field = m_binding.m_fields[index];
+            if (field.max == 0u || m_binding.m_counts[index] < field.max) {
+                break;
+            }
+        }
+        return found(result);
+    }
+
+    /** Find a field by flag */
+    const Field* find(char flag) {
+        auto it = m_binding.m_flags.find(flag);
+        return found(it == m_binding.m_flags.end() ? npos : it->second);
+    }
+
+    /** Find a field by name */
+    const Field* find(const std::string& name) {
+        auto it = m_binding.m_names.find(name);
+        return found(it == m_binding.m_names.end() ? npos : it->second);
+    }
+
+    /** Count an occurrence, failing if the field occurs too often */
+    ParseResult occur(const Field& field) {
+        unsigned int& count = m_binding.m_counts[index(field)];
+        if (field.max != 0u && count >= field.max) {
+            return ParseResult(ParseError::CountMismatch);
+        }
+        ++count;
+        return ParseResult();
+    }
+
+    /** Fields have no argument, see Binding::failed() */
+    const Argument* argument(const Field&) const {
+        return nullptr;
+    }
+
+    /** Set a switch */
+    void set(const Field& field) {
+        field.set(m_object, field, nullptr);
+    }
+
+    /** Set a field with value, false if it cannot be converted */
+    bool set(const Field& field, const std::string& value) {
+        return field.set(m_object, field, &value);
+    }
+
+    /** Fields perform no actions */
+    int action(const Field&) const {
+        return 0;
+    }
+
+    /** Stop at the first error, remembering the field involved */
+    bool report(const ParseResult& result) {
+        m_binding.m_failed = (result.error() == ParseError::UnknownArgument) ? npos : m_last;
+        return false;
+    }
+};
+
+template<typename C, typename Syntax>
+template<typename T>
+inline bool Binding<C, Syntax>::set_member(C& object, const Field& field, const std::string* value) {
+    T C::* member;
+    std::memcpy(&member, field.member, sizeof(member));
+    return detail::setField(value, object.*member);
+}
+
+template<typename C, typename Syntax>
+template<typename T>
+inline Binding<C, Syntax>& Binding<C, Syntax>::add_field(T C::* member, const detail::FieldArgument<Argument>& arg) {
+    static_assert(sizeof(member) == sizeof(Field::member), "Unsupported member pointer");
+    static_assert(!detail::IsBoolVector<T>::value, "Fields of type std::vector<bool> cannot be bound");
+    const bool takesValue = !std::is_same<T, bool>::value;
+    if (!takesValue && arg.positional()) {
+        throw std::logic_error("Cannot bind a switch to a positional argument");
+    }
+    Field field{arg.description(), arg.flags(), arg.names(), arg.positional(), takesValue, false,
+        detail::IsMultiField<T>::value ? 0u : 1u, &set_member<T>, {}};
+    std::memcpy(field.member, &member, sizeof(member));
+    m_fields.push_back(std::move(field));
+    m_frozen = false;
+    m_describedValid = false;
+    return *this;
+}
+
+template<typename C, typename Syntax>
+inline Binding<C, Syntax>& Binding<C, Syntax>::freeze() {
+    m_flags.clear();
+    m_names.clear();
+    m_positional.clear();
+    for (std::size_t i = 0; i < m_fields.size(); ++i) {
+        const Field& field = m_fields[i];
+        for (char flag: field.flags) {
+            if (!m_flags.emplace(flag, i).second) {
+                throw std::logic_error(std::string("Flag bound twice: ") + Syntax::flagStart() + flag);
+            }
+        }
+        for (const std::string& name: field.names) {
+            if (!m_names.emplace(name, i).second) {
+                throw std::logic_error("Name bound twice: " + std::string(Syntax::nameStart()) + name);
+            }
+        }
+        if (field.positional) {
+            m_positional.push_back(i);
+        }
+    }
+    m_frozen = true;
+    return *this;
+}
+
+template<typename C, typename Syntax>
+inline void Binding<C, Syntax>::parse(int argc, const char* const argv[], C& object) {
+    ParseResult result = try_parse(argc, argv, object);
+    if (!result) {
+        raise(result, argc, argv);
+    }
+}
+
+template<typename C, typename Syntax>
+inline ParseResult Binding<C, Syntax>::try_parse(int argc, const char* const argv[], C& object) {
+    if (m_programName.length() == 0) {
+        m_programName = argv[0];
+        m_describedValid = false;
+    }
+    if (!m_frozen) {
+        freeze();
+    }
+    const std::size_t count = argc > 0 ? static_cast<std::size_t>(argc) : 1u;
+    m_counts.assign(m_fields.size(), 0u);
+    m_failed = npos;
+
+    Handler handler(*this, object);
+    ParseResult result = detail::scan<Syntax>(argv, count, handler);
+    if (!result) {
+        return result;
+    }
+    for (std::size_t i = 0; i < m_fields.size(); ++i) {
+        if (m_fields[i].required && m_counts[i] == 0u) {
+            m_failed = i;
+            return ParseResult(ParseError::CountMismatch).at(count);
+        }
+    }
+    return result.at(count);
+}
+
+template<typename C, typename Syntax>
+inline void Binding<C, Syntax>::raise(const ParseResult& result, int argc, const char* const argv[]) const {
+    if (result.error() == ParseError::None) {
+        return;
+    }
+    // Exceptions show fields with the markers of the syntax
+    detail::MarkerScope scope(Markers::of<Syntax>());
+    if (result.error() == ParseError::UnknownArgument) {
+        if (result.flag() != '\0') {
+            throw unknown_argument(result.flag());
+        } else if (result.offset() > 0) {
+            const char* name = argv[result.index()] + result.offset();
+            const char* delim = detail::find_delim(name, Syntax::nameDelim());
+            std::string unknown = (delim == nullptr ? std::string(name) : std::string(name, delim));
+            throw unknown_argument(unknown, describe().suggest(unknown));
+        }
+        throw unknown_argument();
+    }
+    if (m_failed == npos) {
+        throw std::logic_error("No field involved in the error");
+    }
+
+    const Field& field = m_fields[m_failed];
+    argument_error::Handle arg;
+    if (field.takesValue) {
+        arg = std::make_shared< const detail::FieldArgument< ValueArgument<std::string> > >(field);
+    } else {
+        arg = std::make_shared< const detail::FieldArgument<Argument> >(field);
+    }
+    switch (result.error()) {
+    case ParseError::MissingValue:
+        throw argument_missing_value(std::move(arg), result.index());
+    case ParseError::NoValue:
+        throw argument_no_value(std::move(arg), result.index());
+    case ParseError::InvalidValue:
+        throw argument_invalid_value(std::move(arg), argv[result.index()] + result.offset(), result.index());
+    case ParseError::CountMismatch:
+        if (result.index() < static_cast<std::size_t>(argc)) {
+            throw argument_count_mismatch(std::move(arg), m_counts[m_failed] + 1u, field.max, result.index());
+        }
+        throw argument_count_mismatch(std::move(arg), 0u, 1u, result.index());
+    default:
+        throw std::logic_error("Unexpected error for a field");
+    }
+}
+
+template<typename C, typename Syntax>
+inline BasicArgumentParser<Syntax>& Binding<C, Syntax>::describe() const {
+    if (m_describedValid) {
+        return m_described;
+    }
+    m_described = BasicArgumentParser<Syntax>();
+    m_described.program_name(m_programName);
+    m_described.reserve(m_fields.size());
+    for (const Field& field: m_fields) {
+        if (field.takesValue) {
+            m_described.add(static_cast<const ValueArgument<std::string>&>(detail::FieldArgument< ValueArgument<std::string> >(field)));
+        } else {
+            m_described.add(static_cast<const Argument&>(detail::FieldArgument<Argument>(field)));
+        }
+    }
+    m_describedValid = true;
+    return m_described;
+}
+
+}
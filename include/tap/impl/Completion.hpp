@@ -0,0 +1,95 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cctype>
+
+namespace TAP {
+
+template<typename Syntax>
+inline std::string completion_script(Shell shell, const std::string& program) {
+    // Name of the shell function, derived from the program name
+    std::string function = "_tap_complete_";
+    for (char c: program) {
+        function += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    const std::string request = std::string(Syntax::nameStart()) + completeName;
+    const std::string delim(1, Syntax::nameDelim());
+
+    switch (shell) {
+    case Shell::Bash:
+        // Words are split again from the line, as bash splits at the name
+        // delimiter, and the part before it is removed from the candidates
+        return function + "() {\n"
+            "    local line=\"${COMP_LINE:0:COMP_POINT}\"\n"
+            "    local -a words\n"
+            "    read -r -a words <<< \"$line\"\n"
+            "    [[ \"$line\" =~ [[:space:]]$ ]] && words+=(\"\")\n"
+            "    local cur=\"${words[${#words[@]}-1]}\" strip=\"\"\n" +
+            (Syntax::nameDelim() == '\0' ? std::string() :
+            "    [[ \"$cur\" == *" + delim + "* && \"$COMP_WORDBREAKS\" == *" + delim + "* ]] && strip=\"${cur%%" + delim + "*}" + delim + "\"\n") +
+            "    local IFS=$'\\n' candidate\n"
+            "    COMPREPLY=()\n"
+            "    for candidate in $(\"${words[0]}\" " + request + " \"$(( ${#words[@]} - 1 ))\" \"${words[@]}\" 2>/dev/null); do\n"
+            "        if [[ \"$candidate\" == \"" + completeFiles + "\" ]]; then\n"
+            "            COMPREPLY+=($(compgen -f -- \"${cur#\"$strip\"}\"))\n"
+            "        else\n"
+            "            COMPREPLY+=(\"${candidate#\"$strip\"}\")\n"
+            "        fi\n"
+            "    done\n"
+            "}\n"
+            "complete -F " + function + " " + program + "\n";
+    case Shell::Zsh:
+        return "#compdef " + program + "\n" +
+            function + "() {\n"
+            "    local -a candidates\n"
+            "    local candidate files=0\n"
+            "    for candidate in \"${(@f)$(\"${words[1]}\" " + request + " \"$(( CURRENT - 1 ))\" \"${(@)words[1,CURRENT]}\" 2>/dev/null)}\"; do\n"
+            "        if [[ \"$candidate\" == \"" + completeFiles + "\" ]]; then\n"
+            "            files=1\n"
+            "        elif [[ -n \"$candidate\" ]]; then\n"
+            "            candidates+=(\"$candidate\")\n"
+            "        fi\n"
+            "    done\n"
+            "    compadd -- \"${candidates[@]}\"\n"
+            "    (( files )) && _files\n"
+            "}\n"
+            "compdef " + function + " " + program + "\n";
+    case Shell::Fish:
+        return "function " + function + "\n"
+            "    set -l words (commandline -opc)\n"
+            "    set -l current (commandline -ct)\n"
+            "    set -a words \"$current\"\n"
+            "    for candidate in ($words[1] " + request + " (math (count $words) - 1) $words 2>/dev/null)\n"
+            "        if test \"$candidate\" = \"" + completeFiles + "\"\n"
+            "            __fish_complete_path (commandline -ct)\n"
+            "        else\n"
+            "            echo $candidate\n"
+            "        end\n"
+            "    end\n"
+            "end\n"
+            "complete -c " + program + " -f -a '(" + function + ")'\n";
+    default:
+        throw std::logic_error("Unknown shell");
+    }
+}
+
+}
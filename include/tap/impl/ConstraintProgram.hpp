@@ -0,0 +1,367 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Returns the number of bits set in the given word.
+ */
+inline unsigned int popcount(std::uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<unsigned int>((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+inline bool BitSet::none() const {
+    for (std::uint64_t word: m_words) {
+        if (word != 0u) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool BitSet::intersects(const BitSet& other) const {
+    std::size_t n = std::min(m_words.size(), other.m_words.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        if ((m_words[i] & other.m_words[i]) != 0u) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool BitSet::exceeds(const BitSet& other) const {
+    for (std::size_t i = 0; i < m_words.size(); ++i) {
+        std::uint64_t otherWord = (i < other.m_words.size() ? other.m_words[i] : 0u);
+        if ((m_words[i] & ~otherWord) != 0u) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline unsigned int BitSet::count_common(const BitSet& other) const {
+    unsigned int count = 0;
+    std::size_t n = std::min(m_words.size(), other.m_words.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        count += popcount(m_words[i] & other.m_words[i]);
+    }
+    return count;
+}
+
+inline BitSet& BitSet::operator|=(const BitSet& other) {
+    if (other.m_words.size() > m_words.size()) {
+        m_words.resize(other.m_words.size(), 0u);
+    }
+    for (std::size_t i = 0; i < other.m_words.size(); ++i) {
+        m_words[i] |= other.m_words[i];
+    }
+    return *this;
+}
+
+inline void ConstraintProgram::clear() {
+    m_args.clear();
+    m_index.clear();
+    m_ops.clear();
+    m_postOrder.clear();
+    m_bounded.clear();
+}
+
+inline std::size_t ConstraintProgram::add(const Argument& arg) {
+    auto inserted = m_index.emplace(arg.key(), m_args.size());
+    if (inserted.second) {
+        m_args.push_back(&arg);
+    }
+    return inserted.first->second;
+}
+
+inline void ConstraintProgram::add_root(const BaseArgument& root) {
+    std::size_t first = m_ops.size();
+    std::size_t index;
+    root.compile(*this, npos, index);
+
+    // Index the new operations that can fail by setting an argument
+    m_bounded.resize(m_args.size());
+    for (std::size_t i = first; i < m_ops.size(); ++i) {
+        const ConstraintOp& op = m_ops[i];
+        if (op.type != ConstraintType::One && op.type != ConstraintType::AtMostOne &&
+                op.type != ConstraintType::Exactly) {
+            continue;
+        }
+        for (std::size_t w = 0; w < op.mask.words(); ++w) {
+            for (std::size_t b = 0; b < BitSet::wordBits; ++b) {
+                if ((op.mask.data()[w] >> b) & 1u) {
+                    m_bounded[w * BitSet::wordBits + b].push_back(i);
+                }
+            }
+        }
+    }
+}
+
+inline std::size_t ConstraintProgram::add_op(ConstraintType type, unsigned int bound, bool required, std::size_t parent, const BaseArgument& source) {
+    m_ops.emplace_back();
+    ConstraintOp& op = m_ops.back();
+    op.type = type;
+    op.bound = bound;
+    op.size = 0;
+    op.required = required;
+    op.parent = parent;
+    op.source = &source;
+    return m_ops.size() - 1;
+}
+
+inline std::size_t ConstraintProgram::index(const Argument& arg) const {
+    auto it = m_index.find(arg.key());
+    if (it == m_index.end()) {
+        return npos;
+    }
+    return it->second;
+}
+
+inline void ConstraintProgram::state(BitSet& set) const {
+    set.assign(m_args.size());
+    for (std::size_t i = 0; i < m_args.size(); ++i) {
+        if (m_args[i]->is_set()) {
+            set.set(i);
+        }
+    }
+}
+
+inline bool ConstraintProgram::active(const ConstraintOp& op, const BitSet& set, bool parentActive) const {
+    if (op.parent == npos) {
+        // Roots are always checked
+        return true;
+    }
+    if (!parentActive) {
+        return false;
+    }
+    // Sub-constraints are checked if set, or if required by an Any parent
+    return op.mask.intersects(set) ||
+            (op.required && m_ops[op.parent].type == ConstraintType::Any);
+}
+
+inline bool ConstraintProgram::satisfied(const ConstraintOp& op, const BitSet& set) const {
+    switch (op.type) {
+    case ConstraintType::Imp: {
+        bool seen = false;
+        for (const BitSet& group: op.groups) {
+            bool groupSet = group.intersects(set);
+            if (seen && !groupSet) {
+                return false;
+            }
+            seen = seen || groupSet;
+        }
+        return true;
+    }
+    case ConstraintType::Any:
+        if (op.requiredSingles.exceeds(set)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < op.groups.size(); ++i) {
+            if (op.requiredGroups[i] && !op.groups[i].intersects(set)) {
+                return false;
+            }
+        }
+        return true;
+    default:
+        return constraint_accepts(op.type, count(op, set), op.size, op.bound);
+    }
+}
+
+inline unsigned int ConstraintProgram::count(const ConstraintOp& op, const BitSet& set) const {
+    unsigned int count = op.singles.count_common(set);
+    for (const BitSet& group: op.groups) {
+        if (group.intersects(set)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+inline std::size_t ConstraintProgram::check(const BitSet& set) const {
+    std::vector<unsigned char> isActive;
+    return check(set, isActive);
+}
+
+inline std::size_t ConstraintProgram::check(const BitSet& set, std::vector<unsigned char>& isActive) const {
+    isActive.assign(m_ops.size(), 0u);
+    for (std::size_t i = 0; i < m_ops.size(); ++i) {
+        const ConstraintOp& op = m_ops[i];
+        isActive[i] = active(op, set, op.parent != npos && isActive[op.parent]);
+        if (isActive[i] && !satisfied(op, set)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+inline void ConstraintProgram::check_all(const BitSet& set, std::vector<unsigned char>& isActive, std::vector<std::size_t>& failed) const {
+    isActive.assign(m_ops.size(), 0u);
+    for (std::size_t i = 0; i < m_ops.size(); ++i) {
+        const ConstraintOp& op = m_ops[i];
+        isActive[i] = active(op, set, op.parent != npos && isActive[op.parent]);
+        if (isActive[i] && !satisfied(op, set)) {
+            failed.push_back(i);
+        }
+    }
+}
+
+inline void ConstraintProgram::check(const std::vector<BitSet>& sets, std::vector<std::size_t>& failed) const {
+    failed.assign(sets.size(), static_cast<std::size_t>(npos));
+    // Activity per result for the parent chain of the current operation
+    std::vector<unsigned char> isActive(m_ops.size() * sets.size());
+    for (std::size_t i = 0; i < m_ops.size(); ++i) {
+        const ConstraintOp& op = m_ops[i];
+        unsigned char* opActive = &isActive[i * sets.size()];
+        const unsigned char* parentActive = (op.parent != npos ? &isActive[op.parent * sets.size()] : nullptr);
+        for (std::size_t r = 0; r < sets.size(); ++r) {
+            if (failed[r] != npos) {
+                continue;
+            }
+            opActive[r] = active(op, sets[r], parentActive != nullptr && parentActive[r]);
+            if (opActive[r] && !satisfied(op, sets[r])) {
+                failed[r] = i;
+            }
+        }
+    }
+}
+
+inline void ConstraintProgram::check_set(std::size_t index, BitSet& set) const {
+    ParseResult result = try_set(index, set);
+    if (!result) {
+        raise_set(result);
+    }
+}
+
+inline ParseResult ConstraintProgram::try_set(std::size_t index, BitSet& set) const {
+    const Argument& arg = *m_args[index];
+    unsigned int count = arg.count();
+    if (arg.max() != 0u && count >= arg.max()) {
+        return ParseResult(ParseError::CountMismatch, &arg);
+    }
+    if (set.test(index)) {
+        // Number of set arguments does not change
+        return ParseResult();
+    }
+    set.set(index);
+
+    for (std::size_t i: m_bounded[index]) {
+        const ConstraintOp& op = m_ops[i];
+        unsigned int limit = (op.type == ConstraintType::Exactly ? op.bound : 1u);
+        if (this->count(op, set) > limit) {
+            set.reset(index);
+            return ParseResult(ParseError::ConstraintViolated, &arg, op.source);
+        }
+    }
+    return ParseResult();
+}
+
+inline void ConstraintProgram::raise_set(const ParseResult& result) const {
+    const Argument& arg = *result.argument();
+    if (result.error() == ParseError::CountMismatch) {
+        throw argument_count_mismatch(arg, arg.count() + 1u, arg.max());
+    }
+    // Error path only, find the operation that failed
+    for (const ConstraintOp& op: m_ops) {
+        if (op.source == result.constraint()) {
+            throw constraint_error(constraint_reason(op.type, op.bound), std::vector<const BaseArgument*>{op.source});
+        }
+    }
+    throw std::logic_error("Unknown constraint in parse result");
+}
+
+inline void ConstraintProgram::check_valid() const {
+    BitSet set(m_args.size());
+    for (std::size_t i = 0; i < m_args.size(); ++i) {
+        const Argument& arg = *m_args[i];
+        unsigned int count = arg.count();
+        if (count == 0u) {
+            continue;
+        }
+        set.set(i);
+        if (count < arg.min() || (arg.max() != 0u && count > arg.max())) {
+            arg.check_valid();
+        }
+    }
+
+    std::vector<unsigned char> isActive;
+    std::size_t failed = check(set, isActive);
+    if (failed != npos) {
+        // Let the constraint itself describe the problem
+        m_ops[failed].source->check_valid();
+        throw constraint_error("Constraint not satisfied: ", std::vector<const BaseArgument*>{m_ops[failed].source});
+    }
+
+    // Evaluate nested constraints before the constraints containing them
+    for (std::size_t i: m_postOrder) {
+        if (!isActive[i]) {
+            continue;
+        }
+        for (auto const& predicate: m_ops[i].predicates) {
+            predicate->check();
+        }
+    }
+}
+
+inline ParseResult ConstraintProgram::try_valid(BitSet& set, std::vector<unsigned char>& isActive) const {
+    set.assign(m_args.size());
+    for (std::size_t i = 0; i < m_args.size(); ++i) {
+        const Argument& arg = *m_args[i];
+        unsigned int count = arg.count();
+        if (count == 0u) {
+            continue;
+        }
+        set.set(i);
+        if (count < arg.min() || (arg.max() != 0u && count > arg.max())) {
+            return ParseResult(ParseError::CountMismatch, &arg);
+        }
+    }
+
+    std::size_t failed = check(set, isActive);
+    if (failed != npos) {
+        return ParseResult(ParseError::ConstraintViolated, nullptr, m_ops[failed].source);
+    }
+
+    for (std::size_t i: m_postOrder) {
+        if (!isActive[i]) {
+            continue;
+        }
+        for (auto const& predicate: m_ops[i].predicates) {
+            if (!predicate->holds()) {
+                return ParseResult::predicate_failed(predicate.get(), m_ops[i].source);
+            }
+        }
+    }
+    return ParseResult();
+}
+
+}
+
+}
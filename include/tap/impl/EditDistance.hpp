@@ -0,0 +1,127 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace TAP {
+
+namespace detail {
+
+inline EditDistance::EditDistance(std::string pattern) :
+    m_peq(), m_pattern(std::move(pattern)), m_mask(0) {
+    if (!bit_parallel()) {
+        return;
+    }
+    for (std::size_t i = 0; i < m_pattern.length(); ++i) {
+        m_peq[static_cast<unsigned char>(m_pattern[i])] |= std::uint64_t(1) << i;
+    }
+    m_mask = (m_pattern.length() == maxWordLength ? ~std::uint64_t(0) :
+            (std::uint64_t(1) << m_pattern.length()) - 1u);
+}
+
+inline std::size_t EditDistance::operator()(const char* text, std::size_t length, std::size_t max) const {
+    const std::size_t m = m_pattern.length();
+    // The distance is at least the difference in length
+    if ((m > length ? m - length : length - m) > max) {
+        return max + 1;
+    }
+    if (m == 0) {
+        return length;
+    }
+    if (!bit_parallel()) {
+        return dynamic(text, length, max);
+    }
+
+    Column column = start();
+    for (std::size_t j = 0; j < length; ++j) {
+        step(column, text[j]);
+        if (lower_bound(column, j + 1, length) > max) {
+            return max + 1;
+        }
+    }
+    return column.score;
+}
+
+inline void EditDistance::step(Column& column, char c) const {
+    if (m_pattern.empty()) {
+        ++column.score;
+        return;
+    }
+    const std::uint64_t last = std::uint64_t(1) << (m_pattern.length() - 1);
+    const std::uint64_t eq = m_peq[static_cast<unsigned char>(c)];
+    const std::uint64_t xv = eq | column.mv;
+    const std::uint64_t xh = (((eq & column.pv) + column.pv) ^ column.pv) | eq;
+    std::uint64_t ph = column.mv | ~(xh | column.pv);
+    std::uint64_t mh = column.pv & xh;
+    if (ph & last) {
+        ++column.score;
+    } else if (mh & last) {
+        --column.score;
+    }
+    // The first row of the matrix increases by one per column
+    ph = (ph << 1) | 1u;
+    mh <<= 1;
+    column.pv = mh | ~(xv | ph);
+    column.mv = ph & xv;
+}
+
+inline std::size_t EditDistance::lower_bound(const Column& column, std::size_t prefix, std::size_t length) const {
+    const std::size_t m = m_pattern.length();
+    if (prefix + m < length) {
+        // Diagonal starts in the first row after this column
+        return 0;
+    }
+    // Row of the diagonal in this column, its value is the last row minus
+    // the vertical deltas below it
+    const std::size_t row = prefix + m - length;
+    const std::uint64_t below = (row >= maxWordLength ? 0u : m_mask & ~((std::uint64_t(1) << row) - 1u));
+    return column.score + popcount(column.mv & below) - popcount(column.pv & below);
+}
+
+inline std::size_t EditDistance::dynamic(const char* text, std::size_t length, std::size_t max) const {
+    const std::size_t m = m_pattern.length();
+    std::vector<std::size_t> row(m + 1);
+    for (std::size_t i = 0; i <= m; ++i) {
+        row[i] = i;
+    }
+    for (std::size_t j = 0; j < length; ++j) {
+        std::size_t diagonal = row[0];
+        row[0] = j + 1;
+        std::size_t best = row[0];
+        for (std::size_t i = 1; i <= m; ++i) {
+            std::size_t above = row[i];
+            row[i] = std::min(std::min(row[i] + 1, row[i - 1] + 1),
+                    diagonal + (m_pattern[i - 1] == text[j] ? 0u : 1u));
+            diagonal = above;
+            best = std::min(best, row[i]);
+        }
+        if (best > max) {
+            return max + 1;
+        }
+    }
+    return row[m];
+}
+
+}
+
+}
@@ -0,0 +1,320 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+namespace TAP {
+
+namespace embedded {
+
+inline const char* error_string(Error error) {
+    switch (error) {
+    case Error::None:
+        return "No error";
+    case Error::UnknownArgument:
+        return "Unknown argument";
+    case Error::MissingValue:
+        return "Argument requires a value";
+    case Error::NoValue:
+        return "Argument does not take a value";
+    case Error::InvalidValue:
+        return "Invalid value for argument";
+    case Error::TooManyOccurrences:
+        return "Argument set too many times";
+    case Error::MissingRequired:
+        return "Required argument missing";
+    case Error::CapacityExceeded:
+        return "Capacity exceeded";
+    case Error::Conflict:
+        return "Conflicting arguments set";
+    default:
+        return "Unknown error";
+    }
+}
+
+inline Error Argument::set() {
+    if (!can_set()) {
+        return Error::TooManyOccurrences;
+    }
+    ++m_count;
+    return Error::None;
+}
+
+inline Error Argument::set(const char* value) {
+    if (!can_set()) {
+        return Error::TooManyOccurrences;
+    }
+    Error error = m_setValue(*this, value);
+    if (error == Error::None) {
+        ++m_count;
+    }
+    return error;
+}
+
+template<typename T>
+inline Error ValueArgument<T>::set_value(Argument& arg, const char* value) {
+    ValueArgument& self = static_cast<ValueArgument&>(arg);
+    return detail::convert(value, self.m_value) ? Error::None : Error::InvalidValue;
+}
+
+template<typename T, std::size_t N>
+inline Error MultiValueArgument<T, N>::set_value(Argument& arg, const char* value) {
+    MultiValueArgument& self = static_cast<MultiValueArgument&>(arg);
+    if (self.m_values.full()) {
+        return Error::CapacityExceeded;
+    }
+    T local = T();
+    if (!detail::convert(value, local)) {
+        return Error::InvalidValue;
+    }
+    self.m_values.push_back(local);
+    return Error::None;
+}
+
+namespace detail {
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+convert(const char* value, T& storage) {
+    char* end;
+    errno = 0;
+    long long result = std::strtoll(value, &end, 0);
+    if (end == value || *end != '\0' || errno == ERANGE ||
+            result < std::numeric_limits<T>::min() || result > std::numeric_limits<T>::max()) {
+        return false;
+    }
+    storage = static_cast<T>(result);
+    return true;
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, bool>::type
+convert(const char* value, T& storage) {
+    // strtoull silently negates negative numbers
+    const char* start = value;
+    while (*start == ' ' || *start == '\t') {
+        ++start;
+    }
+    if (*start == '-') {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    unsigned long long result = std::strtoull(value, &end, 0);
+    if (end == value || *end != '\0' || errno == ERANGE || result > std::numeric_limits<T>::max()) {
+        return false;
+    }
+    storage = static_cast<T>(result);
+    return true;
+}
+
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+convert(const char* value, T& storage) {
+    char* end;
+    errno = 0;
+    long double result = std::strtold(value, &end);
+    if (end == value || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    storage = static_cast<T>(result);
+    return true;
+}
+
+/**
+ * Find the argument to set among the candidates accepted by match: the first
+ * one that can be set, or the last one that matches.
+ * @param args Arguments to search
+ * @param size Number of arguments
+ * @param match Predicate selecting the candidates
+ * @return The argument, or nullptr if none matches
+ */
+template<typename Match>
+inline Argument* find(Argument* const* args, std::size_t size, Match match) {
+    Argument* found = nullptr;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (match(*args[i])) {
+            found = args[i];
+            if (found->can_set()) {
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * Handler for scan() that sets the arguments of an embedded ArgumentParser.
+ */
+class ArgumentHandler {
+    /** Arguments to parse into */
+    Argument* const* m_args;
+    /** Number of arguments */
+    std::size_t m_size;
+
+public:
+    /** Entries found by the handler */
+    using Entry = Argument;
+
+    /**
+     * Create a handler for the given arguments.
+     * @param args Arguments to parse into
+     * @param size Number of arguments
+     */
+    ArgumentHandler(Argument* const* args, std::size_t size) : m_args(args), m_size(size) {
+    }
+
+    /** Find a positional argument */
+    Argument* find() const {
+        return detail::find(m_args, m_size, [](const Argument& candidate) {
+            return candidate.positional();
+        });
+    }
+
+    /** Find an argument by flag */
+    Argument* find(char flag) const {
+        return detail::find(m_args, m_size, [flag](const Argument& candidate) {
+            return candidate.flag() == flag;
+        });
+    }
+
+    /** Find an argument by name */
+    Argument* find(const char* name, std::size_t length) const {
+        return detail::find(m_args, m_size, [name, length](const Argument& candidate) {
+            return candidate.matches(name, length);
+        });
+    }
+
+    /** Check whether an argument takes a value */
+    bool takes_value(const Argument& entry) const {
+        return entry.takes_value();
+    }
+
+    /** Set an argument without value */
+    Error set(Argument& entry) const {
+        return entry.set();
+    }
+
+    /** Set an argument with value */
+    Error set(Argument& entry, const char* value) const {
+        return entry.set(value);
+    }
+};
+
+template<typename Syntax, typename Handler>
+inline ScanResult<typename Handler::Entry> scan(int argc, const char* const argv[], Handler& handler) {
+    using Traits = TAP::detail::SyntaxTraits<Syntax>;
+    using Entry = typename Handler::Entry;
+    bool noParse = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const std::size_t length = std::strlen(arg);
+        Entry* matched = nullptr;
+        Error error = Error::None;
+
+        if (std::strcmp(arg, Syntax::skip()) == 0) {
+            // After skip token, stop parsing
+            noParse = true;
+            continue;
+        } else if (!noParse && Traits::is_name(arg, length)) {
+            // Named argument, possibly with delimited value
+            const char* name = arg + Traits::nameStartLength;
+            const char* delim = TAP::detail::find_delim(name, Syntax::nameDelim());
+            std::size_t nameLength = (delim == nullptr) ? length - Traits::nameStartLength : static_cast<std::size_t>(delim - name);
+
+            matched = handler.find(name, nameLength);
+            if (matched == nullptr) {
+                return ScanResult<Entry>{Error::UnknownArgument, i, nullptr};
+            }
+
+            if (handler.takes_value(*matched)) {
+                if (delim != nullptr) {
+                    error = handler.set(*matched, delim + 1);
+                } else if (i + 1 < argc) {
+                    error = handler.set(*matched, argv[++i]);
+                } else {
+                    error = Error::MissingValue;
+                }
+            } else if (delim != nullptr) {
+                error = Error::NoValue;
+            } else {
+                error = handler.set(*matched);
+            }
+        } else if (!noParse && Traits::is_flag(arg, length)) {
+            // Flag arguments, the last may be followed by a value
+            for (std::size_t flagIndex = Traits::flagStartLength; flagIndex < length && error == Error::None; ++flagIndex) {
+                matched = handler.find(arg[flagIndex]);
+                if (matched == nullptr) {
+                    return ScanResult<Entry>{Error::UnknownArgument, i, nullptr};
+                }
+                if (handler.takes_value(*matched)) {
+                    ++flagIndex;
+                    if (flagIndex < length) {
+                        error = handler.set(*matched, arg + flagIndex);
+                    } else if (i + 1 < argc) {
+                        error = handler.set(*matched, argv[++i]);
+                    } else {
+                        error = Error::MissingValue;
+                    }
+                    break;
+                }
+                error = handler.set(*matched);
+            }
+        } else {
+            // Positional argument
+            matched = handler.find();
+            if (matched == nullptr) {
+                return ScanResult<Entry>{Error::UnknownArgument, i, nullptr};
+            }
+            error = handler.set(*matched, arg);
+        }
+
+        if (error != Error::None) {
+            return ScanResult<Entry>{error, i, matched};
+        }
+    }
+    return ScanResult<Entry>{Error::None, argc, nullptr};
+}
+
+inline ParseResult parse(Argument* const* args, std::size_t size, int argc, const char* const argv[]) {
+    ArgumentHandler handler(args, size);
+    ScanResult<Argument> result = scan<DefaultSyntax>(argc, argv, handler);
+    if (result.error != Error::None) {
+        return ParseResult{result.error, result.index, result.entry};
+    }
+
+    for (std::size_t i = 0; i < size; ++i) {
+        if (args[i]->required() && args[i]->count() == 0) {
+            return ParseResult{Error::MissingRequired, argc, args[i]};
+        }
+    }
+    return ParseResult{Error::None, argc, nullptr};
+}
+
+}
+
+}
+
+}
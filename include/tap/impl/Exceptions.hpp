@@ -22,14 +22,58 @@ freely, subject to the following restrictions:
 
 namespace TAP {
 
+inline void unknown_argument::format(std::string& what) const {
+    if (m_flag != '\0') {
+        what = std::string("The flag argument ") + m_flag + " is unknown";
+    } else if (!m_name.empty()) {
+        what = "The named argument " + m_name + " is unknown";
+        for (std::size_t i = 0; i < m_suggestions.size(); ++i) {
+            what += (i == 0 ? ", did you mean " : " or ");
+            what += m_nameStart;
+            what += m_suggestions[i];
+        }
+    } else {
+        what = "No positional arguments are supported";
+    }
+}
+
 inline argument_error::argument_error(const Argument& arg) :
-    exception(std::string("Argument ") + arg.usage()),
-    m_arg(new Argument(arg)) {
+    argument_error(detail::copy_argument(arg)) {
 }
 
 inline argument_error::argument_error(const Argument& arg, const std::string& reason) :
-    exception(std::string("Argument ") + arg.usage() + " " + reason),
-    m_arg(new Argument(arg)) {
+    argument_error(detail::copy_argument(arg)) {
+    m_reason = reason;
+}
+
+inline void argument_error::format(std::string& what) const {
+    detail::MarkerScope scope(m_markers);
+    what = "Argument ";
+    what += m_arg->usage();
+    reason(what);
+}
+
+inline void argument_error::reason(std::string& what) const {
+    if (!m_reason.empty()) {
+        what += ' ';
+        what += m_reason;
+    }
+}
+
+inline void argument_count_mismatch::reason(std::string& what) const {
+    if (m_count < m_expected) {
+        if (m_expected > 1) {
+            what += " is required to occur at least " + std::to_string(m_expected) + " times";
+        } else {
+            what += " is required";
+        }
+    } else {
+        if (m_expected > 1) {
+            what += " can occur at most " + std::to_string(m_expected) + " times";
+        } else {
+            what += " can only be set once";
+        }
+    }
 }
 
 inline constraint_error::constraint_error(const std::string& reason, const std::vector<const BaseArgument*>& args) : exception() {
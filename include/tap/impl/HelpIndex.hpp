@@ -0,0 +1,189 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace TAP {
+
+template<typename Syntax>
+inline HelpQuery HelpQuery::parse(const std::string& pattern) {
+    if (pattern.length() > 1 && pattern.back() == ':') {
+        return group(pattern.substr(0, pattern.length() - 1));
+    }
+    if (pattern.length() > 0 && pattern.back() == '*') {
+        std::string prefix = pattern.substr(0, pattern.length() - 1);
+        for (const char* marker: {Syntax::nameStart(), Syntax::flagStart()}) {
+            std::size_t length = std::strlen(marker);
+            if (length > 0 && prefix.compare(0, length, marker) == 0) {
+                prefix.erase(0, length);
+                break;
+            }
+        }
+        return HelpQuery::prefix(std::move(prefix));
+    }
+    return search(pattern);
+}
+
+namespace detail {
+
+inline void HelpIndex::clear() {
+    m_groups.clear();
+    m_rows.clear();
+    m_groupOf.clear();
+    m_names.clear();
+    m_texts.clear();
+    m_trigrams.clear();
+    m_finished = false;
+}
+
+inline void HelpIndex::group(std::string name, std::size_t separator, std::size_t title) {
+    m_groups.push_back(Group{std::move(name), separator, title, m_rows.size(), m_rows.size()});
+}
+
+inline void HelpIndex::entry(std::size_t row) {
+    m_rows.push_back(row);
+    m_groupOf.push_back(m_groups.size() - 1);
+    m_groups.back().last = m_rows.size();
+}
+
+inline void HelpIndex::name(std::string name) {
+    m_names.emplace_back(std::move(name), m_rows.size() - 1);
+}
+
+inline void HelpIndex::finish(const HelpLayout& layout) {
+    std::sort(m_names.begin(), m_names.end());
+
+    m_texts.clear();
+    m_texts.reserve(m_rows.size());
+    m_trigrams.clear();
+    std::vector<std::uint32_t> keys;
+    for (std::size_t entry = 0; entry < m_rows.size(); ++entry) {
+        HelpLayout::Piece row = layout.row(m_rows[entry]);
+        std::string text(row.data, row.length);
+        for (char& c: text) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        keys.clear();
+        for (std::size_t i = 0; i + 3 <= text.length(); ++i) {
+            keys.push_back(trigram(text.data() + i));
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        for (std::uint32_t key: keys) {
+            m_trigrams.emplace_back(key, entry);
+        }
+        m_texts.push_back(std::move(text));
+    }
+    std::sort(m_trigrams.begin(), m_trigrams.end());
+    m_finished = true;
+}
+
+inline void HelpIndex::rows(const HelpQuery& query, std::vector<std::size_t>& rows) const {
+    std::vector<std::size_t> entries;
+    find(query, entries);
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    std::size_t group = m_groups.size();
+    for (std::size_t entry: entries) {
+        if (m_groupOf[entry] != group) {
+            if (group != m_groups.size()) {
+                rows.push_back(m_groups[m_groupOf[entry]].separator);
+            }
+            group = m_groupOf[entry];
+            rows.push_back(m_groups[group].title);
+        }
+        rows.push_back(m_rows[entry]);
+    }
+}
+
+inline void HelpIndex::find(const HelpQuery& query, std::vector<std::size_t>& entries) const {
+    const std::string& pattern = query.pattern();
+    switch (query.kind()) {
+    case HelpQuery::Kind::Group:
+        for (const Group& group: m_groups) {
+            if (group.name == pattern) {
+                for (std::size_t entry = group.first; entry < group.last; ++entry) {
+                    entries.push_back(entry);
+                }
+            }
+        }
+        break;
+    case HelpQuery::Kind::Prefix: {
+        auto it = std::lower_bound(m_names.begin(), m_names.end(), std::make_pair(pattern, std::size_t(0)));
+        for (; it != m_names.end() && it->first.compare(0, pattern.length(), pattern) == 0; ++it) {
+            entries.push_back(it->second);
+        }
+        break;
+    }
+    case HelpQuery::Kind::Substring: {
+        std::string text(pattern);
+        for (char& c: text) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (text.length() < 3) {
+            for (std::size_t entry = 0; entry < m_texts.size(); ++entry) {
+                if (m_texts[entry].find(text) != std::string::npos) {
+                    entries.push_back(entry);
+                }
+            }
+            break;
+        }
+        // Only the entries containing the rarest trigram can match
+        typedef std::vector<std::pair<std::uint32_t, std::size_t> >::const_iterator Posting;
+        std::pair<Posting, Posting> rarest(m_trigrams.end(), m_trigrams.end());
+        std::size_t rarestSize = m_texts.size() + 1;
+        for (std::size_t i = 0; i + 3 <= text.length(); ++i) {
+            std::uint32_t key = trigram(text.data() + i);
+            std::pair<Posting, Posting> range(
+                std::lower_bound(m_trigrams.begin(), m_trigrams.end(), std::make_pair(key, std::size_t(0))),
+                std::lower_bound(m_trigrams.begin(), m_trigrams.end(), std::make_pair(key + 1u, std::size_t(0))));
+            std::size_t size = static_cast<std::size_t>(range.second - range.first);
+            if (size < rarestSize) {
+                rarest = range;
+                rarestSize = size;
+                if (size == 0) {
+                    break;
+                }
+            }
+        }
+        for (Posting it = rarest.first; it != rarest.second; ++it) {
+            if (m_texts[it->second].find(text) != std::string::npos) {
+                entries.push_back(it->second);
+            }
+        }
+        break;
+    }
+    }
+}
+
+inline std::uint32_t HelpIndex::trigram(const char* text) {
+    return (std::uint32_t(static_cast<unsigned char>(text[0])) << 16) |
+            (std::uint32_t(static_cast<unsigned char>(text[1])) << 8) |
+            std::uint32_t(static_cast<unsigned char>(text[2]));
+}
+
+}
+
+}
@@ -0,0 +1,253 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef TAP_POSIX
+#include <climits>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace TAP {
+
+inline std::size_t terminal_width(int fd) {
+#ifdef TAP_POSIX
+    struct winsize size;
+    if (isatty(fd) && ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) {
+        return size.ws_col;
+    }
+#else
+    (void)fd;
+#endif
+    const char* columns = std::getenv("COLUMNS");
+    if (columns != nullptr) {
+        char* end;
+        unsigned long width = std::strtoul(columns, &end, 10);
+        if (*end == '\0') {
+            return width;
+        }
+    }
+    return 0;
+}
+
+namespace detail {
+
+inline void HelpLayout::clear() {
+    m_pending.clear();
+    m_rows.clear();
+    m_text.clear();
+    m_valid = false;
+    m_width = 0;
+    m_pieces.clear();
+}
+
+inline std::size_t HelpLayout::line(std::string text, std::size_t hang) {
+    m_pending.push_back(Pending{std::move(text), std::string(), false, hang});
+    return m_pending.size() - 1;
+}
+
+inline std::size_t HelpLayout::entry(std::string ident, std::string description) {
+    m_pending.push_back(Pending{std::move(ident), std::move(description), true, 0});
+    return m_pending.size() - 1;
+}
+
+inline void HelpLayout::finish() {
+    std::size_t column = 0;
+    std::size_t length = 0;
+    for (const Pending& pending: m_pending) {
+        if (pending.entry) {
+            column = std::max(column, pending.text.length());
+        }
+        length += pending.text.length() + pending.description.length() + 1;
+    }
+    column += entryIndent + entryGap;
+
+    m_rows.clear();
+    m_rows.reserve(m_pending.size());
+    m_text.clear();
+    m_text.reserve(length + column * m_pending.size());
+    std::size_t maxHang = column;
+    for (const Pending& pending: m_pending) {
+        Row row;
+        row.start = m_text.length();
+        if (pending.entry) {
+            m_text.append(entryIndent, ' ');
+            m_text += pending.text;
+            m_text.append(column - entryIndent - pending.text.length(), ' ');
+            row.hang = column;
+            row.keep = m_text.length();
+            m_text += pending.description;
+        } else {
+            m_text += pending.text;
+            row.hang = std::min(pending.hang, pending.text.length());
+            row.keep = row.start + row.hang;
+            maxHang = std::max(maxHang, row.hang);
+        }
+        row.end = m_text.length();
+        m_text += '\n';
+        m_rows.push_back(row);
+    }
+    m_pending.clear();
+
+    m_indent.assign(maxHang + 1, ' ');
+    m_indent[0] = '\n';
+    m_width = 0;
+    m_pieces.clear();
+    m_valid = true;
+}
+
+inline const std::vector<HelpLayout::Piece>& HelpLayout::pieces(std::size_t width) {
+    if (m_width == width && !m_pieces.empty()) {
+        return m_pieces;
+    }
+    m_pieces.clear();
+    if (width == 0) {
+        m_pieces.push_back(Piece{m_text.data(), m_text.length()});
+    } else {
+        for (const Row& row: m_rows) {
+            wrap(row, width, m_pieces);
+        }
+    }
+    m_width = width;
+    return m_pieces;
+}
+
+inline void HelpLayout::pieces(const std::vector<std::size_t>& rows, std::size_t width, std::vector<Piece>& pieces) const {
+    for (std::size_t row: rows) {
+        wrap(m_rows[row], width, pieces);
+    }
+}
+
+inline void HelpLayout::wrap(const Row& row, std::size_t width, std::vector<Piece>& pieces) const {
+    const char* text = m_text.data();
+    const char* end = text + row.end;
+    const char* lineStart = text + row.start;
+    if (width == 0 || row.hang + minWrap > width) {
+        // Not wrapped, or too narrow to wrap sensibly, including the newline
+        pieces.push_back(Piece{lineStart, row.end - row.start + 1});
+        return;
+    }
+
+    const char* breakable = text + row.keep;
+    std::size_t indent = 0;
+    for (;;) {
+        const char* limit = lineStart + (width - indent);
+        const char* search = std::max(breakable, lineStart + 1);
+        const char* newline = std::find(search, std::min(limit, end), '\n');
+        if (newline == std::min(limit, end) && end <= limit) {
+            break;
+        }
+
+        const char* brk = newline;
+        if (brk >= limit || brk == end) {
+            // Break at the last space that fits, or the first one after
+            brk = nullptr;
+            for (const char* c = limit; c >= search; --c) {
+                if (*c == ' ') {
+                    brk = c;
+                    break;
+                }
+            }
+            if (brk == nullptr) {
+                brk = std::find_if(limit, end, [](char c) { return c == ' ' || c == '\n'; });
+            }
+        }
+
+        const char* next = brk;
+        if (next < end && *next == ' ') {
+            next = std::find_if(next, end, [](char c) { return c != ' '; });
+        } else if (next < end) {
+            ++next;
+        }
+        const char* last = brk;
+        while (last > search && last[-1] == ' ') {
+            --last;
+        }
+        pieces.push_back(Piece{lineStart, static_cast<std::size_t>(last - lineStart)});
+        if (next >= end) {
+            lineStart = end;
+            break;
+        }
+        pieces.push_back(Piece{m_indent.data(), row.hang + 1});
+        lineStart = next;
+        indent = row.hang;
+    }
+    // Remainder including the newline
+    pieces.push_back(Piece{lineStart, static_cast<std::size_t>(end - lineStart) + 1});
+}
+
+inline void write_pieces(std::ostream& out, const std::vector<HelpLayout::Piece>& pieces) {
+    for (const HelpLayout::Piece& piece: pieces) {
+        out.write(piece.data, static_cast<std::streamsize>(piece.length));
+    }
+}
+
+#ifdef TAP_POSIX
+inline bool write_pieces(int fd, const std::vector<HelpLayout::Piece>& pieces) {
+#ifdef IOV_MAX
+    constexpr std::size_t maxVectors = IOV_MAX < 256 ? IOV_MAX : 256;
+#else
+    constexpr std::size_t maxVectors = 16;
+#endif
+    struct iovec vectors[maxVectors];
+    std::size_t next = 0;
+    while (next < pieces.size()) {
+        std::size_t count = std::min(maxVectors, pieces.size() - next);
+        for (std::size_t i = 0; i < count; ++i) {
+            vectors[i].iov_base = const_cast<char*>(pieces[next + i].data);
+            vectors[i].iov_len = pieces[next + i].length;
+        }
+        next += count;
+
+        struct iovec* vector = vectors;
+        while (count > 0) {
+            ssize_t written = writev(fd, vector, static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            // Skip the vectors written completely, and adjust a partial one
+            std::size_t remaining = static_cast<std::size_t>(written);
+            while (count > 0 && remaining >= vector->iov_len) {
+                remaining -= vector->iov_len;
+                ++vector;
+                --count;
+            }
+            if (count > 0) {
+                vector->iov_base = static_cast<char*>(vector->iov_base) + remaining;
+                vector->iov_len -= remaining;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+}
+
+}
@@ -0,0 +1,103 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+template<std::size_t L>
+constexpr detail::Markup<L> markup(const char (&description)[L]) {
+    detail::Markup<L> result{};
+    // Same rules as Argument::parse_description(), marking removed characters
+    bool removed[L] = {};
+    bool escape = false;
+    bool addFlag = false;
+    bool addName = false;
+    std::size_t nameStart = 0;
+    std::size_t namesLength = 0;
+    const std::size_t size = L - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        const char c = description[i];
+        bool skip = false;
+
+        if (addFlag) {
+            result.flags[result.flagCount++] = c;
+            addFlag = false;
+            skip = true;
+        }
+
+        if (!detail::is_alnum(c) && addName) {
+            if (i != nameStart) {
+                for (std::size_t j = nameStart; j < i; ++j) {
+                    result.names[namesLength++] = description[j];
+                }
+                result.names[namesLength++] = '\0';
+                ++result.nameCount;
+            }
+            addName = false;
+        }
+
+        if (skip) {
+            continue;
+        }
+
+        switch (c) {
+            case '\\':
+                escape = !escape;
+                if (!escape) {
+                    removed[i] = true;
+                }
+                break;
+            case '%':
+            case '$':
+            case '&':
+                if (escape) {
+                    escape = false;
+                    removed[i - 1] = true;
+                } else {
+                    addFlag = (c != '$');
+                    if (c != '%') {
+                        addName = true;
+                        nameStart = i + 1;
+                    }
+                    removed[i] = true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (addName && nameStart != size) {
+        for (std::size_t j = nameStart; j < size; ++j) {
+            result.names[namesLength++] = description[j];
+        }
+        result.names[namesLength++] = '\0';
+        ++result.nameCount;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!removed[i]) {
+            result.text[result.length++] = description[i];
+        }
+    }
+    result.text[result.length] = '\0';
+    return result;
+}
+
+}
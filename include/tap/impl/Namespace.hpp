@@ -0,0 +1,157 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+namespace detail {
+
+inline void Namespace::insert(const std::string& path, std::string description, NamespaceFactory factory) {
+    Namespace* node = this;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t end = path.find(namespaceDelim, start);
+        std::string segment = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (segment.empty()) {
+            throw std::logic_error("Invalid namespace " + path);
+        }
+        auto it = node->m_children.find(segment);
+        if (it == node->m_children.end()) {
+            std::string childPath = node->m_path.empty() ? segment : node->m_path + namespaceDelim + segment;
+            it = node->m_children.emplace(segment, Namespace(std::move(childPath))).first;
+        }
+        node = &it->second;
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    node->m_description = std::move(description);
+    node->m_factory = std::move(factory);
+    node->m_loaded.reset();
+}
+
+inline const Namespace* Namespace::find_namespace(const std::string& path) const {
+    const Namespace* node = this;
+    std::size_t start = 0;
+    while (node != nullptr) {
+        std::size_t end = path.find(namespaceDelim, start);
+        auto it = node->m_children.find(path.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        node = (it == node->m_children.end()) ? nullptr : &it->second;
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return node;
+}
+
+template<typename C>
+inline const FrozenArgument* Namespace::find_if(C canSet, const std::string& name) const {
+    // Walk down the trie along the segments of the name (except the last)
+    std::vector<const Namespace*> path;
+    const Namespace* node = this;
+    std::size_t start = 0;
+    std::size_t end;
+    while ((end = name.find(namespaceDelim, start)) != std::string::npos) {
+        auto it = node->m_children.find(name.substr(start, end - start));
+        if (it == node->m_children.end()) {
+            break;
+        }
+        node = &it->second;
+        path.push_back(node);
+        start = end + 1;
+    }
+
+    // Most specific namespace first
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        if ((*it)->has_factory()) {
+            (*it)->load();
+            const FrozenArgument* entry = (*it)->m_loaded->index.find_if(canSet, name);
+            if (entry != nullptr) {
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+inline const ArgumentSet& Namespace::load() const {
+    if (m_loaded == nullptr) {
+        std::shared_ptr<Loaded> loaded = std::make_shared<Loaded>(m_path);
+        if (m_factory) {
+            m_factory(loaded->args);
+        }
+        for (const Argument* arg: loaded->args.args()) {
+            // Not part of the constraint program of the parser
+            loaded->index.add(*arg, static_cast<std::size_t>(ConstraintProgram::npos));
+            loaded->program.add(*arg);
+        }
+        loaded->program.add_root(loaded->args);
+        m_loaded = std::move(loaded);
+    }
+    return m_loaded->args;
+}
+
+inline void Namespace::check_valid() const {
+    if (m_loaded != nullptr) {
+        m_loaded->args.check_valid();
+    }
+    for (auto const& child: m_children) {
+        child.second.check_valid();
+    }
+}
+
+inline std::shared_ptr<const Argument> Namespace::share(const Argument& arg) const {
+    if (m_loaded != nullptr) {
+        std::size_t index = m_loaded->program.index(arg);
+        if (index != ConstraintProgram::npos && &m_loaded->program.argument(index) == &arg) {
+            return std::shared_ptr<const Argument>(m_loaded, &arg);
+        }
+    }
+    for (auto const& child: m_children) {
+        std::shared_ptr<const Argument> shared = child.second.share(arg);
+        if (shared != nullptr) {
+            return shared;
+        }
+    }
+    return nullptr;
+}
+
+inline ParseResult Namespace::try_valid(BitSet& set, std::vector<unsigned char>& isActive) const {
+    if (m_loaded != nullptr) {
+        ParseResult result = m_loaded->program.try_valid(set, isActive);
+        if (!result) {
+            return result;
+        }
+    }
+    for (auto const& child: m_children) {
+        ParseResult result = child.second.try_valid(set, isActive);
+        if (!result) {
+            return result;
+        }
+    }
+    return ParseResult();
+}
+
+}
+
+}
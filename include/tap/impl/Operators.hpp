@@ -22,8 +22,44 @@ freely, subject to the following restrictions:
 
 namespace TAP {
 
-inline ArgumentConstraint<ConstraintType::One> operator^(Argument& left, Argument& right) {
-    return ArgumentConstraint<ConstraintType::One>(left, right);
+namespace detail {
+
+template<ConstraintType CType>
+inline ConstraintExpr<CType> append(ConstraintExpr<CType> left, Argument& right) {
+    left += right;
+    return left;
+}
+
+template<ConstraintType CType>
+inline ConstraintExpr<CType> prepend(Argument& left, const ConstraintExpr<CType>& right) {
+    ConstraintExpr<CType> result(left);
+    result.reserve(right.size() + 1);
+    return join(std::move(result), right);
+}
+
+template<ConstraintType CType>
+inline ConstraintExpr<CType> join(ConstraintExpr<CType> left, const ConstraintExpr<CType>& right) {
+    left += right;
+    left.set_required(left.required() || right.required());
+    return left;
+}
+
+}
+
+inline detail::ConstraintExpr<ConstraintType::One> operator^(Argument& left, Argument& right) {
+    return detail::ConstraintExpr<ConstraintType::One>(left, right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::One> operator^(detail::ConstraintExpr<ConstraintType::One> left, Argument& right) {
+    return detail::append(std::move(left), right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::One> operator^(Argument& left, const detail::ConstraintExpr<ConstraintType::One>& right) {
+    return detail::prepend(left, right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::One> operator^(detail::ConstraintExpr<ConstraintType::One> left, const detail::ConstraintExpr<ConstraintType::One>& right) {
+    return detail::join(std::move(left), right);
 }
 
 inline ArgumentConstraint<ConstraintType::One> operator^(ArgumentConstraint<ConstraintType::One> left, Argument& right) {
@@ -32,11 +68,23 @@ inline ArgumentConstraint<ConstraintType::One> operator^(ArgumentConstraint<Cons
 }
 
 inline ArgumentConstraint<ConstraintType::One> operator^(Argument& left, ArgumentConstraint<ConstraintType::One>& right) {
-    return right | left;
+    return ArgumentConstraint<ConstraintType::One>(left) += right;
+}
+
+inline detail::ConstraintExpr<ConstraintType::Any> operator|(Argument& left, Argument& right) {
+    return detail::ConstraintExpr<ConstraintType::Any>(left, right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::Any> operator|(detail::ConstraintExpr<ConstraintType::Any> left, Argument& right) {
+    return detail::append(std::move(left), right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::Any> operator|(Argument& left, const detail::ConstraintExpr<ConstraintType::Any>& right) {
+    return detail::prepend(left, right);
 }
 
-inline ArgumentConstraint<ConstraintType::Any> operator|(Argument& left, Argument& right) {
-    return ArgumentConstraint<ConstraintType::Any>(left, right);
+inline detail::ConstraintExpr<ConstraintType::Any> operator|(detail::ConstraintExpr<ConstraintType::Any> left, const detail::ConstraintExpr<ConstraintType::Any>& right) {
+    return detail::join(std::move(left), right);
 }
 
 inline ArgumentConstraint<ConstraintType::Any> operator|(ArgumentConstraint<ConstraintType::Any> left, Argument& right) {
@@ -45,11 +93,23 @@ inline ArgumentConstraint<ConstraintType::Any> operator|(ArgumentConstraint<Cons
 }
 
 inline ArgumentConstraint<ConstraintType::Any> operator|(Argument& left, ArgumentConstraint<ConstraintType::Any>& right) {
-    return right | left;
+    return ArgumentConstraint<ConstraintType::Any>(left) += right;
+}
+
+inline detail::ConstraintExpr<ConstraintType::Imp> operator>(Argument& left, Argument& right) {
+    return detail::ConstraintExpr<ConstraintType::Imp>(left, right);
 }
 
-inline ArgumentConstraint<ConstraintType::Imp> operator>(Argument& left, Argument& right) {
-    return ArgumentConstraint<ConstraintType::Imp>(left, right);
+inline detail::ConstraintExpr<ConstraintType::Imp> operator>(detail::ConstraintExpr<ConstraintType::Imp> left, Argument& right) {
+    return detail::append(std::move(left), right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::Imp> operator>(Argument& left, const detail::ConstraintExpr<ConstraintType::Imp>& right) {
+    return detail::prepend(left, right);
+}
+
+inline detail::ConstraintExpr<ConstraintType::Imp> operator>(detail::ConstraintExpr<ConstraintType::Imp> left, const detail::ConstraintExpr<ConstraintType::Imp>& right) {
+    return detail::join(std::move(left), right);
 }
 
 inline ArgumentConstraint<ConstraintType::Imp> operator>(ArgumentConstraint<ConstraintType::Imp> left, Argument& right) {
@@ -72,6 +132,12 @@ inline ArgumentConstraint<CType>& operator-(ArgumentConstraint<CType>& arg) {
     return arg;
 }
 
+template<ConstraintType CType>
+inline detail::ConstraintExpr<CType> operator-(detail::ConstraintExpr<CType> expr) {
+    expr.set_required(false);
+    return expr;
+}
+
 inline Argument& operator+(Argument& arg) {
     arg.set_required(true);
     return arg;
@@ -94,6 +160,10 @@ inline ArgumentConstraint<CType>&& operator+(ArgumentConstraint<CType>&& arg) {
     return std::move(arg);
 }
 
+template<ConstraintType CType>
+inline detail::ConstraintExpr<CType> operator+(detail::ConstraintExpr<CType> expr) {
+    expr.set_required(true);
+    return expr;
 }
 
-
+}
@@ -25,93 +25,342 @@ freely, subject to the following restrictions:
 
 namespace TAP {
 
-template<typename... Args>
-inline ArgumentParser::ArgumentParser(Args&&... args) :
+namespace detail {
+
+/**
+ * Largest edit distance of names suggested for the given unknown name, see
+ * ArgumentParser::suggest().
+ * @param name The unknown name
+ * @return Largest edit distance of suggestions
+ */
+inline std::size_t suggest_distance(const std::string& name) {
+    return std::max<std::size_t>(1u, (name.length() + 1u) / 3u);
+}
+
+}
+
+template<typename Syntax>
+template<typename... Args, typename>
+inline BasicArgumentParser<Syntax>::BasicArgumentParser(Args&&... args) :
     m_constraints("Constraints")
 {
     m_argSets.emplace_back("Arguments", args...);
 }
 
+template<typename Syntax>
 template<typename... Args>
-inline ArgumentParser& ArgumentParser::addAll(Args&&... args) {
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::addAll(Args&&... args) {
     detail::Temporary<char[]> { (
             add(std::forward<Args>(args))
             ,'0')..., '0' };
     return *this;
 }
 
+template<typename Syntax>
 template<typename Arg>
-inline ArgumentParser& ArgumentParser::add(Arg&& arg) {
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::add(Arg&& arg) {
     m_argSets[0].add(std::forward<Arg>(arg));
+    m_frozen = false;
+    clear_help();
     return *this;
 }
 
-inline ArgumentParser& ArgumentParser::add(ArgumentSet argSet) {
+template<typename Syntax>
+template<typename It>
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::addRange(It first, It last) {
+    m_argSets[0].add_range(first, last);
+    m_frozen = false;
+    clear_help();
+    return *this;
+}
+
+template<typename Syntax>
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::add(ArgumentSet argSet) {
     m_argSets.emplace_back(std::move(argSet));
+    m_frozen = false;
+    clear_help();
     return *this;
 }
 
+template<typename Syntax>
 template<typename Arg>
-inline ArgumentParser& ArgumentParser::addConstraint(Arg&& constr) {
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::addConstraint(Arg&& constr) {
     m_constraints.add(std::forward<Arg>(constr));
+    m_frozen = false;
+    clear_help();
     return *this;
 }
 
-inline std::string ArgumentParser::help() const {
-    std::vector< std::pair<std::string, std::string> > infos;
-    std::string::size_type maxLength = 0;
-
+template<typename Syntax>
+inline BasicArgumentParser<Syntax>& BasicArgumentParser<Syntax>::freeze() {
+    m_owner.reset();
+    m_program.clear();
+    m_index.clear();
+    std::size_t count = 0;
+    for(const ArgumentSet& argSet: m_argSets) {
+        count += argSet.args().size();
+    }
+    m_index.reserve(count);
+    // Duplicate aliases are reported with the markers of the syntax
+    detail::MarkerScope scope(Markers::of<Syntax>());
+    // Assign indices in lookup order first, constraints may refer to them
     for(const ArgumentSet& argSet: m_argSets) {
         for(const Argument* arg: argSet.args()) {
-            maxLength = std::max(maxLength, arg->ident().length());
+            m_index.add(*arg, m_program.add(*arg), m_allowDuplicates);
         }
     }
+    for(const ArgumentSet& argSet: m_argSets) {
+        m_program.add_root(argSet);
+    }
+    m_program.add_root(m_constraints);
+    m_frozen = true;
+    return *this;
+}
 
-    maxLength += 2;
+template<typename Syntax>
+inline detail::HelpLayout& BasicArgumentParser<Syntax>::layout() const {
+    if (m_help.valid()) {
+        return m_help;
+    }
 
-    std::string helpText = "Usage: ";
+    detail::MarkerScope scope(Markers::of<Syntax>());
+    std::string usage = "Usage: ";
     if (m_programName.length() > 0) {
-        helpText += m_programName + " ";
+        usage += m_programName + " ";
     }
-    helpText += m_argSets[0].usage();
+    usage += m_argSets[0].usage();
     for(auto it = (m_argSets.begin()+1); it != m_argSets.end(); ++it) {
         if (it->size() == 0) {
             continue;
         }
-        helpText += " " + it->usage();
+        usage += " " + it->usage();
     }
-    helpText += '\n';
+    // Keep the usage whole, breaking inside its groups would be confusing
+    std::size_t whole = usage.length();
+    m_help.line(std::move(usage), whole);
+    // Record the rows of groups and entries for help(const HelpQuery&)
+    m_helpIndex.clear();
     for(const ArgumentSet& argSet: m_argSets) {
         if (argSet.size() == 0) {
             continue;
         }
-        helpText += "\n" + argSet.name() + ":\n";
+        std::size_t separator = m_help.line("");
+        m_helpIndex.group(argSet.name(), separator, m_help.line(argSet.name() + ":"));
         for(const Argument* arg: argSet.args()) {
             std::string ident = arg->ident();
-            helpText += "  " + ident;
-            helpText += std::string(maxLength - ident.length(), ' ');
-            helpText += arg->description();
-            helpText += "\n";
+            m_helpIndex.entry(m_help.entry(ident, arg->description()));
+            for (char flag: arg->flags()) {
+                m_helpIndex.name(std::string(1, flag));
+            }
+            for (const std::string& name: arg->names()) {
+                m_helpIndex.name(name);
+            }
+            if (arg->flags().empty() && arg->names().empty()) {
+                m_helpIndex.name(std::move(ident));
+            }
         }
     }
+    if (!m_namespaces.empty()) {
+        std::size_t separator = m_help.line("");
+        m_helpIndex.group("Namespaces", separator, m_help.line("Namespaces:"));
+        m_namespaces.for_each([this](const detail::Namespace& ns) {
+            m_helpIndex.entry(m_help.entry(std::string(Syntax::nameStart()) + ns.path() + namespaceDelim + '*', ns.description()));
+            m_helpIndex.name(ns.path());
+        });
+    }
+    m_help.finish();
+
+    return m_help;
+}
+
+template<typename Syntax>
+inline const std::string& BasicArgumentParser<Syntax>::help() const {
+    return layout().str();
+}
+
+template<typename Syntax>
+inline void BasicArgumentParser<Syntax>::write_help(std::ostream& out, std::size_t width) const {
+    detail::write_pieces(out, layout().pieces(width));
+}
+
+#ifdef TAP_POSIX
+template<typename Syntax>
+inline bool BasicArgumentParser<Syntax>::write_help(int fd, std::size_t width) const {
+    return detail::write_pieces(fd, layout().pieces(width));
+}
+#endif
+
+template<typename Syntax>
+inline void BasicArgumentParser<Syntax>::help_pieces(const HelpQuery& query, std::size_t width, std::vector<detail::HelpLayout::Piece>& pieces) const {
+    const detail::HelpLayout& text = layout();
+    if (!m_helpIndex.finished()) {
+        m_helpIndex.finish(text);
+    }
+    std::vector<std::size_t> rows;
+    m_helpIndex.rows(query, rows);
+    text.pieces(rows, width, pieces);
+}
 
+template<typename Syntax>
+inline std::string BasicArgumentParser<Syntax>::help(const HelpQuery& query) const {
+    std::vector<detail::HelpLayout::Piece> pieces;
+    help_pieces(query, 0, pieces);
+    std::string helpText;
+    for (const detail::HelpLayout::Piece& piece: pieces) {
+        helpText.append(piece.data, piece.length);
+    }
     return helpText;
 }
 
-inline void ArgumentParser::parse(int argc, const char* const argv[]) {
-    // Push back all arguments in vector.
+template<typename Syntax>
+inline void BasicArgumentParser<Syntax>::write_help(std::ostream& out, const HelpQuery& query, std::size_t width) const {
+    std::vector<detail::HelpLayout::Piece> pieces;
+    help_pieces(query, width, pieces);
+    detail::write_pieces(out, pieces);
+}
+
+#ifdef TAP_POSIX
+template<typename Syntax>
+inline bool BasicArgumentParser<Syntax>::write_help(int fd, const HelpQuery& query, std::size_t width) const {
+    std::vector<detail::HelpLayout::Piece> pieces;
+    help_pieces(query, width, pieces);
+    return detail::write_pieces(fd, pieces);
+}
+#endif
+
+template<typename Syntax>
+inline std::string BasicArgumentParser<Syntax>::help(const std::string& path) const {
+    const detail::Namespace* ns = m_namespaces.find_namespace(path);
+    if (ns == nullptr) {
+        throw std::out_of_range("Namespace not found");
+    }
+
+    const ArgumentSet& args = ns->load();
+    detail::MarkerScope scope(Markers::of<Syntax>());
+    detail::HelpLayout layout;
+    std::string title = ns->path() + ":";
+    if (ns->description().length() > 0) {
+        title += " " + ns->description();
+    }
+    layout.line(std::move(title));
+    for(const Argument* arg: args.args()) {
+        layout.entry(arg->ident(), arg->description());
+    }
+    ns->for_each([&layout](const detail::Namespace& child) {
+        layout.entry(std::string(Syntax::nameStart()) + child.path() + namespaceDelim + '*', child.description());
+    });
+    layout.finish();
+
+    return layout.str();
+}
+
+template<typename Syntax>
+inline int BasicArgumentParser<Syntax>::parse(int argc, const char* const argv[]) {
+    ParseResult result = try_parse(argc, argv);
+    if (!result) {
+        raise(result, argc, argv);
+    }
+    return result.action();
+}
+
+template<typename Syntax>
+inline ParseResult BasicArgumentParser<Syntax>::try_parse(int argc, const char* const argv[]) {
     // skip argv[0], it is the program name
     if (m_programName.length() == 0) {
         m_programName = argv[0];
+        clear_help();
+    }
+    if (!m_frozen) {
+        freeze();
+    }
+    return parse_args(argv, argc > 0 ? static_cast<std::size_t>(argc) : 1u);
+}
+
+template<typename Syntax>
+inline void BasicArgumentParser<Syntax>::raise(const ParseResult& result, int argc, const char* const argv[]) const {
+    // Exceptions show arguments with the markers of the syntax
+    detail::MarkerScope scope(Markers::of<Syntax>());
+    switch (result.error()) {
+    case ParseError::None:
+        return;
+    case ParseError::UnknownArgument:
+        if (result.flag() != '\0') {
+            throw unknown_argument(result.flag());
+        } else if (result.offset() > 0) {
+            const char* name = argv[result.index()] + result.offset();
+            const char* delim = detail::find_delim(name, Syntax::nameDelim());
+            std::string unknown = (delim == nullptr ? std::string(name) : std::string(name, delim));
+            std::vector<std::string> suggestions;
+            m_index.suggest(unknown, detail::suggest_distance(unknown), 3, suggestions);
+            throw unknown_argument(std::move(unknown), std::move(suggestions));
+        }
+        throw unknown_argument();
+    case ParseError::MissingValue:
+        throw argument_missing_value(share(*result.argument()), result.index());
+    case ParseError::NoValue:
+        throw argument_no_value(share(*result.argument()), result.index());
+    case ParseError::InvalidValue:
+        throw argument_invalid_value(share(*result.argument()), argv[result.index()] + result.offset(), result.index());
+    case ParseError::CheckFailed:
+        std::rethrow_exception(result.exception());
+    case ParseError::CountMismatch: {
+        const Argument& arg = *result.argument();
+        unsigned int count = arg.count();
+        if (result.index() < static_cast<std::size_t>(argc)) {
+            // Found while setting the argument, see fail_fast()
+            throw argument_count_mismatch(share(arg), count + 1u, arg.max(), result.index());
+        }
+        // Found when validating, see Argument::check_valid()
+        throw argument_count_mismatch(share(arg), count, count < arg.min() ? arg.min() : arg.max(), result.index());
     }
-    std::vector<std::string> args;
-    for (int i = 1; i < argc; i++) {
-        args.emplace_back(argv[i]);
+    default:
+        break;
     }
-    parse(args);
+    if (result.index() < static_cast<std::size_t>(argc)) {
+        // Found while setting the argument, see fail_fast()
+        m_program.raise_set(result);
+    }
+    // Found when validating, let the constraint describe the problem (see
+    // ConstraintProgram::check_valid())
+    if (result.predicate() != nullptr) {
+        std::vector<const BaseArgument*> args;
+        result.predicate()->arguments(args);
+        throw constraint_error(result.predicate()->reason(), args);
+    } else {
+        result.constraint()->check_valid();
+    }
+    throw constraint_error("Constraint not satisfied: ", std::vector<const BaseArgument*>{result.constraint()});
+}
+
+template<typename Syntax>
+inline std::vector<std::string> BasicArgumentParser<Syntax>::suggest(const std::string& name, std::size_t count) {
+    if (!m_frozen) {
+        freeze();
+    }
+    std::vector<std::string> suggestions;
+    m_index.suggest(name, detail::suggest_distance(name), count, suggestions);
+    return suggestions;
+}
+
+template<typename Syntax>
+inline argument_error::Handle BasicArgumentParser<Syntax>::share(const Argument& arg) const {
+    std::size_t index = m_program.index(arg);
+    if (index != detail::ConstraintProgram::npos && &m_program.argument(index) == &arg) {
+        if (m_owner == nullptr) {
+            m_owner = std::make_shared< const std::vector<ArgumentSet> >(m_argSets);
+        }
+        return argument_error::Handle(m_owner, &arg);
+    }
+    argument_error::Handle handle = m_namespaces.share(arg);
+    return handle != nullptr ? handle : detail::copy_argument(arg);
 }
 
-inline const Argument* ArgumentParser::findArg() const {
+template<typename Syntax>
+inline const Argument* BasicArgumentParser<Syntax>::findArg() const {
+    if (m_frozen) {
+        const detail::FrozenArgument* entry = m_index.find();
+        return entry == nullptr ? nullptr : entry->arg;
+    }
     const Argument* arg = nullptr;
     for(const ArgumentSet& argSet: m_argSets) {
         for (const Argument* checkArg: argSet.args()) {
@@ -126,8 +375,13 @@ inline const Argument* ArgumentParser::findArg() const {
     return arg;
 }
 
+template<typename Syntax>
 template<typename Ident>
-inline const Argument* ArgumentParser::findArg(Ident ident) const {
+inline const Argument* BasicArgumentParser<Syntax>::findArg(Ident ident) const {
+    if (m_frozen) {
+        const detail::FrozenArgument* entry = m_index.find(ident);
+        return entry == nullptr ? nullptr : entry->arg;
+    }
     const Argument* arg = nullptr;
     for(const ArgumentSet& argSet: m_argSets) {
         for (const Argument* checkArg: argSet.args()) {
@@ -142,130 +396,612 @@ inline const Argument* ArgumentParser::findArg(Ident ident) const {
     return arg;
 }
 
-inline void ArgumentParser::parse(std::vector<std::string>& argv) const {
-    bool noParse = false;
+/**
+ * Handler for detail::scan() that sets the arguments, stopping at the
+ * first error.
+ */
+template<typename Syntax>
+class BasicArgumentParser<Syntax>::SetHandler {
+public:
+    /** Entries found by the handler */
+    using Entry = detail::FrozenArgument;
+
+private:
+    /** Parser being parsed with */
+    const BasicArgumentParser& m_parser;
+    /** Arguments set so far, only tracked when failing fast */
+    detail::BitSet& m_state;
+
+public:
+    /**
+     * Create a handler for the given parser.
+     * @param parser Parser being parsed with
+     */
+    explicit SetHandler(const BasicArgumentParser& parser) :
+        m_parser(parser), m_state(parser.m_state) {
+        if (parser.m_failFast) {
+            parser.m_program.state(m_state);
+        }
+    }
 
-    for (auto it = argv.begin(); it != argv.end(); ++it) {
-        const std::string& arg = *it;
+    /** Find a positional argument */
+    const detail::FrozenArgument* find() const {
+        return m_parser.m_index.find();
+    }
 
-        const Argument* matchedArg = nullptr;
-        if (arg == skip) {
-            // After skip token, stop parsing
-            noParse = true;
-            continue;
-        } else if (!noParse && arg.compare(0, strlen(nameStart), nameStart) == 0 && arg != nameStart) {
-            // Named argument
-            std::string name;
-
-            //Check if delimiter present, split if so
-            std::size_t found = arg.find(nameDelim);
-            bool hasDelim = (found != std::string::npos && found != 0);
-            if (hasDelim) {
-                name = arg.substr(strlen(nameStart), found - strlen(nameStart));
-            } else {
-                name = arg.substr(strlen(nameStart));
+    /** Find an argument by flag */
+    const detail::FrozenArgument* find(char flag) const {
+        return m_parser.m_index.find(flag);
+    }
+
+    /** Find an argument by name, including namespaced names */
+    const detail::FrozenArgument* find(const std::string& name) const {
+        const detail::FrozenArgument* entry = m_parser.m_index.find(name);
+        return entry != nullptr ? entry : m_parser.m_namespaces.find(name);
+    }
+
+    /** Check whether the argument may occur once more */
+    ParseResult occur(const detail::FrozenArgument& entry) {
+        return m_parser.try_set(entry, m_state);
+    }
+
+    /** Returns the argument of an entry, reported with errors */
+    const Argument* argument(const detail::FrozenArgument& entry) const {
+        return entry.arg;
+    }
+
+    /** Set an argument without value */
+    void set(const detail::FrozenArgument& entry) const {
+        entry.set();
+    }
+
+    /** Set an argument with value, false if it cannot be converted */
+    bool set(const detail::FrozenArgument& entry, const std::string& value) const {
+        return entry.set(value);
+    }
+
+    /** Stop at action arguments */
+    int action(const detail::FrozenArgument& entry) const {
+        return entry.action;
+    }
+
+    /** Stop at the first error */
+    bool report(const ParseResult&) const {
+        return false;
+    }
+};
+
+/**
+ * Handler for detail::scan() that only counts the occurrences of the
+ * arguments and converts values into temporaries, collecting all errors (see
+ * ArgumentParser::validate()).
+ */
+template<typename Syntax>
+class BasicArgumentParser<Syntax>::CheckHandler {
+public:
+    /** Entries found by the handler */
+    using Entry = detail::FrozenArgument;
+
+protected:
+    /** Decide whether an argument can be set by the counted occurrences */
+    struct CanSet {
+        /** Occurrences per dense argument index */
+        const std::vector<unsigned int>* counts;
+
+        /** See detail::CanSet */
+        bool operator()(const detail::FrozenArgument& entry) const {
+            if (entry.index == detail::ConstraintProgram::npos) {
+                return entry.arg->can_set();
+            }
+            return entry.arg->max() == 0u || (*counts)[entry.index] < entry.arg->max();
+        }
+    };
+
+    /** Parser being validated with */
+    const BasicArgumentParser& m_parser;
+    /** Buffer to store the counts and errors in */
+    ValidationResult& m_result;
+
+public:
+    /**
+     * Create a handler for the given parser.
+     * @param parser Parser being validated with
+     * @param result Buffer to store the counts and errors in
+     */
+    CheckHandler(const BasicArgumentParser& parser, ValidationResult& result) :
+        m_parser(parser), m_result(result) {
+        m_result.m_errors.clear();
+        m_result.m_counts.assign(parser.m_program.size(), 0u);
+    }
+
+    /** Find a positional argument */
+    const detail::FrozenArgument* find() const {
+        return m_parser.m_index.find_if(CanSet{&m_result.m_counts});
+    }
+
+    /** Find an argument by flag */
+    const detail::FrozenArgument* find(char flag) const {
+        return m_parser.m_index.find_if(CanSet{&m_result.m_counts}, flag);
+    }
+
+    /** Find an argument by name, including namespaced names */
+    const detail::FrozenArgument* find(const std::string& name) const {
+        const detail::FrozenArgument* entry = m_parser.m_index.find_if(CanSet{&m_result.m_counts}, name);
+        return entry != nullptr ? entry : m_parser.m_namespaces.find_if(CanSet{&m_result.m_counts}, name);
+    }
+
+    /** Count an occurrence, failing if the argument occurs too often */
+    ParseResult occur(const detail::FrozenArgument& entry) {
+        if (entry.index == detail::ConstraintProgram::npos) {
+            return ParseResult();
+        }
+        bool canSet = CanSet{&m_result.m_counts}(entry);
+        ++m_result.m_counts[entry.index];
+        return canSet ? ParseResult() : ParseResult(ParseError::CountMismatch, entry.arg);
+    }
+
+    /** Returns the argument of an entry, reported with errors */
+    const Argument* argument(const detail::FrozenArgument& entry) const {
+        return entry.arg;
+    }
+
+    /** Arguments are not set */
+    void set(const detail::FrozenArgument&) const {
+    }
+
+    /** Convert the value without storing it */
+    bool set(const detail::FrozenArgument& entry, const std::string& value) const {
+        return entry.accepts(value);
+    }
+
+    /** Stop at action arguments, see ValidationResult::action() */
+    int action(const detail::FrozenArgument& entry) const {
+        return entry.action;
+    }
+
+    /** Collect the error and continue */
+    bool report(const ParseResult& result) {
+        m_result.m_errors.push_back(result);
+        return true;
+    }
+};
+
+/**
+ * Handler for detail::scan() that counts the occurrences of the arguments
+ * without converting values, remembering an argument missing its value (see
+ * ArgumentParser::completions()).
+ */
+template<typename Syntax>
+class BasicArgumentParser<Syntax>::CompleteHandler : public CheckHandler {
+    /** Entry of the last argument found */
+    const detail::FrozenArgument* m_last = nullptr;
+    /** Entry of the last token if its value is missing */
+    const detail::FrozenArgument* m_pending = nullptr;
+
+public:
+    /**
+     * Create a handler for the given parser.
+     * @param parser Parser completing with
+     * @param result Buffer to store the counts in
+     */
+    CompleteHandler(const BasicArgumentParser& parser, ValidationResult& result) :
+        CheckHandler(parser, result) {
+    }
+
+    using CheckHandler::set;
+
+    /** Count an occurrence, remembering the argument */
+    ParseResult occur(const detail::FrozenArgument& entry) {
+        m_last = &entry;
+        return CheckHandler::occur(entry);
+    }
+
+    /** Values are not converted */
+    bool set(const detail::FrozenArgument&, const std::string&) const {
+        return true;
+    }
+
+    /** Read past action arguments, the words after them are completed */
+    int action(const detail::FrozenArgument&) const {
+        return 0;
+    }
+
+    /** Ignore errors, only a missing value matters for completion */
+    bool report(const ParseResult& result) {
+        if (result.error() == ParseError::MissingValue) {
+            m_pending = m_last;
+        }
+        return true;
+    }
+
+    /** Returns the entry whose value is completed, or nullptr */
+    const detail::FrozenArgument* pending() const {
+        return m_pending;
+    }
+
+    /** Check whether the argument can be set once more */
+    bool can_set(const detail::FrozenArgument& entry) const {
+        return typename CheckHandler::CanSet{&this->m_result.m_counts}(entry);
+    }
+
+    /** Add the choices of an argument starting with value, after lead */
+    void complete_value(const detail::FrozenArgument& entry, const char* value, const std::string& lead, std::vector<std::string>& candidates) const {
+        const std::size_t length = std::strlen(value);
+        for (const std::string& choice: entry.arg->choices()) {
+            if (choice.compare(0, length, value) == 0) {
+                candidates.push_back(lead + choice);
             }
+        }
+        if (entry.arg->complete_files()) {
+            candidates.push_back(completeFiles);
+        }
+    }
 
-            // Find argument
-            matchedArg = findArg(name);
+    /** Add the names starting with prefix that can be set, and namespaces */
+    void complete_names(const std::string& prefix, std::vector<std::string>& candidates) const {
+        std::vector<const std::string*> names;
+        this->m_parser.m_index.complete(prefix, names);
+        for (const std::string* name: names) {
+            const detail::FrozenArgument* entry = this->find(*name);
+            if (entry != nullptr && can_set(*entry)) {
+                candidates.push_back(Syntax::nameStart() + *name);
+            }
+        }
+        this->m_parser.m_namespaces.for_each([&](const detail::Namespace& ns) {
+            std::string path = ns.path() + namespaceDelim;
+            if (path.compare(0, prefix.length(), prefix) == 0) {
+                candidates.push_back(Syntax::nameStart() + path);
+            } else if (prefix.compare(0, path.length(), path) == 0) {
+                // Inside the namespace, offer its arguments
+                for (const Argument* arg: ns.load().args()) {
+                    for (const std::string& name: arg->names()) {
+                        if (name.compare(0, prefix.length(), prefix) == 0) {
+                            candidates.push_back(Syntax::nameStart() + name);
+                        }
+                    }
+                }
+            }
+        });
+    }
 
-            if (matchedArg == nullptr) {
-                throw unknown_argument(name);
+    /** Add the flags that can be set */
+    void complete_flags(std::vector<std::string>& candidates) const {
+        for (char flag: this->m_parser.m_index.flags()) {
+            const detail::FrozenArgument* entry = this->find(flag);
+            if (entry != nullptr && can_set(*entry)) {
+                candidates.push_back(Syntax::flagStart() + std::string(1, flag));
             }
+        }
+    }
+};
+
+namespace detail {
+
+template<typename Syntax, typename Handler>
+inline ParseResult scan(const char* const argv[], std::size_t argc, Handler& handler) {
+    using Traits = detail::SyntaxTraits<Syntax>;
+    constexpr std::size_t nameStartLength = Traits::nameStartLength;
+    bool noParse = false;
 
-            if (matchedArg->takes_value()) {
+    // Buffers for names and values, reused for all tokens
+    std::string name;
+    std::string value;
+
+    std::size_t i = 1;
+    const typename Handler::Entry* matchedArg = nullptr;
+    // Check functions report failure by throwing, these are the only
+    // exceptions expected while parsing
+    try {
+        for (; i < argc; ++i) {
+            const char* arg = argv[i];
+            const std::size_t length = strlen(arg);
+            std::size_t offset = 0;
+
+            matchedArg = nullptr;
+            if (strcmp(arg, Syntax::skip()) == 0) {
+                // After skip token, stop parsing
+                noParse = true;
+                continue;
+            } else if (!noParse && Traits::is_name(arg, length)) {
+                // Named argument
+
+                //Check if delimiter present, split if so
+                const char* delim = detail::find_delim(arg, Syntax::nameDelim());
+                bool hasDelim = (delim != nullptr && delim != arg);
                 if (hasDelim) {
-                    set_arg_value(matchedArg, arg.substr(found+1));
+                    name.assign(arg + nameStartLength, delim);
                 } else {
-                    ++it;
-                    if (it == argv.end()) {
-                        // Value expected but not given
-                        throw argument_missing_value(*matchedArg);
-                    } else {
-                        set_arg_value(matchedArg, *it);
-                    }
+                    name.assign(arg + nameStartLength, arg + length);
                 }
-            } else if (hasDelim) {
-                throw argument_no_value(*matchedArg);
-            } else {
-                matchedArg->set();
-            }
-        } else if (!noParse && arg.compare(0, strlen(flagStart), flagStart) == 0 && arg != flagStart) {
-            // flag argument. May be followed by other flags, or actual value
-            // argument has to determine this
-            size_t flagIndex = strlen(flagStart);
-            for (; flagIndex < arg.length(); ++flagIndex) {
-                matchedArg = findArg(arg[flagIndex]);
 
+                // Find argument
+                matchedArg = handler.find(name);
                 if (matchedArg == nullptr) {
-                    // Lookup failure
-                    throw unknown_argument(arg[flagIndex]);
+                    ParseResult result = ParseResult(ParseError::UnknownArgument).at(i, nameStartLength);
+                    if (!handler.report(result)) {
+                        return result;
+                    }
+                    continue;
+                }
+                ParseResult result = handler.occur(*matchedArg);
+                if (!result && !handler.report(result.at(i))) {
+                    return result;
                 }
 
-                // Test if the flag takes a value, if not, grab next index
-                if (matchedArg->takes_value()) {
-                    ++flagIndex;
-                    break;
+                if (matchedArg->takesValue) {
+                    if (hasDelim) {
+                        offset = static_cast<std::size_t>(delim + 1 - arg);
+                        value.assign(delim + 1, arg + length);
+                    } else if (i + 1 < argc) {
+                        value.assign(argv[++i]);
+                    } else {
+                        // Value expected but not given
+                        result = ParseResult(ParseError::MissingValue, handler.argument(*matchedArg)).at(i);
+                        if (!handler.report(result)) {
+                            return result;
+                        }
+                        continue;
+                    }
+                } else if (hasDelim) {
+                    result = ParseResult(ParseError::NoValue, handler.argument(*matchedArg)).at(i);
+                    if (!handler.report(result)) {
+                        return result;
+                    }
+                    continue;
                 } else {
-                    matchedArg->set();
+                    handler.set(*matchedArg);
+                    if (handler.action(*matchedArg) != 0) {
+                        return ParseResult::stop(handler.action(*matchedArg)).at(i);
+                    }
+                    continue;
                 }
-            }
+            } else if (!noParse && Traits::is_flag(arg, length)) {
+                // flag argument. May be followed by other flags, or actual value
+                // argument has to determine this
+                std::size_t flagIndex = Traits::flagStartLength;
+                for (; flagIndex < length; ++flagIndex) {
+                    matchedArg = handler.find(arg[flagIndex]);
+
+                    if (matchedArg == nullptr) {
+                        // Lookup failure, the rest of the token is unusable
+                        ParseResult result = ParseResult::unknown_flag(arg[flagIndex]).at(i, flagIndex);
+                        if (!handler.report(result)) {
+                            return result;
+                        }
+                        break;
+                    }
+                    ParseResult result = handler.occur(*matchedArg);
+                    if (!result && !handler.report(result.at(i, flagIndex))) {
+                        return result;
+                    }
 
-            if (matchedArg->takes_value()) {
-                if (flagIndex < arg.length()) {
-                    set_arg_value(matchedArg, arg.substr(flagIndex));
-                } else {
-                    ++it;
-                    if (it == argv.end()) {
-                        // Value expected but not given
-                        throw argument_missing_value(*matchedArg);
+                    // Test if the flag takes a value, if not, grab next index
+                    if (matchedArg->takesValue) {
+                        ++flagIndex;
+                        break;
                     } else {
-                        set_arg_value(matchedArg, *it);
+                        handler.set(*matchedArg);
+                        if (handler.action(*matchedArg) != 0) {
+                            // The rest of the cluster is not read either
+                            return ParseResult::stop(handler.action(*matchedArg)).at(i, flagIndex);
+                        }
+                    }
+                }
+
+                if (matchedArg == nullptr || !matchedArg->takesValue) {
+                    // Already set in for loop
+                    continue;
+                }
+                if (flagIndex < length) {
+                    offset = flagIndex;
+                    value.assign(arg + flagIndex, arg + length);
+                } else if (i + 1 < argc) {
+                    value.assign(argv[++i]);
+                } else {
+                    // Value expected but not given
+                    ParseResult result = ParseResult(ParseError::MissingValue, handler.argument(*matchedArg)).at(i);
+                    if (!handler.report(result)) {
+                        return result;
                     }
+                    continue;
                 }
             } else {
-                // Already set in for loop
-            }
-        } else {
-            // Positional/unnamed argument
-            matchedArg = findArg();
+                // Positional/unnamed argument
+                matchedArg = handler.find();
+
+                // If still no argument, cannot do anything
+                if (matchedArg == nullptr) {
+                    ParseResult result = ParseResult(ParseError::UnknownArgument).at(i);
+                    if (!handler.report(result)) {
+                        return result;
+                    }
+                    continue;
+                }
+                ParseResult result = handler.occur(*matchedArg);
+                if (!result && !handler.report(result.at(i))) {
+                    return result;
+                }
 
-            // If still no argument, cannot do anything
-            if (matchedArg == nullptr) {
-                throw unknown_argument();
+                if (!matchedArg->takesValue) {
+                    handler.set(*matchedArg);
+                    if (handler.action(*matchedArg) != 0) {
+                        return ParseResult::stop(handler.action(*matchedArg)).at(i);
+                    }
+                    continue;
+                }
+                value.assign(arg, arg + length);
             }
 
-            if (matchedArg->takes_value()) {
-                if (it == argv.end()) {
-                    // Value expected but not given
-                    throw argument_missing_value(*matchedArg);
+            // Set the argument value
+            if (!handler.set(*matchedArg, value)) {
+                ParseResult result = ParseResult(ParseError::InvalidValue, handler.argument(*matchedArg)).at(i, offset);
+                if (!handler.report(result)) {
+                    return result;
                 }
-                // Set the argument value
-                set_arg_value(matchedArg, *it);
-            } else {
-                matchedArg->set();
             }
         }
+    } catch (const std::exception&) {
+        // Not only TAP exceptions, check functions may throw anything
+        return ParseResult::check_failed(std::current_exception(), matchedArg == nullptr ? nullptr : handler.argument(*matchedArg)).at(i);
     }
+    return ParseResult();
+}
 
-    for(const ArgumentSet& argSet: m_argSets) {
-		// Some error in arguments, print diagnostics
-		argSet.check_valid();
+template<typename Syntax, typename Handler>
+inline void complete(const char* const words[], std::size_t count, std::size_t index, Handler& handler, std::vector<std::string>& candidates) {
+    using Traits = detail::SyntaxTraits<Syntax>;
+
+    // Count the occurrences in the preceding words, values are not converted
+    scan<Syntax>(words, index, handler);
+    bool noParse = false;
+    for (std::size_t i = 1; i < index; ++i) {
+        noParse = noParse || std::strcmp(words[i], Syntax::skip()) == 0;
+    }
+
+    const char* word = index < count ? words[index] : "";
+    const std::size_t length = std::strlen(word);
+    const typename Handler::Entry* entry = nullptr;
+    if (handler.pending() != nullptr) {
+        handler.complete_value(*handler.pending(), word, std::string(), candidates);
+    } else if (!noParse && (Traits::is_name(word, length) || std::strcmp(word, Syntax::nameStart()) == 0)) {
+        const char* delim = detail::find_delim(word + Traits::nameStartLength, Syntax::nameDelim());
+        if (delim != nullptr) {
+            entry = handler.find(std::string(word + Traits::nameStartLength, delim));
+            if (entry != nullptr && entry->takesValue) {
+                handler.complete_value(*entry, delim + 1, std::string(word, delim + 1), candidates);
+            }
+            return;
+        }
+        handler.complete_names(std::string(word + Traits::nameStartLength, word + length), candidates);
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    } else if (!noParse && Traits::is_flag(word, length)) {
+        // Resolve the flag cluster, up to a flag taking a value
+        for (std::size_t i = Traits::flagStartLength; i < length; ++i) {
+            entry = handler.find(word[i]);
+            if (entry == nullptr) {
+                return;
+            }
+            if (entry->takesValue) {
+                handler.complete_value(*entry, word + i + 1, std::string(word, word + i + 1), candidates);
+                return;
+            }
+        }
+        candidates.push_back(word);
+    } else {
+        const bool marker = !noParse && std::strcmp(word, Syntax::flagStart()) == 0;
+        entry = marker ? nullptr : handler.find();
+        if (entry != nullptr && handler.can_set(*entry)) {
+            if (entry->takesValue) {
+                handler.complete_value(*entry, word, std::string(), candidates);
+            }
+        } else if (!noParse && (length == 0 || marker)) {
+            // Nothing to fill in, offer all arguments that can still be set
+            handler.complete_flags(candidates);
+            const std::size_t flagCount = candidates.size();
+            handler.complete_names(std::string(), candidates);
+            std::sort(candidates.begin() + static_cast<std::ptrdiff_t>(flagCount), candidates.end());
+        }
     }
+}
 
-	// Some error in constraints, print diagnostics
-	m_constraints.check_valid();
 }
 
-inline void ArgumentParser::set_arg_value(const Argument* arg, const std::string& value) const {
-    if (!arg->takes_value()) {
-        throw std::logic_error("Attempt to set value on non-valued argument");
+template<typename Syntax>
+inline ParseResult BasicArgumentParser<Syntax>::parse_args(const char* const argv[], std::size_t argc) const {
+    SetHandler handler(*this);
+    ParseResult result = detail::scan<Syntax>(argv, argc, handler);
+    if (!result || result.action() != 0) {
+        return result;
+    }
+
+    // Check the arguments and constraints
+    result = m_program.try_valid(m_state, m_active);
+    if (result) {
+        result = m_namespaces.try_valid(m_state, m_active);
+    }
+    return result.at(argc);
+}
+
+template<typename Syntax>
+inline bool BasicArgumentParser<Syntax>::validate(int argc, const char* const argv[], ValidationResult& result) {
+    if (!m_frozen) {
+        freeze();
+    }
+    const std::size_t count = argc > 0 ? static_cast<std::size_t>(argc) : 1u;
+    CheckHandler handler(*this, result);
+    result.m_action = detail::scan<Syntax>(argv, count, handler).action();
+    if (result.m_action != 0) {
+        return result.m_errors.empty();
+    }
+
+    // Occurrence counts, exceeding the maximum is reported while scanning
+    result.m_set.assign(m_program.size());
+    for (std::size_t i = 0; i < m_program.size(); ++i) {
+        unsigned int occurrences = result.m_counts[i];
+        if (occurrences == 0u) {
+            continue;
+        }
+        result.m_set.set(i);
+        if (occurrences < m_program.argument(i).min()) {
+            result.m_errors.push_back(ParseResult(ParseError::CountMismatch, &m_program.argument(i)).at(count));
+        }
+    }
+
+    // All violated constraints
+    result.m_failed.clear();
+    m_program.check_all(result.m_set, result.m_active, result.m_failed);
+    for (std::size_t op: result.m_failed) {
+        result.m_errors.push_back(ParseResult(ParseError::ConstraintViolated, nullptr, m_program.op(op).source).at(count));
     }
-    const ValueAcceptor* valueArg = dynamic_cast<const ValueAcceptor*>(arg);
-    if (valueArg == nullptr) {
-        throw std::logic_error("Requested value interface on non-valued argument");
+    return result.m_errors.empty();
+}
+
+template<typename Syntax>
+inline std::vector<std::string> BasicArgumentParser<Syntax>::completions(const char* const words[], std::size_t count, std::size_t index) {
+    std::vector<std::string> candidates;
+    if (index == 0 || index > count) {
+        return candidates;
+    }
+    if (!m_frozen) {
+        freeze();
+    }
+    ValidationResult counts;
+    CompleteHandler handler(*this, counts);
+    detail::complete<Syntax>(words, count, index, handler, candidates);
+    return candidates;
+}
+
+template<typename Syntax>
+inline bool BasicArgumentParser<Syntax>::complete(int argc, const char* const argv[], std::ostream& out) {
+    using Traits = detail::SyntaxTraits<Syntax>;
+    if (argc < 3 || std::strncmp(argv[1], Syntax::nameStart(), Traits::nameStartLength) != 0 ||
+            std::strcmp(argv[1] + Traits::nameStartLength, completeName) != 0) {
+        return false;
+    }
+    const std::size_t count = static_cast<std::size_t>(argc - 3);
+    const std::size_t index = std::min<std::size_t>(std::strtoul(argv[2], nullptr, 10), count);
+    for (const std::string& candidate: completions(argv + 3, count, index)) {
+        out << candidate << '\n';
+    }
+    return true;
+}
+
+template<typename Syntax>
+inline std::string BasicArgumentParser<Syntax>::export_schema() {
+    if (!m_frozen) {
+        freeze();
+    }
+    return detail::write_schema(m_index, m_programName, Syntax::flagStart(), Syntax::nameStart(), Syntax::nameDelim(), Syntax::skip());
+}
+
+template<typename Syntax>
+inline ParseResult BasicArgumentParser<Syntax>::try_set(const detail::FrozenArgument& arg, detail::BitSet& state) const {
+    // Arguments of namespaces are not part of the program
+    if (m_failFast && arg.index != detail::ConstraintProgram::npos) {
+        return m_program.try_set(arg.index, state);
     }
-    valueArg->set(value);
+    return ParseResult();
 }
 
 }
@@ -0,0 +1,98 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+template<typename K, typename T>
+inline bool PatternArgument<K, T>::matches_pattern(const std::string& name) const {
+    if (name.length() <= m_prefix.length() + m_suffix.length() ||
+            name.compare(0, m_prefix.length(), m_prefix) != 0 ||
+            name.compare(name.length() - m_suffix.length(), m_suffix.length(), m_suffix) != 0) {
+        return false;
+    }
+    std::string key = name.substr(m_prefix.length(), name.length() - m_prefix.length() - m_suffix.length());
+    K local = K();
+    if (!detail::setValue(key, local)) {
+        return false;
+    }
+    m_key = std::move(local);
+    return true;
+}
+
+template<typename K, typename T>
+inline void PatternArgument<K, T>::set() const {
+    if (takes_value()) {
+        throw std::logic_error("Calling set() on valued argument");
+    }
+    (*m_values)[m_key] = T(true);
+    Argument::set();
+}
+
+template<typename K, typename T>
+inline void PatternArgument<K, T>::set(const std::string& value) const {
+    if (!try_set(value)) {
+        throw argument_invalid_value(*this, value);
+    }
+}
+
+template<typename K, typename T>
+inline bool PatternArgument<K, T>::try_set(const std::string& value) const {
+    T local = T();
+    if (!detail::setValue(value, local)) {
+        return false;
+    }
+    (*m_values)[m_key] = std::move(local);
+    Argument::set();
+    return true;
+}
+
+template<typename K, typename T>
+inline bool PatternArgument<K, T>::set_value(const Argument& arg, const std::string& value) {
+    return static_cast<const PatternArgument&>(arg).try_set(value);
+}
+
+template<typename K, typename T>
+inline bool PatternArgument<K, T>::accepts(const std::string& value) const {
+    T local = T();
+    return detail::setValue(value, local);
+}
+
+template<typename K, typename T>
+inline bool PatternArgument<K, T>::check_value(const Argument& arg, const std::string& value) {
+    return static_cast<const PatternArgument&>(arg).accepts(value);
+}
+
+template<typename K, typename T>
+inline std::string PatternArgument<K, T>::usage() const {
+    std::string usageStr = ident();
+    if (takes_value()) {
+        usageStr += " " + m_valueName;
+    }
+    return usageStr;
+}
+
+template<typename K, typename T>
+inline std::string PatternArgument<K, T>::ident() const {
+    return std::string(Markers::current().nameStart) + m_prefix + "<key>" + m_suffix;
+}
+
+}
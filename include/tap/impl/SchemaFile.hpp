@@ -0,0 +1,664 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <stdexcept>
+
+#ifdef TAP_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+namespace TAP {
+
+namespace detail {
+
+/**
+ * Append the records of a table to a schema.
+ * @param schema Schema being written
+ * @param records Records of the table
+ * @return Location of the table
+ */
+template<typename T>
+inline SchemaTable append_table(std::string& schema, const std::vector<T>& records) {
+    SchemaTable table{static_cast<std::uint32_t>(schema.size()), static_cast<std::uint32_t>(records.size())};
+    if (!records.empty()) {
+        schema.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+    }
+    return table;
+}
+
+/**
+ * Returns whether a value can be converted to the given kind, see
+ * SchemaView::validate().
+ * @param kind Kind of the value
+ * @param value The value
+ * @return True iff the value is accepted
+ */
+inline bool schema_accepts(ValueKind kind, const std::string& value) {
+    char* end = nullptr;
+    errno = 0;
+    switch (kind) {
+    case ValueKind::Integer:
+        std::strtoll(value.c_str(), &end, 10);
+        break;
+    case ValueKind::Real:
+        std::strtod(value.c_str(), &end);
+        break;
+    default:
+        return true;
+    }
+    return !value.empty() && errno == 0 && *end == '\0';
+}
+
+inline std::string write_schema(const ArgumentIndex& index, const std::string& program, const char* flagStart, const char* nameStart, char nameDelim, const char* skip) {
+    constexpr std::uint32_t none = static_cast<std::uint32_t>(-1);
+    std::string text;
+    auto addText = [&text](const std::string& str) {
+        SchemaString result{static_cast<std::uint32_t>(text.size()), static_cast<std::uint32_t>(str.length())};
+        text += str;
+        text += '\0';
+        return result;
+    };
+    std::vector<SchemaString> strings;
+    auto addStrings = [&](const std::vector<std::string>& list) {
+        SchemaRange range{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(list.size())};
+        for (const std::string& str: list) {
+            strings.push_back(addText(str));
+        }
+        return range;
+    };
+
+    // Pattern arguments cannot be looked up without their class, skip them
+    std::vector<SchemaArgument> arguments;
+    std::vector<std::uint32_t> schemaIndex(index.m_entries.size(), none);
+    for (std::size_t i = 0; i < index.m_entries.size(); ++i) {
+        const FrozenArgument& entry = index.m_entries[i];
+        const Argument& arg = *entry.arg;
+        if (arg.pattern() != nullptr) {
+            continue;
+        }
+        SchemaArgument record{};
+        record.description = addText(arg.description());
+        record.ident = addText(arg.ident());
+        record.flags = addText(arg.flags());
+        record.names = addStrings(arg.names());
+        record.choices = addStrings(arg.choices());
+        record.min = arg.min();
+        record.max = arg.max();
+        record.action = arg.action();
+        record.takesValue = entry.takesValue ? 1u : 0u;
+        // Arguments that set values through Argument::acceptor() may not know their kind
+        ValueKind kind = entry.takesValue && entry.ops->kind == ValueKind::None ? ValueKind::Text : entry.ops->kind;
+        record.kind = static_cast<std::uint8_t>(kind);
+        record.attributes = static_cast<std::uint8_t>((arg.matches() ? schemaPositional : 0u) |
+                (arg.required() ? schemaRequired : 0u) | (arg.complete_files() ? schemaFiles : 0u));
+        schemaIndex[i] = static_cast<std::uint32_t>(arguments.size());
+        arguments.push_back(record);
+    }
+
+    std::vector<std::uint32_t> matches;
+    auto addMatches = [&](const std::vector<std::size_t>& positions) {
+        SchemaRange range{static_cast<std::uint32_t>(matches.size()), 0u};
+        for (std::size_t position: positions) {
+            if (schemaIndex[position] != none) {
+                matches.push_back(schemaIndex[position]);
+                ++range.count;
+            }
+        }
+        return range;
+    };
+    std::vector<SchemaRange> flags(256, SchemaRange{0u, 0u});
+    for (auto const& entry: index.m_flags) {
+        flags[static_cast<unsigned char>(entry.first)] = addMatches(entry.second);
+    }
+    SchemaRange positional = addMatches(index.m_positional);
+
+    // Build the trie from the sorted names, so nodes are numbered in
+    // preorder and each child comes after its parent
+    std::vector<const std::string*> names;
+    names.reserve(index.m_names.size());
+    for (auto const& entry: index.m_names) {
+        names.push_back(&entry.first);
+    }
+    std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b) {
+        return *a < *b;
+    });
+    std::vector<std::map<unsigned char, std::uint32_t> > children(1);
+    std::vector<SchemaNode> nodes(1, SchemaNode{{0u, 0u}, {0u, 0u}});
+    for (const std::string* name: names) {
+        std::size_t node = 0;
+        for (char c: *name) {
+            auto inserted = children[node].emplace(static_cast<unsigned char>(c), static_cast<std::uint32_t>(nodes.size()));
+            if (inserted.second) {
+                children.emplace_back();
+                nodes.push_back(SchemaNode{{0u, 0u}, {0u, 0u}});
+            }
+            node = inserted.first->second;
+        }
+        nodes[node].matches = addMatches(index.m_names.find(*name)->second);
+    }
+    std::vector<SchemaEdge> edges;
+    for (std::size_t node = 0; node < nodes.size(); ++node) {
+        nodes[node].edges = SchemaRange{static_cast<std::uint32_t>(edges.size()), static_cast<std::uint32_t>(children[node].size())};
+        for (auto const& child: children[node]) {
+            edges.push_back(SchemaEdge{child.first, child.second});
+        }
+    }
+
+    SchemaHeader header{};
+    std::memcpy(header.magic, "TAPS", 4);
+    header.version = schemaVersion;
+    header.byteOrder = schemaByteOrder;
+    header.positional = positional;
+    header.program = addText(program);
+    header.flagStart = addText(flagStart);
+    header.nameStart = addText(nameStart);
+    header.skip = addText(skip);
+    header.nameDelim = static_cast<unsigned char>(nameDelim);
+
+    std::string schema(sizeof(SchemaHeader), '\0');
+    header.arguments = append_table(schema, arguments);
+    header.nodes = append_table(schema, nodes);
+    header.edges = append_table(schema, edges);
+    header.matches = append_table(schema, matches);
+    header.flags = append_table(schema, flags);
+    header.strings = append_table(schema, strings);
+    header.text = SchemaTable{static_cast<std::uint32_t>(schema.size()), static_cast<std::uint32_t>(text.size())};
+    schema += text;
+    // Keep the size aligned, so schemas can be concatenated
+    schema.resize((schema.size() + 3u) & ~std::size_t(3u), '\0');
+    if (schema.size() > static_cast<std::uint32_t>(-1)) {
+        throw std::length_error("Schema exceeds 4 GiB");
+    }
+    header.size = static_cast<std::uint32_t>(schema.size());
+    std::memcpy(&schema[0], &header, sizeof(header));
+    return schema;
+}
+
+}
+
+inline SchemaView::SchemaView(const void* data, std::size_t size) :
+    m_data(static_cast<const char*>(data)) {
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(detail::SchemaHeader) != 0) {
+        throw std::runtime_error("Schema is not aligned");
+    }
+    if (size < sizeof(detail::SchemaHeader) || std::memcmp(m_data, "TAPS", 4) != 0) {
+        throw std::runtime_error("Not a schema");
+    }
+    m_header = reinterpret_cast<const detail::SchemaHeader*>(m_data);
+    if (m_header->byteOrder != detail::schemaByteOrder) {
+        throw std::runtime_error("Schema was written with a different byte order");
+    }
+    if (m_header->version != detail::schemaVersion) {
+        throw std::runtime_error("Unsupported schema version " + std::to_string(m_header->version));
+    }
+    if (m_header->size > size) {
+        throw std::runtime_error("Schema is truncated");
+    }
+    size = m_header->size;
+    m_arguments = table<SchemaArgument>(m_header->arguments, size);
+    m_nodes = table<detail::SchemaNode>(m_header->nodes, size);
+    m_edges = table<detail::SchemaEdge>(m_header->edges, size);
+    m_matches = table<std::uint32_t>(m_header->matches, size);
+    m_flags = table<detail::SchemaRange>(m_header->flags, size);
+    m_strings = table<detail::SchemaString>(m_header->strings, size);
+    m_text = table<char>(m_header->text, size);
+
+    // Check all references, so lookups need no checks
+    const std::uint32_t textSize = m_header->text.count;
+    auto checkString = [&](const detail::SchemaString& str) {
+        if (str.offset >= textSize || str.length >= textSize - str.offset || m_text[str.offset + str.length] != '\0') {
+            throw std::runtime_error("Schema string out of bounds");
+        }
+    };
+    auto checkRange = [](const detail::SchemaRange& range, std::uint32_t size) {
+        if (range.first > size || range.count > size - range.first) {
+            throw std::runtime_error("Schema range out of bounds");
+        }
+    };
+    if (m_header->flags.count != 256u || m_header->nodes.count == 0u) {
+        throw std::runtime_error("Schema lacks lookup tables");
+    }
+    for (std::uint32_t i = 0; i < m_header->strings.count; ++i) {
+        checkString(m_strings[i]);
+    }
+    for (std::uint32_t i = 0; i < m_header->arguments.count; ++i) {
+        const SchemaArgument& arg = m_arguments[i];
+        checkString(arg.description);
+        checkString(arg.ident);
+        checkString(arg.flags);
+        checkRange(arg.names, m_header->strings.count);
+        checkRange(arg.choices, m_header->strings.count);
+        if (arg.kind > static_cast<std::uint8_t>(ValueKind::Real)) {
+            throw std::runtime_error("Unknown value kind in schema");
+        }
+    }
+    for (std::uint32_t i = 0; i < m_header->matches.count; ++i) {
+        if (m_matches[i] >= m_header->arguments.count) {
+            throw std::runtime_error("Schema argument out of bounds");
+        }
+    }
+    for (std::uint32_t i = 0; i < m_header->nodes.count; ++i) {
+        const detail::SchemaNode& node = m_nodes[i];
+        checkRange(node.edges, m_header->edges.count);
+        checkRange(node.matches, m_header->matches.count);
+        for (std::uint32_t j = 0; j < node.edges.count; ++j) {
+            const detail::SchemaEdge& edge = m_edges[node.edges.first + j];
+            // Children after their parent rule out cycles
+            if (edge.child <= i || edge.child >= m_header->nodes.count || edge.label > 255u ||
+                    (j > 0 && edge.label <= m_edges[node.edges.first + j - 1].label)) {
+                throw std::runtime_error("Malformed schema trie");
+            }
+        }
+    }
+    for (std::size_t i = 0; i < 256; ++i) {
+        checkRange(m_flags[i], m_header->matches.count);
+    }
+    checkRange(m_header->positional, m_header->matches.count);
+    checkString(m_header->program);
+    checkString(m_header->flagStart);
+    checkString(m_header->nameStart);
+    checkString(m_header->skip);
+}
+
+template<typename T>
+inline const T* SchemaView::table(const detail::SchemaTable& table, std::size_t size) const {
+    if (table.offset % alignof(T) != 0 || table.offset > size || table.count > (size - table.offset) / sizeof(T)) {
+        throw std::runtime_error("Schema table out of bounds");
+    }
+    return reinterpret_cast<const T*>(m_data + table.offset);
+}
+
+template<typename Syntax>
+inline void SchemaView::check_syntax() const {
+    if (std::strcmp(text(m_header->flagStart), Syntax::flagStart()) != 0 ||
+            std::strcmp(text(m_header->nameStart), Syntax::nameStart()) != 0 ||
+            std::strcmp(text(m_header->skip), Syntax::skip()) != 0 ||
+            m_header->nameDelim != static_cast<unsigned char>(Syntax::nameDelim())) {
+        throw std::logic_error("Schema was exported with a different syntax");
+    }
+}
+
+inline std::size_t SchemaView::select(const detail::SchemaRange& list, const std::vector<unsigned int>* counts) const {
+    if (list.count == 0u) {
+        return npos;
+    }
+    const std::uint32_t* first = m_matches + list.first;
+    if (counts != nullptr) {
+        for (std::uint32_t i = 0; i < list.count; ++i) {
+            const SchemaArgument& arg = m_arguments[first[i]];
+            if (arg.max == 0u || (*counts)[first[i]] < arg.max) {
+                return first[i];
+            }
+        }
+        return first[list.count - 1];
+    }
+    return first[0];
+}
+
+inline std::size_t SchemaView::node(const std::string& name) const {
+    std::size_t node = 0;
+    for (char c: name) {
+        const detail::SchemaEdge* first = m_edges + m_nodes[node].edges.first;
+        const detail::SchemaEdge* last = first + m_nodes[node].edges.count;
+        const std::uint32_t label = static_cast<unsigned char>(c);
+        first = std::lower_bound(first, last, label, [](const detail::SchemaEdge& edge, std::uint32_t label) {
+            return edge.label < label;
+        });
+        if (first == last || first->label != label) {
+            return npos;
+        }
+        node = first->child;
+    }
+    return node;
+}
+
+inline std::size_t SchemaView::find(char flag) const {
+    return select(m_flags[static_cast<unsigned char>(flag)], nullptr);
+}
+
+inline std::size_t SchemaView::find(const std::string& name) const {
+    std::size_t found = node(name);
+    return found == npos ? npos : select(m_nodes[found].matches, nullptr);
+}
+
+template<typename F>
+inline void SchemaView::visit(std::size_t node, std::string& name, F&& f) const {
+    // Nodes being visited with the position of their next edge. The trie
+    // comes from a file, so its depth is only bounded by its size
+    std::vector< std::pair<std::size_t, std::uint32_t> > stack;
+    if (m_nodes[node].matches.count > 0u) {
+        f(name, m_nodes[node].matches);
+    }
+    stack.emplace_back(node, 0u);
+    while (!stack.empty()) {
+        const detail::SchemaNode& current = m_nodes[stack.back().first];
+        if (stack.back().second == current.edges.count) {
+            stack.pop_back();
+            if (!stack.empty()) {
+                name.pop_back();
+            }
+            continue;
+        }
+        const detail::SchemaEdge& edge = m_edges[current.edges.first + stack.back().second++];
+        name += static_cast<char>(edge.label);
+        if (m_nodes[edge.child].matches.count > 0u) {
+            f(name, m_nodes[edge.child].matches);
+        }
+        stack.emplace_back(edge.child, 0u);
+    }
+}
+
+inline void SchemaView::complete(const std::string& prefix, std::vector<std::string>& names) const {
+    std::size_t start = node(prefix);
+    if (start == npos) {
+        return;
+    }
+    std::string name = prefix;
+    visit(start, name, [&names](const std::string& found, const detail::SchemaRange&) {
+        names.push_back(found);
+    });
+}
+
+/**
+ * Handler for detail::scan() that counts the occurrences of the arguments of
+ * a schema and checks the kind of their values, stopping at the first error
+ * (see SchemaView::validate()).
+ */
+class SchemaView::CheckHandler {
+public:
+    /** Entries found by the handler */
+    using Entry = SchemaArgument;
+
+protected:
+    /** Schema being validated with */
+    const SchemaView& m_view;
+    /** Occurrences by schema index */
+    std::vector<unsigned int> m_counts;
+    /** Argument last found */
+    const SchemaArgument* m_last = nullptr;
+    /** First error found */
+    SchemaResult m_result;
+
+    /** Returns the entry of a schema index, or nullptr for npos */
+    const SchemaArgument* entry(std::size_t index) const {
+        return index == npos ? nullptr : &m_view.m_arguments[index];
+    }
+
+    /** Returns the schema index of an entry */
+    std::size_t index(const SchemaArgument& entry) const {
+        return static_cast<std::size_t>(&entry - m_view.m_arguments);
+    }
+
+public:
+    /**
+     * Create a handler for the given schema.
+     * @param view Schema being validated with
+     */
+    explicit CheckHandler(const SchemaView& view) :
+        m_view(view), m_counts(view.size(), 0u) {
+    }
+
+    /** Find a positional argument */
+    const SchemaArgument* find() const {
+        return entry(m_view.select(m_view.m_header->positional, &m_counts));
+    }
+
+    /** Find an argument by flag */
+    const SchemaArgument* find(char flag) const {
+        return entry(m_view.select(m_view.m_flags[static_cast<unsigned char>(flag)], &m_counts));
+    }
+
+    /** Find an argument by name */
+    const SchemaArgument* find(const std::string& name) const {
+        std::size_t node = m_view.node(name);
+        return node == npos ? nullptr : entry(m_view.select(m_view.m_nodes[node].matches, &m_counts));
+    }
+
+    /** Count an occurrence, failing if the argument occurs too often */
+    ParseResult occur(const SchemaArgument& arg) {
+        m_last = &arg;
+        bool canSet = can_set(arg);
+        ++m_counts[index(arg)];
+        return canSet ? ParseResult() : ParseResult(ParseError::CountMismatch);
+    }
+
+    /** Arguments of a schema have no Argument to report */
+    const Argument* argument(const SchemaArgument&) const {
+        return nullptr;
+    }
+
+    /** Arguments are not set */
+    void set(const SchemaArgument&) const {
+    }
+
+    /** Check the kind of the value */
+    bool set(const SchemaArgument& arg, const std::string& value) const {
+        return detail::schema_accepts(static_cast<ValueKind>(arg.kind), value);
+    }
+
+    /** Stop at action arguments */
+    int action(const SchemaArgument& arg) const {
+        return arg.action;
+    }
+
+    /** Keep the first error and stop */
+    bool report(const ParseResult& result) {
+        m_result.error = result.error();
+        m_result.index = result.index();
+        m_result.offset = result.offset();
+        m_result.argument = result.error() == ParseError::UnknownArgument ? npos : index(*m_last);
+        return false;
+    }
+
+    /** Check whether the argument can be set once more */
+    bool can_set(const SchemaArgument& arg) const {
+        return arg.max == 0u || m_counts[index(arg)] < arg.max;
+    }
+
+    /**
+     * Check the occurrence counts once all tokens are read.
+     * @param argc Index reported with errors
+     * @return The first error found, including those reported while scanning
+     */
+    const SchemaResult& finish(std::size_t argc) {
+        for (std::size_t i = 0; i < m_counts.size() && m_result; ++i) {
+            const SchemaArgument& arg = m_view.m_arguments[i];
+            if (m_counts[i] > 0u && m_counts[i] < arg.min) {
+                m_result = SchemaResult{ParseError::CountMismatch, argc, 0u, i};
+            } else if (m_counts[i] == 0u && arg.required()) {
+                m_result = SchemaResult{ParseError::ConstraintViolated, argc, 0u, i};
+            }
+        }
+        return m_result;
+    }
+};
+
+/**
+ * Handler for detail::scan() that counts the occurrences of the arguments of
+ * a schema, remembering an argument missing its value (see
+ * SchemaView::completions() and ArgumentParser::CompleteHandler).
+ */
+class SchemaView::CompleteHandler : public CheckHandler {
+    /** Entry of the last token if its value is missing */
+    const SchemaArgument* m_pending = nullptr;
+
+public:
+    using CheckHandler::CheckHandler;
+
+    /** Values are not checked */
+    bool set(const SchemaArgument&, const std::string&) const {
+        return true;
+    }
+
+    /** Read past action arguments, the words after them are completed */
+    int action(const SchemaArgument&) const {
+        return 0;
+    }
+
+    using CheckHandler::set;
+
+    /** Ignore errors, only a missing value matters for completion */
+    bool report(const ParseResult& result) {
+        if (result.error() == ParseError::MissingValue) {
+            m_pending = this->m_last;
+        }
+        return true;
+    }
+
+    /** Returns the entry whose value is completed, or nullptr */
+    const SchemaArgument* pending() const {
+        return m_pending;
+    }
+
+    /** Add the choices of an argument starting with value, after lead */
+    void complete_value(const SchemaArgument& arg, const char* value, const std::string& lead, std::vector<std::string>& candidates) const {
+        const std::size_t length = std::strlen(value);
+        for (std::uint32_t i = 0; i < arg.choices.count; ++i) {
+            const char* choice = this->m_view.string(arg.choices, i);
+            if (std::strncmp(choice, value, length) == 0) {
+                candidates.push_back(lead + choice);
+            }
+        }
+        if (arg.files()) {
+            candidates.push_back(completeFiles);
+        }
+    }
+
+    /** Add the names starting with prefix that can be set */
+    void complete_names(const std::string& prefix, std::vector<std::string>& candidates) const {
+        std::size_t start = this->m_view.node(prefix);
+        if (start == npos) {
+            return;
+        }
+        const std::string nameStart = this->m_view.text(this->m_view.m_header->nameStart);
+        std::string name = prefix;
+        this->m_view.visit(start, name, [&](const std::string& found, const detail::SchemaRange& matches) {
+            if (this->can_set(*this->entry(this->m_view.select(matches, &this->m_counts)))) {
+                candidates.push_back(nameStart + found);
+            }
+        });
+    }
+
+    /** Add the flags that can be set */
+    void complete_flags(std::vector<std::string>& candidates) const {
+        const std::string flagStart = this->m_view.text(this->m_view.m_header->flagStart);
+        for (std::size_t flag = 0; flag < 256; ++flag) {
+            const SchemaArgument* arg = this->find(static_cast<char>(flag));
+            if (arg != nullptr && this->can_set(*arg)) {
+                candidates.push_back(flagStart + static_cast<char>(flag));
+            }
+        }
+    }
+};
+
+template<typename Syntax>
+inline SchemaResult SchemaView::validate(int argc, const char* const argv[]) const {
+    check_syntax<Syntax>();
+    const std::size_t count = argc > 0 ? static_cast<std::size_t>(argc) : 1u;
+    CheckHandler handler(*this);
+    ParseResult stopped = detail::scan<Syntax>(argv, count, handler);
+    if (stopped.action() != 0) {
+        // Errors stop scanning, so none were found before the action
+        SchemaResult result;
+        result.index = stopped.index();
+        result.action = stopped.action();
+        return result;
+    }
+    if (stopped.error() == ParseError::CheckFailed) {
+        // Thrown while scanning (e.g. std::bad_alloc), not reported to the
+        // handler
+        SchemaResult result;
+        result.error = stopped.error();
+        result.index = stopped.index();
+        return result;
+    }
+    return handler.finish(count);
+}
+
+template<typename Syntax>
+inline std::vector<std::string> SchemaView::completions(const char* const words[], std::size_t count, std::size_t index) const {
+    check_syntax<Syntax>();
+    std::vector<std::string> candidates;
+    if (index == 0 || index > count) {
+        return candidates;
+    }
+    CompleteHandler handler(*this);
+    detail::complete<Syntax>(words, count, index, handler, candidates);
+    return candidates;
+}
+
+#ifdef TAP_POSIX
+inline MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read " + path);
+    }
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size > 0) {
+        void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        m_data = static_cast<const char*>(data);
+    }
+    // The mapping stays valid without the descriptor
+    ::close(fd);
+}
+
+inline MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+#else
+inline MappedFile::MappedFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    m_buffer = contents.str();
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+inline MappedFile::~MappedFile() {
+}
+#endif
+
+}
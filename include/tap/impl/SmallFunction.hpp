@@ -0,0 +1,88 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <new>
+
+namespace TAP {
+
+namespace detail {
+
+template<typename R, typename ... Args, std::size_t Size>
+template<typename F>
+inline const typename SmallFunction<R(Args...), Size>::Ops& SmallFunction<R(Args...), Size>::ops_for() {
+    static const Ops ops = {
+        [](void* obj, Args... args) -> R {
+            return (*static_cast<F*>(obj))(std::forward<Args>(args)...);
+        },
+        [](void* dst, const void* src) {
+            ::new (dst) F(*static_cast<const F*>(src));
+        },
+        [](void* obj) {
+            static_cast<F*>(obj)->~F();
+        }
+    };
+    return ops;
+}
+
+template<typename R, typename ... Args, std::size_t Size>
+template<typename F, typename>
+inline SmallFunction<R(Args...), Size>::SmallFunction(F&& func) {
+    using Stored = typename std::decay<F>::type;
+    static_assert(sizeof(Stored) <= Size, "Callable too large for SmallFunction, capture by reference instead");
+    static_assert(alignof(Stored) <= alignof(std::max_align_t), "Callable alignment not supported by SmallFunction");
+    ::new (static_cast<void*>(&m_buffer)) Stored(std::forward<F>(func));
+    m_ops = &ops_for<Stored>();
+}
+
+template<typename R, typename ... Args, std::size_t Size>
+inline SmallFunction<R(Args...), Size>::SmallFunction(const SmallFunction& other) :
+    m_ops(other.m_ops) {
+    if (m_ops != nullptr) {
+        m_ops->copy(&m_buffer, &other.m_buffer);
+    }
+}
+
+template<typename R, typename ... Args, std::size_t Size>
+inline SmallFunction<R(Args...), Size>& SmallFunction<R(Args...), Size>::operator=(const SmallFunction& other) {
+    if (this != &other) {
+        if (m_ops != nullptr) {
+            m_ops->destroy(&m_buffer);
+            m_ops = nullptr;
+        }
+        if (other.m_ops != nullptr) {
+            other.m_ops->copy(&m_buffer, &other.m_buffer);
+            m_ops = other.m_ops;
+        }
+    }
+    return *this;
+}
+
+template<typename R, typename ... Args, std::size_t Size>
+inline SmallFunction<R(Args...), Size>::~SmallFunction() {
+    if (m_ops != nullptr) {
+        m_ops->destroy(&m_buffer);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,209 @@
+/**
+Copyright (c) 2015 Harold Bruintjes
+
+This software is provided 'as-is', without any express or implied
+warranty. In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgement in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+namespace TAP {
+
+namespace embedded {
+
+template<typename Def>
+constexpr typename StaticParser<Def>::SchemaType StaticParser<Def>::schema;
+
+template<typename Def>
+constexpr detail::SchemaTables<StaticParser<Def>::size> StaticParser<Def>::tables;
+
+template<typename Def>
+constexpr detail::StaticString<detail::help_length(StaticParser<Def>::schema) + 1> StaticParser<Def>::helpText;
+
+namespace detail {
+
+/** See SetTable */
+template<typename P, std::size_t ... I>
+struct SetTable<P, std::index_sequence<I...>> {
+    /** Setter by schema index */
+    static constexpr typename P::SetFunc functions[sizeof...(I)] = { &P::template set_value<I>... };
+};
+
+template<typename P, std::size_t ... I>
+constexpr typename P::SetFunc SetTable<P, std::index_sequence<I...>>::functions[sizeof...(I)];
+
+}
+
+template<typename Def>
+template<std::size_t I>
+inline Error StaticParser<Def>::set_value(StaticParser& parser, const char* value) {
+    return detail::store(value, std::get<I>(parser.m_values)) ? Error::None : Error::InvalidValue;
+}
+
+template<typename Def>
+inline std::size_t StaticParser<Def>::find_positional() const {
+    std::size_t found = StaticParseResult::npos;
+    for (std::size_t i = 0; i < tables.positionalCount; ++i) {
+        found = tables.positional[i];
+        const unsigned int max = schema.options[found].maxCount;
+        if (max == 0u || m_counts[found] < max) {
+            break;
+        }
+    }
+    return found;
+}
+
+template<typename Def>
+inline std::size_t StaticParser<Def>::find_name(const char* name, std::size_t length) {
+    const std::size_t slot = detail::name_hash(name, length, tables.seed) & (tables.nameSlots - 1u);
+    const std::size_t entry = tables.names[slot];
+    if (entry == 0u) {
+        return StaticParseResult::npos;
+    }
+    // A perfect hash maps unknown names anywhere, so compare the name
+    const char* candidate = schema.options[entry - 1].name;
+    if (std::strncmp(candidate, name, length) != 0 || candidate[length] != '\0') {
+        return StaticParseResult::npos;
+    }
+    return entry - 1;
+}
+
+template<typename Def>
+inline std::size_t StaticParser<Def>::find_flag(char flag) {
+    const unsigned char index = static_cast<unsigned char>(flag);
+    if (index >= 128u || tables.flags[index] == 0u) {
+        return StaticParseResult::npos;
+    }
+    return tables.flags[index] - 1u;
+}
+
+template<typename Def>
+inline Error StaticParser<Def>::set(std::size_t index, const char* value) {
+    const unsigned int max = schema.options[index].maxCount;
+    if (max != 0u && m_counts[index] >= max) {
+        return Error::TooManyOccurrences;
+    }
+    Error error = detail::SetTable<StaticParser, std::make_index_sequence<size>>::functions[index](*this, value);
+    if (error == Error::None) {
+        ++m_counts[index];
+        m_set |= std::uint64_t(1) << index;
+    }
+    return error;
+}
+
+/**
+ * Handler for detail::scan() that sets the values of a StaticParser. Entries
+ * are the descriptors in the schema.
+ */
+template<typename Def>
+class StaticParser<Def>::SetHandler {
+    /** Parser to set the values of */
+    StaticParser& m_parser;
+
+    /**
+     * Returns the descriptor of the argument with the given schema index.
+     * @param index Schema index, or StaticParseResult::npos
+     * @return The descriptor, nullptr for npos
+     */
+    static const detail::OptionInfo* entry(std::size_t index) {
+        return index == StaticParseResult::npos ? nullptr : &schema.options[index];
+    }
+
+public:
+    /** Entries found by the handler */
+    using Entry = const detail::OptionInfo;
+
+    /**
+     * Create a handler for the given parser.
+     * @param parser Parser to set the values of
+     */
+    explicit SetHandler(StaticParser& parser) : m_parser(parser) {
+    }
+
+    /**
+     * Returns the schema index of an entry.
+     * @param entry Entry found by the handler
+     * @return The schema index
+     */
+    static std::size_t index(const detail::OptionInfo& entry) {
+        return static_cast<std::size_t>(&entry - schema.options);
+    }
+
+    /** Find a positional argument */
+    const detail::OptionInfo* find() const {
+        return entry(m_parser.find_positional());
+    }
+
+    /** Find an argument by flag */
+    const detail::OptionInfo* find(char flag) const {
+        return entry(find_flag(flag));
+    }
+
+    /** Find an argument by name */
+    const detail::OptionInfo* find(const char* name, std::size_t length) const {
+        return entry(find_name(name, length));
+    }
+
+    /** Check whether an argument takes a value */
+    bool takes_value(const detail::OptionInfo& entry) const {
+        return entry.takesValue;
+    }
+
+    /** Set a switch */
+    Error set(const detail::OptionInfo& entry) const {
+        return m_parser.set(index(entry), nullptr);
+    }
+
+    /** Set an argument with value */
+    Error set(const detail::OptionInfo& entry, const char* value) const {
+        return m_parser.set(index(entry), value);
+    }
+};
+
+template<typename Def>
+inline StaticParseResult StaticParser<Def>::parse(int argc, const char* const argv[]) {
+    constexpr std::size_t npos = StaticParseResult::npos;
+    SetHandler handler(*this);
+    detail::ScanResult<const detail::OptionInfo> result = detail::scan<TAP::DefaultSyntax>(argc, argv, handler);
+    if (result.error != Error::None) {
+        return StaticParseResult{result.error, result.index, result.entry == nullptr ? npos : SetHandler::index(*result.entry)};
+    }
+
+    // Both checks only need the mask of set arguments
+    const std::uint64_t missing = tables.required & ~m_set;
+    if (missing != 0u) {
+        std::size_t index = 0;
+        while ((missing & (std::uint64_t(1) << index)) == 0u) {
+            ++index;
+        }
+        return StaticParseResult{Error::MissingRequired, argc, index};
+    }
+    for (std::size_t i = 0; i < schema.exclusionCount; ++i) {
+        const std::uint64_t both = schema.exclusions[i] & m_set;
+        if ((both & (both - 1u)) != 0u) {
+            std::size_t index = 0;
+            while ((both & (std::uint64_t(1) << index)) == 0u) {
+                ++index;
+            }
+            return StaticParseResult{Error::Conflict, argc, index};
+        }
+    }
+    return StaticParseResult{Error::None, argc, npos};
+}
+
+}
+
+}
@@ -85,6 +85,26 @@ namespace detail {
         return true;
     }
 
+    /**
+     * Check whether value can be converted for storage, without modifying it.
+     * Converts into a copy of the current value, like TAP_STREAMSAFE.
+     */
+    template<typename T>
+    inline bool checkValue(const std::string& value, const T& storage) {
+        T local = storage;
+        return setValue(value, local);
+    }
+
+    /**
+     * Check whether value can be converted to an element of storage, without
+     * appending it.
+     */
+    template<typename T>
+    inline bool checkValue(const std::string& value, const std::vector<T>&) {
+        T local;
+        return setValue(value, local);
+    }
+
     /**
      * Placeholder for boolean assignment, this function should never be called.
      */
@@ -101,25 +121,49 @@ inline void VariableArgument<T,multi>::set() const {
 
 template<typename T, bool multi>
 inline void VariableArgument<T,multi>::set(const std::string& value) const {
+    if (!try_set(value)) {
+        throw argument_invalid_value(*this, value);
+    }
+}
+
+template<typename T, bool multi>
+inline bool VariableArgument<T,multi>::try_set(const std::string& value) const {
     // Load value
     if (!detail::setValue(value, *m_storage)) {
-        throw argument_invalid_value(*this, value);
+        return false;
     }
     // Run any configured check function
     TypedArgument<T, multi>::check();
     // Mark argument set
     Argument::set();
+    return true;
+}
+
+template<typename T, bool multi>
+inline bool VariableArgument<T,multi>::set_value(const Argument& arg, const std::string& value) {
+    return static_cast<const VariableArgument&>(arg).try_set(value);
+}
+
+template<typename T, bool multi>
+inline bool VariableArgument<T,multi>::accepts(const std::string& value) const {
+    return detail::checkValue(value, *m_storage);
+}
+
+template<typename T, bool multi>
+inline bool VariableArgument<T,multi>::check_value(const Argument& arg, const std::string& value) {
+    return static_cast<const VariableArgument&>(arg).accepts(value);
 }
 
 template<typename T, bool multi>
 inline std::string VariableArgument<T,multi>::usage() const {
     std::string usageStr;
     if (!this->m_isPositional) {
+        const Markers& markers = Markers::current();
         if (this->m_flags.length() > 0u) {
             // Print first flag only, aliases generally not needed
-            usageStr = std::string(flagStart) + this->m_flags[0];
+            usageStr = std::string(markers.flagStart) + this->m_flags[0];
         } else {
-            usageStr = std::string(nameStart) + this->m_names[0];
+            usageStr = std::string(markers.nameStart) + this->m_names[0];
         }
 
         usageStr += " ";
@@ -0,0 +1,150 @@
+/*
+ * Bench.cpp
+ *
+ *  Measures the time to build, freeze and parse with parsers of increasing
+ *  size. Each phase should scale linearly with the number of arguments, so
+ *  the time per argument should stay roughly constant. Also reports the number
+ *  of heap allocations made by a repeated parse, which should be zero.
+ */
+
+#include "tap/Tap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace TAP;
+
+namespace {
+
+/** Number of calls to the global operator new */
+std::size_t allocations = 0;
+
+}
+
+// Keep the replacements out of line, inlining them confuses GCC's
+// new/delete mismatch warnings
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t size) {
+    ++allocations;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+BENCH_NOINLINE void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+BENCH_NOINLINE void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+void bench(std::size_t size) {
+    std::vector< ValueArgument<int> > arguments;
+    arguments.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        arguments.emplace_back("", "option-" + std::to_string(i), 0);
+    }
+
+    Clock::time_point start = Clock::now();
+    ArgumentParser parser;
+    parser.reserve(size).addRange(arguments.begin(), arguments.end());
+    parser.allow_duplicates(false);
+    double build = elapsed(start);
+
+    start = Clock::now();
+    parser.freeze();
+    double freeze = elapsed(start);
+
+    // The first parse sizes the buffers of the parser, later ones reuse them
+    std::string middle = "--option-" + std::to_string(size / 2) + "=3";
+    const char* warm[] = { "bench", middle.c_str() };
+    parser.parse(2, warm);
+
+    std::string first = "--option-0=1";
+    std::string last = "--option-" + std::to_string(size - 1) + "=2";
+    const char* argv[] = { "bench", first.c_str(), last.c_str() };
+    std::size_t allocated = allocations;
+    start = Clock::now();
+    parser.parse(3, argv);
+    double parse = elapsed(start);
+    allocated = allocations - allocated;
+
+    // Mistyped name, close to many others
+    std::string typo = "optoin-" + std::to_string(size / 2);
+    parser.suggest(typo);
+    start = Clock::now();
+    std::vector<std::string> suggestions = parser.suggest(typo);
+    double suggest = elapsed(start);
+
+    std::printf("%8zu %12.1f %12.1f %12.1f %12zu %12.1f\n", size,
+            build / static_cast<double>(size),
+            freeze / static_cast<double>(size),
+            parse / static_cast<double>(size),
+            allocated,
+            suggest / 1000.0);
+}
+
+void benchValidate(std::size_t lines) {
+    Argument verbose("", 'v', "verbose");
+    ValueArgument<int> jobs("", 'j', "jobs", 1);
+    ValueArgument<std::string> queue("", 'q', "queue", std::string("default"));
+    ValueArgument<std::string> input("", "input", std::string());
+    ArgumentParser parser(verbose, jobs, queue, +input);
+    parser.freeze();
+
+    // Half of the command lines have several problems
+    const char* valid[] = { "job", "-v", "-j4", "--queue=batch", "--input=a.dat" };
+    const char* invalid[] = { "job", "-vx", "--jobs=four", "--priority", "-j" };
+
+    ValidationResult result;
+    std::size_t rejected = 0;
+    std::size_t errors = 0;
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < lines; ++i) {
+        const char* const* argv = (i % 2 == 0) ? valid : invalid;
+        if (!parser.validate(5, argv, result)) {
+            ++rejected;
+            errors += result.errors().size();
+        }
+    }
+    double validate = elapsed(start);
+
+    std::printf("%8zu %12.0f %12zu %12zu\n", lines,
+            static_cast<double>(lines) / validate * 1e9,
+            rejected, errors);
+}
+
+}
+
+int main() {
+    std::printf("%8s %12s %12s %12s %12s %12s\n", "args", "build ns/arg", "freeze ns/arg", "parse ns/arg", "parse allocs", "suggest us");
+    for (std::size_t size = 1000; size <= 64000; size *= 2) {
+        bench(size);
+    }
+
+    std::printf("\n%8s %12s %12s %12s\n", "lines", "lines/s", "rejected", "errors");
+    for (std::size_t lines = 10000; lines <= 160000; lines *= 4) {
+        benchValidate(lines);
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Embedded.cpp
+ *
+ *  Tests the embedded profile (see TAP_EMBEDDED). Build without exceptions to
+ *  check the profile does not need them, for example:
+ *    g++ -std=c++14 -fno-exceptions -fno-rtti -Iinclude test/Embedded.cpp
+ *  The global operator new is replaced to check that parsing never allocates.
+ */
+
+#define TAP_EMBEDDED 1
+#include "tap/Tap.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace TAP::embedded;
+
+namespace {
+
+/** Number of calls to the global operator new */
+std::size_t allocations = 0;
+
+}
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        std::abort();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void testEmbeddedParse() {
+    Argument verbose("", 'v', "verbose");
+    Argument quiet("", 'q');
+    ValueArgument<int> jobs("", 'j', "jobs", 1);
+    ValueArgument<double> ratio("", "ratio", 0.5);
+    ValueArgument<const char*> output("", 'o');
+    MultiValueArgument<int, 4> files("");
+    ArgumentSet<2> logging("Logging", verbose, quiet);
+    ArgumentParser<8> parser(logging, jobs, ratio, output, files);
+
+    const char* argv[] = { "embedded", "-vqj4", "--ratio=0.25", "-o", "out", "1", "--", "-3" };
+    ParseResult result = parser.parse(8, argv);
+    assert(result);
+    assert(result.index == 8);
+    assert(verbose.count() == 1);
+    assert(quiet);
+    assert(jobs.value() == 4);
+    assert(ratio.value() == 0.25);
+    assert(std::strcmp(output.value(), "out") == 0);
+    // After the skip token, flags are taken as values
+    assert(files.value().size() == 2);
+    assert(files.value()[0] == 1);
+    assert(files.value()[1] == -3);
+    assert(files.count() == 2);
+
+    // Arguments keep their counts, so parsing again fails
+    ParseResult invalid = parser.parse(8, argv);
+    assert(invalid.error == Error::TooManyOccurrences);
+    assert(invalid.index == 1);
+    assert(invalid.argument == &verbose);
+}
+
+void testEmbeddedErrors() {
+    Argument verbose("", 'v');
+    ValueArgument<short> level("", 'l', "level", 0);
+    ValueArgument<unsigned char> positional("");
+    ArgumentParser<3> parser(verbose, level, positional);
+    level.set_required();
+
+    const char* unknown[] = { "embedded", "-x" };
+    ParseResult result = parser.parse(2, unknown);
+    assert(result.error == Error::UnknownArgument);
+    assert(result.index == 1);
+    assert(result.argument == nullptr);
+
+    const char* missing[] = { "embedded", "--level" };
+    result = parser.parse(2, missing);
+    assert(result.error == Error::MissingValue);
+    assert(result.argument == &level);
+
+    const char* range[] = { "embedded", "-l", "100000" };
+    result = parser.parse(3, range);
+    assert(result.error == Error::InvalidValue);
+    assert(result.argument == &level);
+    assert(level.value() == 0);
+
+    const char* negative[] = { "embedded", "-1" };
+    result = parser.parse(2, negative);
+    assert(result.error == Error::UnknownArgument);
+
+    const char* noValue[] = { "embedded", "--", "-1" };
+    result = parser.parse(3, noValue);
+    assert(result.error == Error::InvalidValue);
+    assert(result.index == 2);
+    assert(result.argument == &positional);
+
+    const char* required[] = { "embedded", "-v" };
+    result = parser.parse(2, required);
+    assert(result.error == Error::MissingRequired);
+    assert(result.index == 2);
+    assert(result.argument == &level);
+    assert(std::strcmp(error_string(result.error), "Required argument missing") == 0);
+}
+
+void testEmbeddedCapacity() {
+    Argument a("", 'a');
+    Argument b("", 'b');
+    Argument c("", 'c');
+    ArgumentParser<2> parser;
+    assert(parser.add(a));
+    assert(parser.add(b));
+    assert(!parser.add(c));
+
+    const char* argv[] = { "embedded", "-a" };
+    ParseResult result = parser.parse(2, argv);
+    assert(result.error == Error::CapacityExceeded);
+
+    MultiValueArgument<int, 2> values("", 'i');
+    values.max(0);
+    ArgumentParser<1> multi(values);
+    const char* many[] = { "embedded", "-i1", "-i2", "-i3" };
+    result = multi.parse(4, many);
+    assert(result.error == Error::CapacityExceeded);
+    assert(result.index == 3);
+    assert(values.value().size() == 2);
+}
+
+/** Schema of the StaticParser tests */
+struct StaticOptions {
+    enum Key { Verbose, Jobs, Ratio, Name, Fast, Slow, Input, Rest };
+
+    static constexpr auto schema() {
+        return make_schema(
+            option<bool>('v', "verbose", "Be verbose").max(0),
+            option<int>('j', "jobs", "Number of jobs", 1),
+            option<double>('\0', "ratio", "Ratio", 0.5),
+            option<const char*>('n', "name", "Name", "none"),
+            option<bool>('f', "fast", "Go fast"),
+            option<bool>('s', "slow", "Go slow"),
+            positional<const char*>("input", "Input file").set_required(),
+            positional<unsigned int>("rest", "Remaining numbers").max(0)
+        ).exclude(Fast, Slow);
+    }
+};
+
+void testStaticParser() {
+    using Parser = StaticParser<StaticOptions>;
+    // Tables are computed by the compiler
+    static_assert(Parser::tables.flags['j'] == StaticOptions::Jobs + 1, "Flag table");
+    static_assert(Parser::tables.positionalCount == 2, "Positional arguments");
+    static_assert(Parser::tables.required == (1u << StaticOptions::Input), "Required arguments");
+
+    Parser parser;
+    assert(parser.get<StaticOptions::Jobs>() == 1);
+    assert(std::strcmp(parser.get<StaticOptions::Name>(), "none") == 0);
+
+    const char* argv[] = { "static", "-vvj4", "--ratio=0.25", "--name", "tap", "in", "1", "--", "2" };
+    StaticParseResult result = parser.parse(9, argv);
+    assert(result);
+    assert(result.index == 9);
+    assert(parser.count<StaticOptions::Verbose>() == 2);
+    assert(parser.get<StaticOptions::Verbose>());
+    assert(parser.get<StaticOptions::Jobs>() == 4);
+    assert(parser.get<StaticOptions::Ratio>() == 0.25);
+    assert(std::strcmp(parser.get<StaticOptions::Name>(), "tap") == 0);
+    assert(std::strcmp(parser.get<StaticOptions::Input>(), "in") == 0);
+    assert(parser.get<StaticOptions::Rest>() == 2);
+    assert(parser.count<StaticOptions::Rest>() == 2);
+    assert(!parser.is_set<StaticOptions::Fast>());
+
+    // Counts are kept until reset
+    result = parser.parse(9, argv);
+    assert(result.error == Error::TooManyOccurrences);
+    assert(result.index == 1);
+    assert(result.option == StaticOptions::Jobs);
+    parser.reset();
+    assert(parser.get<StaticOptions::Jobs>() == 1);
+    assert(!parser.is_set<StaticOptions::Verbose>());
+
+    const char* unknown[] = { "static", "--verbos" };
+    result = parser.parse(2, unknown);
+    assert(result.error == Error::UnknownArgument);
+    assert(result.option == StaticParseResult::npos);
+
+    const char* value[] = { "static", "--verbose=1" };
+    assert(parser.parse(2, value).error == Error::NoValue);
+    parser.reset();
+
+    const char* invalid[] = { "static", "-j", "four" };
+    result = parser.parse(3, invalid);
+    assert(result.error == Error::InvalidValue);
+    assert(result.index == 2);
+    assert(parser.get<StaticOptions::Jobs>() == 1);
+    parser.reset();
+
+    const char* required[] = { "static", "-v" };
+    result = parser.parse(2, required);
+    assert(result.error == Error::MissingRequired);
+    assert(result.index == 2);
+    assert(result.option == StaticOptions::Input);
+    parser.reset();
+
+    const char* conflict[] = { "static", "-fs", "in" };
+    result = parser.parse(3, conflict);
+    assert(result.error == Error::Conflict);
+    assert(result.option == StaticOptions::Fast);
+    parser.reset();
+
+    assert(std::strstr(Parser::help(), "  -v, --verbose  Be verbose\n") == Parser::help());
+    assert(std::strstr(Parser::help(), "  --ratio        Ratio\n") != nullptr);
+    assert(std::strstr(Parser::help(), "  input          Input file\n") != nullptr);
+}
+
+int main() {
+    testEmbeddedParse();
+    testEmbeddedErrors();
+    testEmbeddedCapacity();
+    testStaticParser();
+    // None of the above may allocate
+    assert(allocations == 0);
+    return 0;
+}
@@ -15,7 +15,7 @@ int main(int argc, const char* argv[]) {
     try {
         parser.parse(argc, argv);
     } catch (TAP::exception& e) {
-        std::cerr << e.what() << std::endl;
+        fprintf(stderr, "%s\n", e.what());
         return 1;
     }
     if (badExit) {
@@ -32,8 +32,13 @@ int main(int argc, const char* argv[]) {
 #define TAP_AUTOFLAG 1
 #include "tap/Tap.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 
 using namespace TAP;
 
@@ -335,6 +340,40 @@ void testArgumentCheckExcept() {
     }
 }
 
+void testArgumentCheckCopy() {
+    // Counts live copies of the callable
+    struct Counted {
+        int* live;
+        int* calls;
+        Counted(int* l, int* c): live(l), calls(c) { ++*live; }
+        Counted(const Counted& other): live(other.live), calls(other.calls) { ++*live; }
+        ~Counted() { --*live; }
+        void operator()(const Argument&) const { ++*calls; }
+    };
+    int live = 0;
+    int calls = 0;
+    {
+        Argument arg1("", 'a');
+        ArgumentCheckFunc func;
+        assert(func == nullptr);
+        func = Counted(&live, &calls);
+        assert(func != nullptr);
+        arg1.check(func);
+        assert(live == 2);
+
+        // Copying the argument copies the callable
+        Argument arg2 = arg1;
+        assert(live == 3);
+        arg2.set();
+        assert(calls == 1);
+
+        func = nullptr;
+        assert(!func);
+        assert(live == 2);
+    }
+    assert(live == 0);
+}
+
 //////////////////////
 // Valued arguments //
 //////////////////////
@@ -1026,6 +1065,1418 @@ void testArgumentAutoFlag() {
     assert(!arg3.matches("test"));
 }
 
+void testArgumentMarkup() {
+    // Parsed by the compiler
+    static constexpr auto help = TAP::markup("Show this &help text, or \\%not");
+    static_assert(help.flagCount == 1 && help.flags[0] == 'h', "Markup flags");
+    static_assert(help.nameCount == 1 && help.names[0] == 'h' && help.names[4] == '\0', "Markup names");
+    Argument arg1(help);
+    assert(arg1.matches('h'));
+    assert(arg1.matches("help"));
+    assert(!arg1.matches('n'));
+    assert(arg1.description() == "Show this help text, or %not");
+
+    static constexpr auto value = TAP::markup("Set $level and %x, $mode");
+    ValueArgument<int> arg2(value, 3);
+    assert(arg2.value() == 3);
+    assert(arg2.flags() == "x");
+    assert(arg2.names().size() == 2 && arg2.names()[0] == "level" && arg2.names()[1] == "mode");
+    assert(!arg2.matches());
+
+    // Same result as the runtime markers, even for odd input
+    ValueArgument<int> runtime1("Set $level and %x, $mode");
+    assert(runtime1.description() == arg2.description());
+    static constexpr auto odd = TAP::markup("\\a%b $ &\\%&");
+    ValueArgument<int> arg3(odd);
+    ValueArgument<int> runtime3("\\a%b $ &\\%&");
+    assert(arg3.description() == runtime3.description());
+    assert(arg3.flags() == runtime3.flags());
+    assert(arg3.names() == runtime3.names());
+
+    static constexpr auto positional = TAP::markup("Input file");
+    ValueArgument<std::string> arg4(positional);
+    assert(arg4.matches());
+}
+
+/////////////////
+// Constraints //
+/////////////////
+void testConstraintCounting() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    Argument arg3("", 'c');
+
+    ArgumentConstraint<ConstraintType::AtMostOne> atMostOne(arg1, arg2, arg3);
+    ArgumentConstraint<ConstraintType::AtLeast> atLeast(arg1, arg2, arg3);
+    atLeast.bound(2);
+    ArgumentConstraint<ConstraintType::Exactly> exactly(arg1, arg2, arg3);
+    exactly.bound(2);
+    ArgumentConstraint<ConstraintType::All> all(arg1, arg2, arg3);
+
+    atMostOne.check_valid();
+    arg1.set();
+    atMostOne.check_valid();
+    try {
+        atLeast.check_valid();
+        assert(false);
+    } catch (constraint_error& e) {
+        // Ok
+    }
+
+    arg2.set();
+    atLeast.check_valid();
+    exactly.check_valid();
+    try {
+        atMostOne.check_valid();
+        assert(false);
+    } catch (constraint_error& e) {
+        // Ok
+    }
+    try {
+        all.check_valid();
+        assert(false);
+    } catch (constraint_error& e) {
+        // Ok
+    }
+
+    arg3.set();
+    all.check_valid();
+    try {
+        exactly.check_valid();
+        assert(false);
+    } catch (constraint_error& e) {
+        // Ok
+    }
+}
+
+void testConstraintProgram() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    Argument arg3("", 'c');
+    Argument arg4("", 'd');
+
+    ArgumentConstraint<ConstraintType::One> one(arg1, arg2);
+    ArgumentConstraint<ConstraintType::All> all(arg3, arg4);
+    ArgumentSet set("", one, all);
+
+    detail::ConstraintProgram program;
+    program.add_root(set);
+    assert(program.size() == 4);
+
+    std::vector<detail::BitSet> results(4, detail::BitSet(program.size()));
+    // Nothing set: both constraints optional
+    // Both alternatives set
+    results[1].set(program.index(arg1));
+    results[1].set(program.index(arg2));
+    // One alternative and only part of all
+    results[2].set(program.index(arg1));
+    results[2].set(program.index(arg3));
+    // One alternative and all
+    results[3].set(program.index(arg2));
+    results[3].set(program.index(arg3));
+    results[3].set(program.index(arg4));
+
+    std::vector<std::size_t> failed;
+    program.check(results, failed);
+    assert(failed[0] == detail::ConstraintProgram::npos);
+    assert(failed[1] != detail::ConstraintProgram::npos);
+    assert(failed[2] != detail::ConstraintProgram::npos);
+    assert(failed[3] == detail::ConstraintProgram::npos);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        assert(program.check(results[i]) == failed[i]);
+    }
+}
+
+void testArgumentParserConstraint() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    Argument arg3("", 'c');
+
+    std::array<const char*, 3> args = {
+            "", "-a", "-b"
+    };
+
+    ArgumentParser p(ArgumentConstraint<ConstraintType::AtMostOne>(arg1, arg2), arg3);
+    try {
+        p.parse(static_cast<int>(args.size()), args.data());
+        assert(false);
+    } catch(constraint_error& e) {
+        // OK
+    }
+    assert(p.frozen());
+}
+
+void testArgumentParserFailFast() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    ValueArgument<int> arg3("", 'c');
+    int checked = 0;
+    arg3.check_typed([&checked] (const TypedArgument<int>&, const int&) -> void {++checked;});
+
+    std::array<const char*, 5> args = {
+            "", "-a", "-b", "-c", "1"
+    };
+
+    ArgumentParser p(arg1 ^ arg2, arg3);
+    p.fail_fast();
+    try {
+        p.parse(static_cast<int>(args.size()), args.data());
+        assert(false);
+    } catch(constraint_error& e) {
+        // OK
+    }
+    // Aborted before reaching the value
+    assert(!arg2 && !arg3 && checked == 0);
+}
+
+void testArgumentParserCheckValues() {
+    ValueArgument<int> min("", "min", 0);
+    ValueArgument<int> max("", "max", 10);
+    ValueArgument<std::string> format("", "format", std::string("text"));
+    ValueArgument<std::string> schema("", "schema", std::string());
+
+    ArgumentConstraint<ConstraintType::Any> output(format, schema);
+    int evaluated = 0;
+    output.check_values("Parquet requires a schema: ",
+            [&evaluated](const ValueArgument<std::string>& f, const ValueArgument<std::string>& s) {
+                ++evaluated;
+                return f.value() != "parquet" || s.is_set();
+            }, format, schema);
+
+    ArgumentParser p(min, max, output);
+    p.check_values("Minimum may not exceed maximum: ",
+            [](const ValueArgument<int>& lo, const ValueArgument<int>& hi) {
+                return lo.value() <= hi.value();
+            }, min, max);
+
+    std::array<const char*, 3> args1 = {
+            "", "--min=5", "--format=parquet"
+    };
+    try {
+        p.parse(static_cast<int>(args1.size()), args1.data());
+        assert(false);
+    } catch(constraint_error& e) {
+        // OK
+    }
+    assert(evaluated == 1);
+
+    std::array<const char*, 3> args2 = {
+            "", "--max=3", "--schema=s"
+    };
+    try {
+        p.parse(static_cast<int>(args2.size()), args2.data());
+        assert(false);
+    } catch(constraint_error& e) {
+        // Schema is now set, range fails
+        assert(std::string(e.what()).find("Minimum") == 0);
+    }
+    assert(evaluated == 2);
+}
+
+void testConstraintOperators() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    Argument arg3("", 'c');
+    Argument arg4("", 'd');
+
+    // Chains are flattened into a single constraint
+    ArgumentConstraint<ConstraintType::One> one = arg1 ^ arg2 ^ arg3;
+    assert(one.size() == 3);
+    assert(one.usage() == "-a | -b | -c");
+    ArgumentConstraint<ConstraintType::One> one2 = arg1 ^ (arg2 ^ arg3);
+    assert(one2.size() == 3);
+
+    ArgumentConstraint<ConstraintType::Any> req = +(arg1 | arg2);
+    assert(req.required() && req.size() == 2);
+
+    // Nested expressions keep their own type
+    ArgumentConstraint<ConstraintType::Any> nested = (arg1 ^ arg2) | arg3;
+    assert(nested.size() == 2);
+    assert(nested.usage() == "[ -a | -b ] [ -c ]");
+
+    std::array<const char*, 3> args = {
+            "", "-b", "-d"
+    };
+
+    ArgumentParser p(arg1 ^ arg2 ^ arg3, arg4);
+    p.parse(static_cast<int>(args.size()), args.data());
+    assert(!arg1 && arg2 && !arg3 && arg4);
+}
+
+void testConstraintShared() {
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+    Argument arg3("", 'c');
+
+    // Copies share their contents until modified
+    ArgumentConstraint<ConstraintType::Any> any(arg1, arg2);
+    ArgumentConstraint<ConstraintType::Any> copy(any);
+    copy += arg3;
+    assert(any.size() == 2 && copy.size() == 3);
+    assert(any.usage() == "[ -a ] [ -b ]");
+    assert(copy.usage() == "[ -a ] [ -b ] [ -c ]");
+
+    std::array<const char*, 2> args = {
+            "", "-c"
+    };
+
+    std::unique_ptr<ArgumentParser> p(new ArgumentParser(any, arg3));
+    p->freeze();
+    ArgumentParser q(*p);
+    assert(!q.frozen());
+    p.reset();
+    q.parse(static_cast<int>(args.size()), args.data());
+    assert(!arg1 && !arg2 && arg3);
+}
+
+void testArgumentParserBulk() {
+    std::vector<Argument> arguments;
+    for (int i = 0; i < 100; ++i) {
+        arguments.emplace_back("", "opt" + std::to_string(i));
+    }
+
+    ArgumentParser p;
+    p.reserve(arguments.size()).addRange(arguments.begin(), arguments.end());
+    p.allow_duplicates(false);
+
+    std::array<const char*, 3> args = {
+            "", "--opt42", "--opt99"
+    };
+    p.parse(static_cast<int>(args.size()), args.data());
+    assert(arguments[42] && arguments[99] && !arguments[0]);
+    assert(p["opt42"].key() == arguments[42].key());
+
+    // The same argument twice is no duplicate, a different one is
+    ArgumentParser p2(arguments[0], arguments[0] | arguments[1]);
+    p2.allow_duplicates(false).freeze();
+    Argument other("", "opt1");
+    p2.add(other);
+    try {
+        p2.freeze();
+        assert(false);
+    } catch(std::logic_error& e) {
+        assert(std::string(e.what()) == "Duplicate argument --opt1");
+    }
+    p2.allow_duplicates();
+    p2.freeze();
+}
+
+void testPatternArgument() {
+    PatternArgument<unsigned int, double> weights("", "shard-", "-weight");
+    PatternArgument<std::string, bool> features("", "feature.");
+    ValueArgument<int> exact("", "shard-1-weight", 0);
+
+    std::array<const char*, 7> args = {
+            "", "--shard-0-weight=0.5", "--shard-12-weight", "2",
+            "--feature.fast", "--shard-1-weight=3", "--feature.x"
+    };
+
+    ArgumentParser p(weights, features, exact);
+    p.parse(static_cast<int>(args.size()), args.data());
+    assert(weights.count() == 2 && weights.values().size() == 2);
+    assert(weights.values().at(0) == 0.5 && weights.values().at(12) == 2.0);
+    assert(features.values().size() == 2 && features.values().at("fast"));
+    assert(exact.value() == 3);
+    assert(weights.usage() == "--shard-<key>-weight value");
+
+    // Key does not convert
+    std::array<const char*, 2> args2 = {
+            "", "--shard-x-weight=1"
+    };
+    try {
+        p.parse(static_cast<int>(args2.size()), args2.data());
+        assert(false);
+    } catch(unknown_argument& e) {
+        // OK
+    }
+}
+
+void testArgumentParserNamespace() {
+    int loadedDb = 0;
+    int loadedHttp = 0;
+    ValueArgument<int> poolSize("Pool size", "db.pool.size", 8);
+    ValueArgument<std::string> host("Host", "db.host", std::string());
+
+    ArgumentParser p;
+    p.add_namespace("db", "Database", [&](ArgumentSet& args) {
+        ++loadedDb;
+        args.add(host);
+    });
+    p.add_namespace("db.pool", "Connection pool", [&](ArgumentSet& args) {
+        ++loadedDb;
+        args.add(+poolSize);
+    });
+    p.add_namespace("http.tls", "TLS", [&](ArgumentSet& args) {
+        ++loadedHttp;
+        args.add(Argument("Certificate", "http.tls.cert"));
+    });
+
+    std::array<const char*, 3> args = {
+            "", "--db.pool.size=16", "--db.host=local"
+    };
+    p.parse(static_cast<int>(args.size()), args.data());
+    assert(poolSize.value() == 16 && host.value() == "local");
+    assert(loadedDb == 2 && loadedHttp == 0);
+
+    assert(p.help().find("--http.tls.*") != std::string::npos);
+    assert(loadedHttp == 0);
+    assert(p.help("http.tls").find("--http.tls.cert") != std::string::npos);
+    assert(loadedHttp == 1);
+
+    std::array<const char*, 2> args2 = {
+            "", "--db.pool.other=1"
+    };
+    try {
+        p.parse(static_cast<int>(args2.size()), args2.data());
+        assert(false);
+    } catch(unknown_argument& e) {
+        // OK
+    }
+}
+
+void testArgumentParserTryParse() {
+    Argument verbose("", 'v');
+    ValueArgument<int> level("", 'l', "level", 0);
+    ValueArgument<int> answer("", "answer", 0);
+    answer.check_typed([](const TypedArgument<int>&, const int& value) {
+        if (value != 42) {
+            throw TAP::exception("That is not the answer");
+        }
+    });
+    ArgumentParser p(verbose, +level, answer);
+
+    std::array<const char*, 3> ok = { "", "-vl3", "--answer=42" };
+    ParseResult result = p.try_parse(static_cast<int>(ok.size()), ok.data());
+    assert(result && result.error() == ParseError::None);
+    assert(verbose.count() == 1 && level.value() == 3);
+
+    std::array<const char*, 2> unknownFlag = { "", "-vx" };
+    result = p.try_parse(static_cast<int>(unknownFlag.size()), unknownFlag.data());
+    assert(!result && result.error() == ParseError::UnknownArgument);
+    assert(result.index() == 1 && result.offset() == 2 && result.flag() == 'x');
+    try {
+        p.raise(result, static_cast<int>(unknownFlag.size()), unknownFlag.data());
+        assert(false);
+    } catch(unknown_argument& e) {
+        assert(std::string(e.what()).find("flag argument x") != std::string::npos);
+    }
+
+    std::array<const char*, 3> invalid = { "", "--level", "three" };
+    result = p.try_parse(static_cast<int>(invalid.size()), invalid.data());
+    assert(result.error() == ParseError::InvalidValue);
+    assert(result.index() == 2 && result.argument()->key() == level.key());
+    try {
+        p.parse(static_cast<int>(invalid.size()), invalid.data());
+        assert(false);
+    } catch(argument_invalid_value& e) {
+        assert(std::string(e.what()).find("three") != std::string::npos);
+    }
+
+    std::array<const char*, 2> missing = { "", "-l" };
+    result = p.try_parse(static_cast<int>(missing.size()), missing.data());
+    assert(result.error() == ParseError::MissingValue && result.index() == 1);
+
+    // Check functions are the only source of exceptions
+    std::array<const char*, 2> wrong = { "", "--answer=41" };
+    result = p.try_parse(static_cast<int>(wrong.size()), wrong.data());
+    assert(result.error() == ParseError::CheckFailed && result.index() == 1);
+    assert(result.exception() != nullptr);
+    try {
+        p.raise(result, static_cast<int>(wrong.size()), wrong.data());
+        assert(false);
+    } catch(TAP::exception& e) {
+        assert(std::string(e.what()) == "That is not the answer");
+    }
+
+    // Including exceptions from outside the library
+    ValueArgument<std::string> port("", "port", std::string());
+    port.check_typed([](const TypedArgument<std::string>&, const std::string& value) {
+        std::stoi(value);
+    });
+    ArgumentParser p3(port);
+    std::array<const char*, 2> notNumber = { "", "--port=http" };
+    result = p3.try_parse(static_cast<int>(notNumber.size()), notNumber.data());
+    assert(result.error() == ParseError::CheckFailed && result.argument()->key() == port.key());
+    try {
+        p3.parse(static_cast<int>(notNumber.size()), notNumber.data());
+        assert(false);
+    } catch(std::invalid_argument&) {
+        // OK
+    }
+
+    // Errors found after reading all arguments refer past the last one
+    Argument required("", 'r');
+    Argument quiet("", 'q');
+    ArgumentParser p2(+required, quiet);
+    std::array<const char*, 1> none = { "" };
+    result = p2.try_parse(static_cast<int>(none.size()), none.data());
+    assert(result.error() == ParseError::ConstraintViolated && result.index() == 1);
+    try {
+        p2.raise(result, static_cast<int>(none.size()), none.data());
+        assert(false);
+    } catch(argument_count_mismatch& e) {
+        assert(std::string(e.what()).find("-r is required") != std::string::npos);
+    }
+
+    // Count exceeded while setting, when failing fast
+    p2.fail_fast();
+    std::array<const char*, 3> twice = { "", "-r", "-r" };
+    result = p2.try_parse(static_cast<int>(twice.size()), twice.data());
+    assert(result.error() == ParseError::CountMismatch && result.index() == 2);
+    assert(required.count() == 1);
+    try {
+        p2.raise(result, static_cast<int>(twice.size()), twice.data());
+        assert(false);
+    } catch(argument_count_mismatch& e) {
+        // OK
+    }
+}
+
+void testArgumentParserValidate() {
+    Argument verbose("", 'v');
+    ValueArgument<int> level("", 'l', "level", 7);
+    Argument quiet("", 'q');
+    ValueArgument<int> required("", "required", 0);
+    ArgumentParser p(verbose, level, quiet ^ verbose, +required);
+
+    ValidationResult result;
+    std::array<const char*, 4> ok = { "", "-v", "-l3", "--required=1" };
+    assert(p.validate(static_cast<int>(ok.size()), ok.data(), result));
+    assert(result && result.errors().empty());
+    // Nothing is set while validating
+    assert(verbose.count() == 0 && level.count() == 0 && level.value() == 7);
+
+    // All errors are collected, in order of the tokens
+    std::array<const char*, 7> bad = { "", "-vx", "-v", "--level=three", "-q", "--unknown", "-l" };
+    assert(!p.validate(static_cast<int>(bad.size()), bad.data(), result));
+    const std::vector<ParseResult>& errors = result.errors();
+    assert(errors.size() == 8);
+    assert(errors[0].error() == ParseError::UnknownArgument && errors[0].index() == 1 && errors[0].flag() == 'x');
+    assert(errors[1].error() == ParseError::CountMismatch && errors[1].index() == 2);
+    assert(errors[1].argument()->key() == verbose.key());
+    assert(errors[2].error() == ParseError::InvalidValue && errors[2].index() == 3 && errors[2].offset() == 8);
+    assert(errors[3].error() == ParseError::UnknownArgument && errors[3].index() == 5);
+    // Reading continues after an error, keeping the tokens aligned
+    assert(errors[4].error() == ParseError::CountMismatch && errors[4].index() == 6);
+    assert(errors[5].error() == ParseError::MissingValue && errors[5].index() == 6);
+    // Constraints are checked once all tokens are read
+    assert(errors[6].error() == ParseError::ConstraintViolated && errors[6].index() == bad.size());
+    assert(errors[7].error() == ParseError::ConstraintViolated && errors[7].index() == bad.size());
+    assert(verbose.count() == 0 && level.value() == 7);
+
+    // Errors can be raised like those of try_parse()
+    try {
+        p.raise(errors[2], static_cast<int>(bad.size()), bad.data());
+        assert(false);
+    } catch(argument_invalid_value& e) {
+        assert(std::string(e.what()).find("three") != std::string::npos);
+    }
+
+    // The result is reused
+    assert(p.validate(static_cast<int>(ok.size()), ok.data(), result));
+    assert(result.errors().empty());
+
+    // Parsing is not affected by validating
+    p.parse(static_cast<int>(ok.size()), ok.data());
+    assert(verbose.count() == 1 && level.value() == 3 && required.value() == 1);
+}
+
+void testArgumentErrorHandle() {
+    ValueArgument<int> level("", 'l', "level", 0);
+    Argument verbose("", 'v');
+    std::array<const char*, 3> invalid = { "", "-l", "x" };
+    try {
+        ArgumentParser p(level, verbose);
+        p.parse(static_cast<int>(invalid.size()), invalid.data());
+        assert(false);
+    } catch(argument_invalid_value& e) {
+        // The parser is gone, the exception keeps its argument alive
+        assert(e.index() == 2 && e.value() == "x");
+        assert(e.arg().key() == level.key());
+        argument_invalid_value copy(e);
+        assert(std::string(e.what()) == "Argument -l value does not accept the value x");
+        assert(std::string(copy.what()) == e.what());
+    }
+
+    std::array<const char*, 3> twice = { "", "-v", "-v" };
+    try {
+        ArgumentParser p(level, verbose);
+        p.parse(static_cast<int>(twice.size()), twice.data());
+        assert(false);
+    } catch(argument_count_mismatch& e) {
+        assert(e.index() == twice.size() && e.arg().key() == verbose.key());
+        assert(std::string(e.what()) == "Argument -v can only be set once");
+    }
+
+    // Not raised by a parser, the argument is copied
+    try {
+        level.set("y");
+        assert(false);
+    } catch(argument_invalid_value& e) {
+        assert(e.index() == argument_error::npos);
+        assert(std::string(e.what()) == "Argument -l value does not accept the value y");
+    }
+
+    try {
+        throw unknown_argument('x');
+    } catch(unknown_argument& e) {
+        assert(std::string(e.what()) == "The flag argument x is unknown");
+    }
+}
+
+void testEditDistance() {
+    // Reference implementation, without cut-off
+    auto reference = [](const std::string& a, const std::string& b) {
+        std::vector< std::vector<std::size_t> > d(a.length() + 1, std::vector<std::size_t>(b.length() + 1));
+        for (std::size_t i = 0; i <= a.length(); ++i) {
+            for (std::size_t j = 0; j <= b.length(); ++j) {
+                if (i == 0 || j == 0) {
+                    d[i][j] = i + j;
+                } else {
+                    d[i][j] = std::min(std::min(d[i - 1][j] + 1, d[i][j - 1] + 1),
+                            d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0u : 1u));
+                }
+            }
+        }
+        return d[a.length()][b.length()];
+    };
+
+    assert(detail::EditDistance("verbsoe")("verbose", 5) == 2);
+    assert(detail::EditDistance("kitten")("sitting", 5) == 3);
+    assert(detail::EditDistance("kitten")("sitting", 2) > 2);
+    assert(detail::EditDistance("")("abc", 5) == 3);
+
+    // Pseudo random strings over a small alphabet, including patterns too
+    // long for a single word
+    unsigned int seed = 12345u;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) & 0x7fffu;
+    };
+    for (int round = 0; round < 500; ++round) {
+        std::string a(next() % 80u, 'a');
+        std::string b(next() % 80u, 'a');
+        for (char& c: a) {
+            c = static_cast<char>('a' + next() % 4u);
+        }
+        for (char& c: b) {
+            c = static_cast<char>('a' + next() % 4u);
+        }
+        std::size_t expected = reference(a, b);
+        assert(detail::EditDistance(a)(b, 100) == expected);
+        std::size_t max = next() % 40u;
+        std::size_t bounded = detail::EditDistance(a)(b, max);
+        assert(expected > max ? bounded > max : bounded == expected);
+    }
+}
+
+void testArgumentParserSuggest() {
+    Argument verbose("", "verbose");
+    Argument version("", "version");
+    Argument verify("", "verify");
+    Argument quiet("", 'q', "quiet");
+    Argument level2("", "level2");
+    Argument level1("", "level1");
+    ArgumentParser p(verbose, version, verify, quiet, level2, level1);
+
+    std::vector<std::string> suggestions = p.suggest("verbsoe");
+    assert(suggestions.size() == 1 && suggestions[0] == "verbose");
+    // Closest first, ties in lexicographic order
+    suggestions = p.suggest("levl2");
+    assert(suggestions.size() == 2 && suggestions[0] == "level2" && suggestions[1] == "level1");
+    suggestions = p.suggest("level");
+    assert(suggestions.size() == 2 && suggestions[0] == "level1" && suggestions[1] == "level2");
+    suggestions = p.suggest("level", 1);
+    assert(suggestions.size() == 1 && suggestions[0] == "level1");
+    assert(p.suggest("output").empty());
+
+    // Against all names, with many names sharing prefixes
+    std::vector<std::string> names;
+    ArgumentParser many;
+    for (int i = 0; i < 2000; i += 7) {
+        names.push_back("opt-" + std::to_string(i * 13 % 1000));
+        many.add(Argument("", names.back()));
+    }
+    for (const char* typo: { "opt-123", "otp-45", "opt-99x", "op-7", "pot-1000" }) {
+        std::vector< std::pair<std::size_t, std::string> > expected;
+        std::size_t max = std::max<std::size_t>(1u, (std::strlen(typo) + 1u) / 3u);
+        for (const std::string& name: names) {
+            std::size_t d = detail::EditDistance(typo)(name, 100);
+            if (d <= max) {
+                expected.emplace_back(d, name);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        suggestions = many.suggest(typo, 5);
+        assert(suggestions.size() == std::min<std::size_t>(5u, expected.size()));
+        for (std::size_t i = 0; i < suggestions.size(); ++i) {
+            assert(suggestions[i] == expected[i].second);
+        }
+    }
+
+    std::array<const char*, 2> typo = { "", "--qiuet" };
+    try {
+        p.parse(static_cast<int>(typo.size()), typo.data());
+        assert(false);
+    } catch(unknown_argument& e) {
+        assert(e.suggestions().size() == 1 && e.suggestions()[0] == "quiet");
+        assert(std::string(e.what()) == "The named argument qiuet is unknown, did you mean --quiet");
+    }
+}
+
+/** Syntax with '+' flags, '/' names and ':' as delimiter */
+struct SlashSyntax {
+    static constexpr const char* flagStart() { return "+"; }
+    static constexpr const char* nameStart() { return "/"; }
+    static constexpr char nameDelim() { return ':'; }
+    static constexpr const char* skip() { return "//"; }
+};
+
+void testArgumentParserSyntax() {
+    ValueArgument<int> level("", 'l', "level", 0);
+    Argument verbose("", 'v', "verbose");
+    ValueArgument<std::string> file("");
+    BasicArgumentParser<SlashSyntax> slash(level, verbose, file);
+    const char* argv1[] = { "test", "/level:3", "+v", "-in" };
+    slash.parse(4, argv1);
+    assert(level.value() == 3);
+    assert(verbose.count() == 1);
+    assert(file.value() == "-in");
+
+    ValueArgument<int> level2("", 'l', "level", 0);
+    Argument verbose2("", 'v', "verbose");
+    ValueArgument<std::string> file2("");
+    BasicArgumentParser<SlashSyntax> joined(level2, verbose2, file2);
+    const char* argv2[] = { "test", "+vl4", "//", "/out" };
+    joined.parse(4, argv2);
+    assert(level2.value() == 4);
+    assert(verbose2.count() == 1);
+    assert(file2.value() == "/out");
+
+    // The default syntax in the same program
+    ValueArgument<int> level3("", 'l', "level", 0);
+    ValueArgument<std::string> file3("");
+    ArgumentParser gnu(level3, file3);
+    const char* argv3[] = { "test", "--level=5", "/out" };
+    gnu.parse(3, argv3);
+    assert(level3.value() == 5);
+    assert(file3.value() == "/out");
+
+    const char* argv4[] = { "test", "/lvel:1" };
+    try {
+        slash.parse(2, argv4);
+        assert(false);
+    } catch (const unknown_argument& e) {
+        assert(e.suggestions().size() == 1 && e.suggestions()[0] == "level");
+    }
+    ValidationResult result;
+    const char* argv5[] = { "test", "--level", "+x", "/level:y" };
+    assert(!slash.validate(4, argv5, result));
+    assert(result.errors().size() == 2);
+    assert(result.errors()[0].error() == ParseError::UnknownArgument);
+    assert(result.errors()[1].error() == ParseError::InvalidValue);
+    assert(slash.help().find("/level") != std::string::npos);
+}
+
+/** Struct for the Binding tests */
+struct BindingConfig {
+    int jobs = 1;
+    bool verbose = false;
+    double ratio = 0.5;
+    std::string input;
+    std::vector<std::string> extra;
+};
+
+void testBinding() {
+    Binding<BindingConfig> binding;
+    binding.bind(&BindingConfig::jobs, "Number of jobs", 'j', "jobs")
+           .bind(&BindingConfig::verbose, "Be &verbose")
+           .bind(&BindingConfig::ratio, "Ratio", "ratio")
+           .bind(&BindingConfig::input, "Input file").set_required()
+           .bind(&BindingConfig::extra, "Extra files");
+    assert(binding.fields().size() == 5);
+    assert(binding.fields()[1].flags == "v" && binding.fields()[1].description == "Be verbose");
+    assert(binding.fields()[3].positional && binding.fields()[3].required);
+    assert(binding.fields()[4].max == 0u);
+
+    const char* argv1[] = { "test", "-vj4", "--ratio=0.25", "in", "a", "b" };
+    BindingConfig config;
+    binding.parse(6, argv1, config);
+    assert(config.jobs == 4);
+    assert(config.verbose);
+    assert(config.ratio == 0.25);
+    assert(config.input == "in");
+    assert(config.extra.size() == 2 && config.extra[1] == "b");
+    assert(binding.count(4) == 2);
+
+    // The same binding parses into other objects
+    std::vector<BindingConfig> batch(3);
+    const char* argv2[] = { "test", "x", "--jobs", "8" };
+    for (BindingConfig& c: batch) {
+        assert(binding.try_parse(4, argv2, c));
+        assert(c.jobs == 8 && c.input == "x" && !c.verbose);
+    }
+
+    BindingConfig other;
+    const char* argv3[] = { "test", "-j", "many", "in" };
+    ParseResult result = binding.try_parse(4, argv3, other);
+    assert(result.error() == ParseError::InvalidValue);
+    assert(result.index() == 2);
+    assert(binding.failed() == 0);
+    assert(other.jobs == 1);
+    try {
+        binding.raise(result, 4, argv3);
+        assert(false);
+    } catch (const argument_invalid_value& e) {
+        assert(e.value() == "many");
+        assert(e.arg().matches('j'));
+    }
+
+    const char* argv4[] = { "test", "-v" };
+    try {
+        binding.parse(2, argv4, other);
+        assert(false);
+    } catch (const argument_count_mismatch& e) {
+        assert(e.arg().description() == "Input file");
+    }
+
+    const char* argv5[] = { "test", "in", "--jbs", "2" };
+    try {
+        binding.parse(4, argv5, other);
+        assert(false);
+    } catch (const unknown_argument& e) {
+        assert(e.suggestions().size() == 1 && e.suggestions()[0] == "jobs");
+    }
+
+    const char* argv6[] = { "test", "in", "-j1", "-j2" };
+    result = binding.try_parse(4, argv6, other);
+    assert(result.error() == ParseError::CountMismatch);
+    assert(result.index() == 3);
+
+    assert(binding.help().find("--ratio") != std::string::npos);
+
+    Binding<BindingConfig> duplicate;
+    duplicate.bind(&BindingConfig::jobs, "", 'j').bind(&BindingConfig::ratio, "", 'j');
+    try {
+        duplicate.freeze();
+        assert(false);
+    } catch (const std::logic_error&) {
+    }
+}
+
+void testHelpLayout() {
+    bool verbose = false;
+    int jobs = 1;
+    ArgumentParser parser(
+        SwitchArgument("Print the name of every file while it is being processed", 'v', "verbose", verbose),
+        VariableArgument<int>("Number of jobs", 'j', "jobs", jobs));
+    parser.program_name("test");
+
+    const std::string& help = parser.help();
+    assert(&help == &parser.help());
+    assert(help == "Usage: test [ -v ] [ -j value ]\n\nArguments:\n"
+            "  -v, --verbose  Print the name of every file while it is being processed\n"
+            "  -j, --jobs     Number of jobs\n");
+
+    std::ostringstream plain;
+    parser.write_help(plain);
+    assert(plain.str() == help);
+
+    // Continuation lines are indented to the description column
+    std::ostringstream wrapped;
+    parser.write_help(wrapped, 40);
+    std::istringstream lines(wrapped.str());
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(lines, line)) {
+        assert(line.length() <= 40);
+        ++count;
+    }
+    assert(count == 7);
+    assert(wrapped.str().find("  -v, --verbose  Print the name of every\n"
+            "                 file while it is being\n"
+            "                 processed\n") != std::string::npos);
+
+    // Too narrow to wrap
+    std::ostringstream narrow;
+    parser.write_help(narrow, 20);
+    assert(narrow.str() == help);
+
+    // Changing the parser lays out the help again
+    parser.add(SwitchArgument("Quiet", 'q', "quiet"));
+    assert(parser.help().find("  -q, --quiet    Quiet\n") != std::string::npos);
+    parser.program_name("other");
+    assert(parser.help().compare(0, 13, "Usage: other ") == 0);
+
+#ifdef TAP_POSIX
+    int fds[2];
+    assert(pipe(fds) == 0);
+    assert(parser.write_help(fds[1], 0));
+    close(fds[1]);
+    std::string piped;
+    char buffer[256];
+    ssize_t length;
+    while ((length = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        piped.append(buffer, static_cast<std::size_t>(length));
+    }
+    close(fds[0]);
+    assert(piped == parser.help());
+#endif
+}
+
+void testHelpQuery() {
+    int jobs = 1;
+    int port = 0;
+    std::string input;
+    std::string proxy;
+    ArgumentParser parser(
+        SwitchArgument("Be verbose", 'v', "verbose"),
+        VariableArgument<int>("Number of worker threads", 'j', "jobs", jobs),
+        VariableArgument<std::string>("Input file", input));
+    parser.add(ArgumentSet("Network",
+        VariableArgument<int>("Port to listen on", "port", port),
+        VariableArgument<std::string>("Address of the proxy", "proxy", proxy)));
+    parser.add_namespace("db.pool", "Connection pool", [](ArgumentSet&) {});
+
+    assert(parser.help(HelpQuery::group("Network")) ==
+            "Network:\n"
+            "  --port         Port to listen on\n"
+            "  --proxy        Address of the proxy\n");
+
+    // Matches in several groups keep the layout order and titles
+    assert(parser.help(HelpQuery::prefix("p")) ==
+            "Network:\n"
+            "  --port         Port to listen on\n"
+            "  --proxy        Address of the proxy\n");
+    assert(parser.help(HelpQuery::prefix("verb")) ==
+            "Arguments:\n"
+            "  -v, --verbose  Be verbose\n");
+    assert(parser.help(HelpQuery::prefix("db")).find("--db.pool.*") != std::string::npos);
+    assert(parser.help(HelpQuery::prefix("value")).find("  value") != std::string::npos);
+
+    // Substrings ignore case, with and without trigrams
+    assert(parser.help(HelpQuery::search("WORKER")) ==
+            "Arguments:\n"
+            "  -j, --jobs     Number of worker threads\n");
+    std::string files = parser.help(HelpQuery::search("fi"));
+    assert(files.find("Input file") != std::string::npos);
+    assert(files.find("--port") == std::string::npos);
+    std::string of = parser.help(HelpQuery::search("of "));
+    assert(of == "Arguments:\n"
+            "  -j, --jobs     Number of worker threads\n"
+            "\nNetwork:\n"
+            "  --proxy        Address of the proxy\n");
+    assert(parser.help(HelpQuery::search("nothing like this")).empty());
+    assert(parser.help(HelpQuery::group("Missing")).empty());
+
+    // Patterns as given by users
+    assert(HelpQuery::parse("Network:").kind() == HelpQuery::Kind::Group);
+    assert(HelpQuery::parse("Network:").pattern() == "Network");
+    assert(HelpQuery::parse("--po*").kind() == HelpQuery::Kind::Prefix);
+    assert(HelpQuery::parse("--po*").pattern() == "po");
+    assert(HelpQuery::parse("-v*").pattern() == "v");
+    assert(HelpQuery::parse("proxy").kind() == HelpQuery::Kind::Substring);
+    assert(parser.help(HelpQuery::parse("--po*")) == parser.help(HelpQuery::prefix("po")));
+
+    std::ostringstream wrapped;
+    parser.write_help(wrapped, HelpQuery::group("Network"), 33);
+    assert(wrapped.str() == "Network:\n"
+            "  --port         Port to listen\n"
+            "                 on\n"
+            "  --proxy        Address of the\n"
+            "                 proxy\n");
+
+    // The index follows changes of the parser
+    parser.add(SwitchArgument("Use a proxy for workers", "proxied"));
+    assert(parser.help(HelpQuery::search("worker")).find("--proxied") != std::string::npos);
+}
+
+void testArgumentParserComplete() {
+    int jobs = 1;
+    std::string mode;
+    std::string input;
+    ArgumentParser parser(
+        SwitchArgument("Be verbose", 'v', "verbose"),
+        VariableArgument<int>("Number of jobs", 'j', "jobs", jobs),
+        VariableArgument<std::string>("Mode", 'm', "mode", mode).choices({"fast", "safe", "slow"}),
+        VariableArgument<std::string>("Input file", input).complete_files(true));
+    parser.add_namespace("db.pool", "Connection pool", [](ArgumentSet& args) {
+        args.add(Argument("Enable", "db.pool.enable"));
+    });
+
+    typedef std::vector<std::string> Candidates;
+    const char* names[] = { "test", "--m" };
+    assert(parser.completions(names, 2, 1) == Candidates{"--mode"});
+    const char* all[] = { "test", "--" };
+    assert(parser.completions(all, 2, 1) == (Candidates{"--db.pool.", "--jobs", "--mode", "--verbose"}));
+    const char* inside[] = { "test", "--db.pool.e" };
+    assert(parser.completions(inside, 2, 1) == Candidates{"--db.pool.enable"});
+
+    // Pending and attached values, nothing is converted
+    const char* pending[] = { "test", "-j", "x", "--mode", "s" };
+    assert(parser.completions(pending, 5, 4) == (Candidates{"safe", "slow"}));
+    const char* joined[] = { "test", "--mode=f" };
+    assert(parser.completions(joined, 2, 1) == Candidates{"--mode=fast"});
+    const char* cluster[] = { "test", "-vmsa" };
+    assert(parser.completions(cluster, 2, 1) == Candidates{"-vmsafe"});
+    const char* flags[] = { "test", "-v" };
+    assert(parser.completions(flags, 2, 1) == Candidates{"-v"});
+    const char* unknown[] = { "test", "-vx" };
+    assert(parser.completions(unknown, 2, 1).empty());
+    assert(jobs == 1 && mode.empty() && !parser['v'].is_set());
+
+    // Positional slot, then arguments that can still be set
+    const char* positional[] = { "test", "-v" };
+    assert(parser.completions(positional, 2, 2) == Candidates{completeFiles});
+    const char* full[] = { "test", "in", "-v", "" };
+    assert(parser.completions(full, 4, 3) == (Candidates{"-j", "-m", "--db.pool.", "--jobs", "--mode"}));
+    const char* skipped[] = { "test", "in", "--", "" };
+    assert(parser.completions(skipped, 4, 3).empty());
+
+    // Completion requests
+    std::ostringstream out;
+    const char* request[] = { "test", "--complete", "1", "test", "--v" };
+    assert(parser.complete(5, request, out));
+    assert(out.str() == "--verbose\n");
+    const char* normal[] = { "test", "-v" };
+    assert(!parser.complete(2, normal, out));
+
+    assert(completion_script(Shell::Bash, "my-prog").find("complete -F _tap_complete_my_prog my-prog") != std::string::npos);
+    assert(completion_script(Shell::Zsh, "prog").compare(0, 14, "#compdef prog\n") == 0);
+    assert(completion_script(Shell::Fish, "prog").find("complete -c prog") != std::string::npos);
+}
+
+void testSchema() {
+    int jobs = 1;
+    double ratio = 0;
+    std::string mode;
+    std::string input;
+    VariableArgument<std::string> inputArg("Input file", input);
+    inputArg.complete_files(true).set_required();
+    ArgumentParser parser(
+        SwitchArgument("Be verbose", 'v', "verbose"),
+        VariableArgument<int>("Number of jobs", 'j', "jobs", jobs),
+        VariableArgument<double>("Ratio", 'r', "ratio", ratio),
+        VariableArgument<std::string>("Mode", 'm', "mode", mode).choices({"fast", "safe", "slow"}),
+        inputArg);
+    parser.program_name("prog");
+    const std::string schema = parser.export_schema();
+
+    // Lookup, reading the records in place
+    SchemaView view(schema.data(), schema.size());
+    assert(view.size() == 5 && std::strcmp(view.program(), "prog") == 0);
+    std::size_t j = view.find('j');
+    assert(j != SchemaView::npos && view.find("jobs") == j && view.find("job") == SchemaView::npos);
+    assert(view.find('x') == SchemaView::npos && view.find("jobsx") == SchemaView::npos);
+    const SchemaArgument& jobsArg = view.argument(j);
+    assert(std::strcmp(view.text(jobsArg.description), "Number of jobs") == 0);
+    assert(jobsArg.takesValue && static_cast<ValueKind>(jobsArg.kind) == ValueKind::Integer);
+    assert(jobsArg.names.count == 1 && std::strcmp(view.string(jobsArg.names, 0), "jobs") == 0);
+    const SchemaArgument& modeArg = view.argument(view.find("mode"));
+    assert(modeArg.choices.count == 3 && std::strcmp(view.string(modeArg.choices, 2), "slow") == 0);
+    assert(static_cast<ValueKind>(view.argument(view.find('v')).kind) == ValueKind::None);
+    std::vector<std::string> names;
+    view.complete("", names);
+    assert(names == (std::vector<std::string>{"jobs", "mode", "ratio", "verbose"}));
+
+    // Validation follows the parser
+    const char* valid[] = { "prog", "-vj4", "--ratio=0.5", "in" };
+    assert(view.validate(4, valid));
+    const char* notInteger[] = { "prog", "--jobs", "4x", "in" };
+    SchemaResult result = view.validate(4, notInteger);
+    assert(result.error == ParseError::InvalidValue && result.index == 2 && result.argument == j);
+    const char* unknown[] = { "prog", "in", "--job" };
+    result = view.validate(3, unknown);
+    assert(result.error == ParseError::UnknownArgument && result.argument == SchemaResult::npos);
+    const char* twice[] = { "prog", "-v", "in", "-v" };
+    assert(view.validate(4, twice).error == ParseError::CountMismatch);
+    const char* missing[] = { "prog", "-v" };
+    result = view.validate(2, missing);
+    assert(result.error == ParseError::ConstraintViolated && view.argument(result.argument).positional());
+    assert(jobs == 1 && ratio == 0 && input.empty());
+
+    // Completion, as ArgumentParser::completions()
+    typedef std::vector<std::string> Candidates;
+    const char* pending[] = { "prog", "-m", "s" };
+    assert(view.completions(pending, 3, 2) == parser.completions(pending, 3, 2));
+    const char* full[] = { "prog", "in", "-v", "" };
+    assert(view.completions(full, 4, 3) == (Candidates{"-j", "-m", "-r", "--jobs", "--mode", "--ratio"}));
+    assert(view.completions(full, 4, 3) == parser.completions(full, 4, 3));
+    const char* positional[] = { "prog", "" };
+    assert(view.completions(positional, 2, 1) == Candidates{completeFiles});
+
+    // Corrupt data is rejected
+    std::string corrupt = schema;
+    corrupt[0] = 'X';
+    bool thrown = false;
+    try {
+        SchemaView bad(corrupt.data(), corrupt.size());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    corrupt = schema;
+    thrown = false;
+    try {
+        SchemaView bad(corrupt.data(), corrupt.size() - 4);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Reading a schema from a file
+    const char* path = "tap_test_schema.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(schema.data(), static_cast<std::streamsize>(schema.size()));
+    }
+    {
+        MappedFile file(path);
+        SchemaView mapped(file.data(), file.size());
+        assert(mapped.size() == 5 && mapped.find("ratio") == view.find("ratio"));
+    }
+    std::remove(path);
+}
+
+/** Parser with action arguments, see testActionArgument() */
+struct ActionFixture {
+    int jobs = 1;
+    std::string input;
+    bool verbose = false;
+    VariableArgument<std::string> inputArg;
+    ActionArgument help;
+    ArgumentParser parser;
+
+    ActionFixture() :
+        inputArg("Input file", input), help("Show this help", 'h', "help", 1) {
+        inputArg.set_required();
+        parser.add(help);
+        parser.add(ActionArgument("Show the version", "version", 2));
+        parser.add(SwitchArgument("Be verbose", 'v', "verbose", verbose));
+        parser.add(VariableArgument<int>("Number of jobs", 'j', "jobs", jobs));
+        parser.add(inputArg);
+    }
+};
+
+void testActionArgument() {
+    // Stops at once, without reading the rest or checking requirements
+    const char* helpArgs[] = { "prog", "--help", "-j", "bad", "--unknown" };
+    {
+        ActionFixture f;
+        assert(f.parser.parse(5, helpArgs) == 1);
+        assert(f.help.is_set() && f.jobs == 1 && !f.inputArg.is_set());
+    }
+    {
+        ActionFixture f;
+        const char* cluster[] = { "prog", "-vhj", "bad" };
+        ParseResult result = f.parser.try_parse(3, cluster);
+        assert(result && result.action() == 1 && result.index() == 1 && result.offset() == 2);
+        assert(f.verbose && f.jobs == 1);
+    }
+    {
+        ActionFixture f;
+        const char* version[] = { "prog", "-j", "4", "--version", "-v" };
+        assert(f.parser.parse(5, version) == 2 && f.jobs == 4 && !f.verbose);
+    }
+    {
+        ActionFixture f;
+        const char* normal[] = { "prog", "in" };
+        assert(f.parser.parse(2, normal) == 0 && f.input == "in");
+    }
+
+    // Errors before the action are still found
+    ActionFixture f;
+    const char* bad[] = { "prog", "-j", "bad", "--help" };
+    ValidationResult validation;
+    assert(!f.parser.validate(4, bad, validation) && validation.action() == 1);
+    assert(validation.errors().size() == 1);
+    assert(f.parser.validate(5, helpArgs, validation) && validation.action() == 1);
+    assert(!f.parser.validate(1, helpArgs, validation) && validation.action() == 0);
+    assert(!f.parser.try_parse(4, bad) && !f.help.is_set());
+
+    // Exported schemas stop likewise, completion reads past actions
+    const std::string schema = f.parser.export_schema();
+    SchemaView view(schema.data(), schema.size());
+    SchemaResult checked = view.validate(5, helpArgs);
+    assert(checked && checked.action == 1 && checked.index == 1);
+    assert(!view.validate(1, helpArgs));
+    const char* words[] = { "prog", "--help", "--j" };
+    assert(f.parser.completions(words, 3, 2) == std::vector<std::string>{"--jobs"});
+    assert(view.completions(words, 3, 2) == std::vector<std::string>{"--jobs"});
+
+    bool thrown = false;
+    try {
+        ActionArgument none("No action", 'n', 0);
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/** Default markers, with attached values disabled (see TAP::nameDelim) */
+struct NoDelimSyntax {
+    static constexpr const char* flagStart() { return "-"; }
+    static constexpr const char* nameStart() { return "--"; }
+    static constexpr char nameDelim() { return '\0'; }
+    static constexpr const char* skip() { return "--"; }
+};
+
+void testArgumentParserNoDelimiter() {
+    Argument verbose("", 'v', "verbose");
+    ValueArgument<int> out("", "out", 0);
+    BasicArgumentParser<NoDelimSyntax> parser(verbose, out);
+    const char* argv1[] = { "test", "--verbose", "--out", "5" };
+    parser.parse(4, argv1);
+    assert(verbose.count() == 1 && out.value() == 5);
+
+    // The name includes any '=', so it is unknown
+    const char* argv2[] = { "test", "--out=5" };
+    ParseResult result = parser.try_parse(2, argv2);
+    assert(result.error() == ParseError::UnknownArgument);
+    try {
+        parser.parse(2, argv2);
+        assert(false);
+    } catch (const unknown_argument& e) {
+        assert(std::string(e.what()).find("out=5") != std::string::npos);
+    }
+
+    const char* words[] = { "test", "--o" };
+    assert(parser.completions(words, 2, 1) == std::vector<std::string>{"--out"});
+}
+
+/** Ignores the given value and stores 99, see testValueAcceptorOverride() */
+class FixedArgument : public ValueArgument<int> {
+public:
+    using ValueArgument<int>::ValueArgument;
+
+    bool try_set(const std::string&) const override {
+        return ValueArgument<int>::try_set("99");
+    }
+
+    bool accepts(const std::string&) const override {
+        return true;
+    }
+
+    std::unique_ptr<BaseArgument> clone() const & override {
+        return std::unique_ptr<BaseArgument>(new FixedArgument(*this));
+    }
+
+    std::unique_ptr<BaseArgument> clone() && override {
+        return std::unique_ptr<BaseArgument>(new FixedArgument(std::move(*this)));
+    }
+};
+
+/** Accepts non-empty values without deriving from a library class */
+class KeyArgument : public Argument, public ValueAcceptor {
+    std::shared_ptr<std::string> m_key;
+public:
+    KeyArgument(std::string name) : Argument("", std::move(name)), m_key(std::make_shared<std::string>()) {}
+
+    const std::string& key() const {
+        return *m_key;
+    }
+
+    bool takes_value() const override {
+        return true;
+    }
+
+    using Argument::set;
+
+    void set(const std::string& value) const override {
+        if (!try_set(value)) {
+            throw argument_invalid_value(*this, value);
+        }
+    }
+
+    bool try_set(const std::string& value) const override {
+        if (!accepts(value)) {
+            return false;
+        }
+        *m_key = value;
+        Argument::set();
+        return true;
+    }
+
+    bool accepts(const std::string& value) const override {
+        return !value.empty();
+    }
+
+    const ValueAcceptor* acceptor() const override {
+        return this;
+    }
+
+    std::unique_ptr<BaseArgument> clone() const & override {
+        return std::unique_ptr<BaseArgument>(new KeyArgument(*this));
+    }
+
+    std::unique_ptr<BaseArgument> clone() && override {
+        return std::unique_ptr<BaseArgument>(new KeyArgument(std::move(*this)));
+    }
+};
+
+void testValueAcceptorOverride() {
+    FixedArgument fixed("", "fixed", 0);
+    KeyArgument key("key");
+    ArgumentParser parser(fixed, key);
+    const char* argv1[] = { "test", "--fixed", "12345", "--key=abc" };
+    parser.parse(4, argv1);
+    assert(fixed.value() == 99 && fixed.count() == 1);
+    assert(key.key() == "abc" && key.count() == 1);
+
+    const char* argv2[] = { "test", "--key", "" };
+    ParseResult result = parser.try_parse(3, argv2);
+    assert(result.error() == ParseError::InvalidValue);
+
+    // Validation checks values through the overrides as well
+    ValidationResult validation;
+    assert(!parser.validate(3, argv2, validation));
+    assert(validation.errors().size() == 1 && validation.errors()[0].error() == ParseError::InvalidValue);
+    const char* argv3[] = { "test", "--fixed", "abc" };
+    assert(parser.validate(3, argv3, validation));
+}
+
+/** Returns an expression over arguments that go out of scope, see testConstraintExpr() */
+auto makeFlagsExpr() {
+    Argument x("", 'x');
+    Argument y("", 'y');
+    return x ^ y;
+}
+
+void testConstraintExpr() {
+    ValueArgument<int> min("", "min", 0);
+    ValueArgument<int> max("", "max", 10);
+    Argument arg1("", 'a');
+    Argument arg2("", 'b');
+
+    // Expressions kept with auto can be used as constraints
+    auto range = min | max;
+    assert(range.size() == 2 && range.usage() == "[ --min value ] [ --max value ]");
+    range.check_values("Minimum may not exceed maximum: ",
+            [](const ValueArgument<int>& lo, const ValueArgument<int>& hi) {
+                return lo.value() <= hi.value();
+            }, min, max);
+
+    std::array<const char*, 3> args = {
+            "", "--min=5", "--max=3"
+    };
+    ArgumentParser p(range);
+    try {
+        p.parse(static_cast<int>(args.size()), args.data());
+        assert(false);
+    } catch(constraint_error& e) {
+        assert(std::string(e.what()).find("Minimum") == 0);
+    }
+
+    // Joining keeps what was added to either side
+    auto flags = arg1 ^ arg2;
+    flags += arg1;
+    auto joined = -flags ^ arg2;
+    assert(flags.size() == 3 && joined.size() == 4 && !joined.required());
+    ArgumentConstraint<ConstraintType::One> constraint = joined;
+    assert(constraint.size() == 4);
+
+    // Expressions hold copies, so they may outlive the arguments
+    ArgumentParser p2(makeFlagsExpr());
+    std::array<const char*, 2> flag = { "", "-y" };
+    p2.parse(static_cast<int>(flag.size()), flag.data());
+}
+
+void testSyntaxMarkers() {
+    ValueArgument<int> level("Level", "level", 0);
+    Argument verbose("Be verbose", 'v', "verbose");
+    Argument quiet("Be quiet", "quiet");
+    ValueArgument<int> size("Size", "size", 0);
+    BasicArgumentParser<SlashSyntax> slash(level, verbose ^ quiet, size);
+    slash.add_namespace("db", "Database", [](ArgumentSet&) {});
+    assert(slash.help().find("/level") != std::string::npos);
+    assert(slash.help().find("+v, /verbose") != std::string::npos);
+    assert(slash.help().find("/db.*") != std::string::npos);
+    assert(slash.help().find("--") == std::string::npos);
+    assert(slash.help("db").find("db:") == 0);
+
+    const char* argv1[] = { "test", "/level:x" };
+    try {
+        slash.parse(2, argv1);
+        assert(false);
+    } catch (const argument_invalid_value& e) {
+        assert(std::string(e.what()).find("Argument /level value") == 0);
+    }
+    const char* argv2[] = { "test", "/levl:1" };
+    try {
+        slash.parse(2, argv2);
+        assert(false);
+    } catch (const unknown_argument& e) {
+        assert(std::string(e.what()).find("did you mean /level") != std::string::npos);
+    }
+    const char* argv3[] = { "test", "+v", "/quiet" };
+    try {
+        slash.parse(3, argv3);
+        assert(false);
+    } catch (const constraint_error& e) {
+        assert(std::string(e.what()).find("from +v /quiet") != std::string::npos);
+    }
+    // Outside the parser the default markers are used again
+    assert(level.usage() == std::string(nameStart) + "level value");
+
+    std::ostringstream out;
+    const char* request[] = { "test", "/complete", "1", "test", "/le" };
+    assert(slash.complete(5, request, out));
+    assert(out.str() == "/level\n");
+    const char* gnu[] = { "test", "--complete", "1", "test", "/le" };
+    assert(!slash.complete(5, gnu, out));
+
+    assert(HelpQuery::parse<SlashSyntax>("/le*").pattern() == "le");
+    assert(HelpQuery::parse<SlashSyntax>("+v*").pattern() == "v");
+    assert(slash.help(HelpQuery::parse<SlashSyntax>("/le*")).find("/level") != std::string::npos);
+    assert(completion_script<SlashSyntax>(Shell::Bash, "prog").find("\" /complete \"") != std::string::npos);
+}
+
+void testBindingSyntax() {
+    Binding<BindingConfig, SlashSyntax> binding;
+    binding.bind(&BindingConfig::jobs, "Number of jobs", 'j', "jobs")
+           .bind(&BindingConfig::input, "Input file");
+    const std::string help = binding.help();
+    assert(help.find("+j, /jobs") != std::string::npos);
+    assert(binding.help() == help);
+
+    BindingConfig config;
+    const char* argv1[] = { "test", "/jobs:x" };
+    try {
+        binding.parse(2, argv1, config);
+        assert(false);
+    } catch (const argument_invalid_value& e) {
+        assert(std::string(e.what()).find("Argument +j value") == 0);
+    }
+    const char* argv2[] = { "test", "/jbs:2" };
+    try {
+        binding.parse(2, argv2, config);
+        assert(false);
+    } catch (const unknown_argument& e) {
+        assert(std::string(e.what()).find("did you mean /jobs") != std::string::npos);
+    }
+
+    // Binding a field updates the help text
+    binding.bind(&BindingConfig::ratio, "Ratio", "ratio");
+    assert(binding.help().find("/ratio") != std::string::npos);
+    binding.set_required();
+    assert(binding.help().find("[ /ratio value ]") == std::string::npos);
+}
+
+void testSchemaDeepTrie() {
+    // A node per character, deeper than the call stack would allow
+    const std::string name(200000, 'n');
+    ArgumentParser parser(Argument("Deep", name), Argument("Shallow", "m"));
+    const std::string schema = parser.export_schema();
+    SchemaView view(schema.data(), schema.size());
+    std::vector<std::string> names;
+    view.complete("", names);
+    assert(names.size() == 2 && names[0] == "m" && names[1] == name);
+    names.clear();
+    view.complete(name.substr(0, 1000), names);
+    assert(names.size() == 1 && names[0] == name);
+}
+
 int main(int argc, const char** argv) {
     testArgumentMatchFlag();
     testArgumentMatchName();
@@ -1043,6 +2494,7 @@ int main(int argc, const char** argv) {
     testArgumentMany();
     testArgumentCheck();
     testArgumentCheckExcept();
+    testArgumentCheckCopy();
 
     testValueArgument();
     testValueArgumentDefault();
@@ -1093,6 +2545,36 @@ int main(int argc, const char** argv) {
     testArgumentConstructors();
 
     testArgumentAutoFlag();
+    testArgumentMarkup();
+
+    testConstraintCounting();
+    testConstraintProgram();
+    testArgumentParserConstraint();
+    testArgumentParserFailFast();
+    testArgumentParserCheckValues();
+    testConstraintOperators();
+    testConstraintExpr();
+    testConstraintShared();
+    testArgumentParserBulk();
+    testPatternArgument();
+    testArgumentParserNamespace();
+    testArgumentParserTryParse();
+    testArgumentParserValidate();
+    testArgumentErrorHandle();
+    testEditDistance();
+    testArgumentParserSuggest();
+    testArgumentParserSyntax();
+    testSyntaxMarkers();
+    testArgumentParserNoDelimiter();
+    testValueAcceptorOverride();
+    testBinding();
+    testBindingSyntax();
+    testHelpLayout();
+    testHelpQuery();
+    testArgumentParserComplete();
+    testSchema();
+    testSchemaDeepTrie();
+    testActionArgument();
 
     ArgumentParser pars{};
     pars.parse(argc, argv);